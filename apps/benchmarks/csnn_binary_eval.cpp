@@ -0,0 +1,162 @@
+#include "Experiment.h"
+#include "dataset/Synthetic.h"
+#include "stdp/Multiplicative.h"
+#include "layer/Convolution3D.h"
+#include "layer/Pooling.h"
+#include "Distribution.h"
+#include "execution/SparseIntermediateExecution.h"
+#include "analysis/Svm.h"
+#include "process/Scaling.h"
+#include "process/Pooling.h"
+#include "dep/ArduinoJson-v6.17.3.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+/**
+ * @brief Accuracy cost of the bit-packed binary inference of Convolution3D (binary_infer) on the synthetic datasets.
+ * The Convolution3D -> Pooling3D -> SVM pipeline runs twice with the same seed: the STDP training is the same, only the
+ * inference of the convolution differs (float, then binarized weights). The SVM classification rates of the two runs,
+ * their delta, and the time spent in the tests of the convolution are reported. The delta is only reported when the float
+ * baseline classifies, at twice the chance rate at least.
+ *
+ * Usage: csnn_binary_eval [ <DATASET = image|video|spikes> ] [ <TRAIN_SAMPLES = 1000> ] [ <TEST_SAMPLES = 200> ] [ <EPOCHS = 5> ] [ <OUTPUT_PATH = result> ] [ <SEED = 0> ]
+ */
+
+struct Evaluation
+{
+	float classification_rate;
+	double test_seconds;
+	size_t class_number;
+};
+
+/**
+ * @brief Sums the durations of the test spans of the process named process_name in the trace.
+ */
+static double read_test_seconds(const std::string &trace_filename, const std::string &process_name)
+{
+	std::ifstream file(trace_filename);
+	if (!file.good())
+		throw std::runtime_error("Can't open file " + trace_filename);
+
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	DynamicJsonDocument trace(4 * text.size() + 4096);
+	DeserializationError error = deserializeJson(trace, text);
+	if (error)
+		throw std::runtime_error("Can't parse " + trace_filename + ": " + error.c_str());
+
+	double seconds = 0.0;
+	for (JsonObject event : trace["traceEvents"].as<JsonArray>())
+	{
+		std::string name = event["name"].as<std::string>();
+		if (event["cat"].as<std::string>() == "test" && name.size() >= process_name.size() &&
+			name.compare(name.size() - process_name.size(), process_name.size(), process_name) == 0)
+			seconds += event["dur"].as<double>() / 1e6;
+	}
+	return seconds;
+}
+
+static Evaluation evaluate(int &argc, char **argv, const std::string &dataset, size_t train_number, size_t test_number, uint32_t epoch_number,
+						   const std::string &output_path, int seed, bool binary)
+{
+	Experiment<SparseIntermediateExecution> experiment(argv, argc, output_path, output_path, std::string("binary_eval_") + (binary ? "binary_" : "float_") + dataset, seed, true);
+
+	// The train and test sets share their classes and differ by their sample seed
+	size_t filter_depth = 1;
+	size_t class_number = 10;
+	if (dataset == "image")
+	{
+		experiment.add_train<dataset::SyntheticImage>(32, 32, 1, 10, train_number, 0.8f, seed);
+		experiment.add_test<dataset::SyntheticImage>(32, 32, 1, 10, test_number, 0.8f, seed + 1);
+		experiment.push<LatencyCoding>();
+	}
+	else if (dataset == "video")
+	{
+		experiment.add_train<dataset::SyntheticVideo>(32, 32, 1, 8, 8, train_number, 0.9f, seed);
+		experiment.add_test<dataset::SyntheticVideo>(32, 32, 1, 8, 8, test_number, 0.9f, seed + 1);
+		experiment.push<LatencyCoding>();
+		filter_depth = 3;
+		class_number = 8;
+	}
+	else if (dataset == "spikes")
+	{
+		experiment.add_train<dataset::SyntheticSpikes>(16, 16, 8, 10, train_number, 0.9f, seed);
+		experiment.add_test<dataset::SyntheticSpikes>(16, 16, 8, 10, test_number, 0.9f, seed + 1);
+	}
+	else
+	{
+		throw std::runtime_error("Unknown synthetic dataset " + dataset);
+	}
+
+	// An early objective keeps the float neurons firing on every sample at test time
+	float t_obj = 0.3f;
+
+	auto &conv1 = experiment.push<layer::Convolution3D>(5, 5, filter_depth, 32);
+	conv1.set_name("conv1");
+	conv1.parameter<bool>("draw").set(false);
+	conv1.parameter<bool>("save_weights").set(false);
+	conv1.parameter<bool>("save_random_start").set(false);
+	conv1.parameter<bool>("log_spiking_neuron").set(false);
+	conv1.parameter<bool>("inhibition").set(true);
+	conv1.parameter<uint32_t>("epoch").set(epoch_number);
+	conv1.parameter<float>("annealing").set(0.95f);
+	conv1.parameter<float>("min_th").set(1.0f);
+	conv1.parameter<float>("t_obj").set(t_obj);
+	conv1.parameter<float>("lr_th").set(1.0f);
+	conv1.parameter<Tensor<float>>("w").distribution<distribution::Uniform>(0.0, 1.0);
+	conv1.parameter<Tensor<float>>("th").distribution<distribution::Gaussian>(8.0, 0.1);
+	conv1.parameter<STDP>("stdp").set<stdp::Multiplicative>(0.1f, 1.0f);
+	conv1.parameter<bool>("binary_infer").set(binary);
+
+	auto &pool1 = experiment.push<layer::Pooling3D>(2, 2, 1, 2, 2);
+	pool1.set_name("pool1");
+
+	auto &pool1_out = experiment.output<TimeObjectiveOutput>(pool1, t_obj);
+	pool1_out.add_postprocessing<process::SumPooling>(2, 2);
+	pool1_out.add_postprocessing<process::FeatureScaling>();
+	auto &svm = pool1_out.add_analysis<analysis::Svm>();
+
+	experiment.enable_trace();
+	experiment.run(10000);
+	experiment.enable_trace(false);
+
+	return Evaluation{svm.classification_rate(), read_test_seconds(output_path + "/trace_" + experiment.name() + ".json", "conv1"), class_number};
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 7)
+	{
+		throw std::runtime_error("Usage: " + std::string(argv[0]) + " [ <DATASET = image|video|spikes> ] [ <TRAIN_SAMPLES = 1000> ] [ <TEST_SAMPLES = 200> ] [ <EPOCHS = 5> ] [ <OUTPUT_PATH = result> ] [ <SEED = 0> ]");
+	}
+
+	std::string dataset = argc > 1 ? argv[1] : "image";
+	size_t train_number = argc > 2 ? std::stoul(argv[2]) : 1000;
+	size_t test_number = argc > 3 ? std::stoul(argv[3]) : 200;
+	uint32_t epoch_number = argc > 4 ? std::stoul(argv[4]) : 5;
+	std::string output_path = argc > 5 ? argv[5] : "result";
+	int seed = argc > 6 ? std::stoi(argv[6]) : 0;
+
+	Evaluation reference = evaluate(argc, argv, dataset, train_number, test_number, epoch_number, output_path, seed, false);
+	Evaluation binary = evaluate(argc, argv, dataset, train_number, test_number, epoch_number, output_path, seed, true);
+
+	std::cout << std::endl
+			  << "===" << dataset << "===" << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "float inference:  " << reference.classification_rate * 100.0f << "% (conv1 tests " << std::setprecision(3) << reference.test_seconds << "s)" << std::endl;
+	std::cout << std::setprecision(2);
+	std::cout << "binary inference: " << binary.classification_rate * 100.0f << "% (conv1 tests " << std::setprecision(3) << binary.test_seconds << "s)" << std::endl;
+	std::cout << std::setprecision(2);
+
+	float chance_rate = 1.0f / static_cast<float>(reference.class_number);
+	if (reference.classification_rate < 2.0f * chance_rate)
+	{
+		std::cout << "accuracy delta:   not reported, the float baseline is near chance (" << chance_rate * 100.0f << "%)" << std::endl;
+		return 1;
+	}
+
+	std::cout << "accuracy delta:   " << (binary.classification_rate - reference.classification_rate) * 100.0f << " points, speedup "
+			  << (binary.test_seconds > 0.0 ? reference.test_seconds / binary.test_seconds : 0.0) << "x" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,527 @@
+#include "Experiment.h"
+#include "SparseTensor.h"
+#include "SpikeConverter.h"
+#include "Distribution.h"
+#include "execution/EmptyExecution.h"
+#include "layer/Convolution.h"
+#include "layer/Convolution3D.h"
+#include "layer/Pooling.h"
+#include "process/OnOffFilter.h"
+#include "process/Pooling.h"
+#include "analysis/Svm.h"
+#include "stdp/Biological.h"
+#include "stdp/BiologicalMultiplicative.h"
+#include "stdp/Linear.h"
+#include "stdp/Multiplicative.h"
+#include "stdp/Proportional.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+/**
+ * @brief Micro-benchmarks of the simulator kernels on synthetic inputs drawn from a seed, so that two runs time the same work
+ * without any dataset. Each case is warmed up, then its calls are timed one by one: the min, mean and percentiles of the calls
+ * are printed and written to a JSON file.
+ *
+ * Usage: csnn_microbench [ <OUTPUT_JSON = microbench.json> ] [ <SEED = 0> ] [ <ITERATIONS = 100> ] [ <WARMUP = 10> ] [ <FILTER> ]
+ * Only the cases whose name contains FILTER are timed. A case stops after MaxCaseSeconds once it has MinIterations timed calls.
+ */
+
+static constexpr size_t MinIterations = 5;
+static constexpr double MaxCaseSeconds = 5.0;
+// Sample number given to the layers, large enough that the end of an epoch or of the test set is never reached
+static constexpr size_t UnboundedNumber = std::numeric_limits<size_t>::max();
+static constexpr size_t StdpUpdateNumber = 16384;
+
+struct BenchResult
+{
+	std::string name = std::string();
+	size_t items = 0;
+	size_t iterations = 0;
+	double min_ns = 0.0;
+	double mean_ns = 0.0;
+	double p50_ns = 0.0;
+	double p90_ns = 0.0;
+	double p99_ns = 0.0;
+	double max_ns = 0.0;
+};
+
+/**
+ * @brief Silences std::cout while it lives: the layers print their progress and the experiments their logs.
+ * The experiments keep the buffer of std::cout they were created with, so they must not outlive it.
+ */
+class QuietOutput
+{
+
+public:
+	QuietOutput() : _discard(), _buffer(std::cout.rdbuf(&_discard))
+	{
+	}
+
+	~QuietOutput()
+	{
+		std::cout.rdbuf(_buffer);
+		std::cout.clear();
+	}
+
+	QuietOutput(const QuietOutput &that) = delete;
+	QuietOutput &operator=(const QuietOutput &that) = delete;
+
+private:
+	class DiscardBuffer : public std::streambuf
+	{
+
+	protected:
+		virtual int overflow(int c)
+		{
+			return traits_type::not_eof(c);
+		}
+	};
+
+	DiscardBuffer _discard;
+	std::streambuf *_buffer;
+};
+
+class MicroBench
+{
+
+public:
+	MicroBench(size_t iterations, size_t warmup, const std::string &filter) : _iterations(iterations), _warmup(warmup), _filter(filter), _results()
+	{
+	}
+
+	/**
+	 * @brief Times op. setup prepares the input of each call and is not timed, items is the work done by one call
+	 * (samples, spikes or weight updates), used for the throughput.
+	 */
+	void run(const std::string &name, size_t items, const std::function<void()> &setup, const std::function<void()> &op)
+	{
+		if (!_filter.empty() && name.find(_filter) == std::string::npos)
+			return;
+
+		for (size_t i = 0; i < _warmup; i++)
+		{
+			setup();
+			op();
+		}
+
+		std::vector<double> times;
+		auto case_start = std::chrono::steady_clock::now();
+		while (times.size() < _iterations)
+		{
+			setup();
+			auto start = std::chrono::steady_clock::now();
+			op();
+			auto end = std::chrono::steady_clock::now();
+			times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+			if (times.size() >= MinIterations && std::chrono::duration<double>(end - case_start).count() > MaxCaseSeconds)
+				break;
+		}
+
+		std::sort(std::begin(times), std::end(times));
+		auto percentile = [&times](double p)
+		{
+			return times[std::min(times.size() - 1, static_cast<size_t>(p * times.size()))];
+		};
+
+		BenchResult result;
+		result.name = name;
+		result.items = items;
+		result.iterations = times.size();
+		result.min_ns = times.front();
+		result.mean_ns = std::accumulate(std::begin(times), std::end(times), 0.0) / times.size();
+		result.p50_ns = percentile(0.5);
+		result.p90_ns = percentile(0.9);
+		result.p99_ns = percentile(0.99);
+		result.max_ns = times.back();
+		_results.push_back(result);
+	}
+
+	void print(std::ostream &stream) const
+	{
+		stream << std::left << std::setw(32) << "case" << std::right << std::setw(8) << "iter" << std::setw(12) << "min(us)"
+			   << std::setw(12) << "mean(us)" << std::setw(12) << "p50(us)" << std::setw(12) << "p90(us)" << std::setw(12) << "p99(us)"
+			   << std::setw(14) << "items/s" << std::endl;
+		stream << std::fixed << std::setprecision(2);
+		for (const BenchResult &result : _results)
+		{
+			stream << std::left << std::setw(32) << result.name << std::right << std::setw(8) << result.iterations
+				   << std::setw(12) << result.min_ns / 1000.0 << std::setw(12) << result.mean_ns / 1000.0
+				   << std::setw(12) << result.p50_ns / 1000.0 << std::setw(12) << result.p90_ns / 1000.0
+				   << std::setw(12) << result.p99_ns / 1000.0 << std::setw(14) << std::setprecision(0)
+				   << result.items * 1e9 / result.mean_ns << std::setprecision(2) << std::endl;
+		}
+		stream.unsetf(std::ios::floatfield);
+	}
+
+	void save_json(const std::string &filename, int seed) const
+	{
+		std::ofstream file(filename, std::ios::out | std::ios::trunc);
+		if (!file.good())
+			throw std::runtime_error("Can't open file " + filename);
+
+		file << "{\"seed\": " << seed << ", \"warmup\": " << _warmup << ", \"cases\": [";
+		for (size_t i = 0; i < _results.size(); i++)
+		{
+			const BenchResult &result = _results[i];
+			file << (i == 0 ? "" : ",") << "\n\t{\"name\": \"" << result.name << "\", \"items\": " << result.items
+				 << ", \"iterations\": " << result.iterations << ", \"min_ns\": " << result.min_ns << ", \"mean_ns\": " << result.mean_ns
+				 << ", \"p50_ns\": " << result.p50_ns << ", \"p90_ns\": " << result.p90_ns << ", \"p99_ns\": " << result.p99_ns
+				 << ", \"max_ns\": " << result.max_ns << ", \"items_per_second\": " << result.items * 1e9 / result.mean_ns << "}";
+		}
+		file << "\n]}" << std::endl;
+	}
+
+private:
+	size_t _iterations;
+	size_t _warmup;
+	std::string _filter;
+	std::vector<BenchResult> _results;
+};
+
+/**
+ * @brief Latency coded input: each neuron fires with probability density, at a uniform time in [0, 1).
+ */
+static Tensor<float> random_spike_times(const Shape &shape, float density, std::default_random_engine &random)
+{
+	std::bernoulli_distribution fire(density);
+	std::uniform_real_distribution<float> time(0.0f, 1.0f);
+
+	Tensor<float> out(shape);
+	for (size_t i = 0; i < shape.product(); i++)
+		out.at_index(i) = fire(random) ? time(random) : INFINITE_TIME;
+	return out;
+}
+
+/**
+ * @brief Non-negative features (or pixels when density is 1), 0 with probability 1-density.
+ */
+static Tensor<float> random_values(const Shape &shape, float density, std::default_random_engine &random)
+{
+	std::bernoulli_distribution non_zero(density);
+	std::uniform_real_distribution<float> value(0.0f, 1.0f);
+
+	Tensor<float> out(shape);
+	for (size_t i = 0; i < shape.product(); i++)
+		out.at_index(i) = non_zero(random) ? value(random) : 0.0f;
+	return out;
+}
+
+template <typename T>
+static void configure_layer(T &layer)
+{
+	layer.template parameter<bool>("draw").set(false);
+	layer.template parameter<bool>("save_weights").set(false);
+	layer.template parameter<bool>("inhibition").set(true);
+	layer.template parameter<uint32_t>("epoch").set(1);
+	layer.template parameter<float>("annealing").set(0.95f);
+	layer.template parameter<float>("min_th").set(1.0f);
+	layer.template parameter<float>("t_obj").set(0.75f);
+	layer.template parameter<float>("lr_th").set(1.0f);
+	layer.template parameter<Tensor<float>>("w").template distribution<distribution::Uniform>(0.0, 1.0);
+	layer.template parameter<Tensor<float>>("th").template distribution<distribution::Gaussian>(8.0, 0.1);
+	layer.template parameter<STDP>("stdp").template set<stdp::Biological>(0.1f, 0.1f);
+}
+
+/**
+ * @brief Times process_test_sample and process_train_sample (first pass, one random patch) of a layer.
+ * The first warm-up call has index 0, which starts the test set or the epoch.
+ */
+static void bench_layer(MicroBench &bench, const std::string &name, AbstractProcess &layer, const Tensor<float> &input, bool train)
+{
+	Tensor<float> sample;
+	size_t index = 0;
+	bench.run(name + "_test", 1, [&]()
+			  { sample = input; },
+			  [&]()
+			  { layer.process_test_sample("0", sample, index++, UnboundedNumber); });
+
+	if (!train)
+		return;
+
+	index = 0;
+	bench.run(name + "_train", 1, [&]()
+			  { sample = input; },
+			  [&]()
+			  { layer.process_train_sample("0", sample, 0, index++, UnboundedNumber); });
+}
+
+static void bench_convolution(MicroBench &bench, int &argc, char **argv, int seed)
+{
+	Experiment<EmptyExecution> experiment(argv, argc, ".", ".", "microbench_convolution", seed, false);
+	auto &conv = experiment.push<layer::Convolution>(5, 5, 32);
+	configure_layer(conv);
+	conv.parameter<bool>("wta_infer").set(false);
+	experiment.initialize(Shape({32, 32, 2}));
+
+	std::default_random_engine random(seed);
+	bench_layer(bench, "convolution", conv, random_spike_times(Shape({32, 32, 2}), 0.1f, random), true);
+}
+
+/**
+ * @brief Times an inference engine of Convolution with filter_number filters on a dense input, where the time-binned engine pays off.
+ * The engine is chosen by parameters that are set before the initialization of the layer, so each engine gets its own
+ * experiment; they share the seed, hence the weights and the input.
+ */
+static void bench_convolution_engine(MicroBench &bench, int &argc, char **argv, int seed, const std::string &name, size_t filter_number,
+									 const std::function<void(layer::Convolution &)> &select_engine)
+{
+	Experiment<EmptyExecution> experiment(argv, argc, ".", ".", "microbench_" + name, seed, false);
+	auto &conv = experiment.push<layer::Convolution>(5, 5, filter_number);
+	configure_layer(conv);
+	conv.parameter<bool>("wta_infer").set(false);
+	select_engine(conv);
+	experiment.initialize(Shape({32, 32, 2}));
+
+	std::default_random_engine random(seed);
+	bench_layer(bench, name, conv, random_spike_times(Shape({32, 32, 2}), 1.0f, random), false);
+}
+
+/**
+ * @brief Times Convolution3D, with its float inference or, with engine "quantized" or "binary", its integer or binary
+ * inference, test only.
+ */
+static void bench_convolution3d(MicroBench &bench, int &argc, char **argv, int seed, const std::string &engine)
+{
+	std::string name = engine.empty() ? "convolution3d" : "convolution3d_" + engine;
+	Experiment<EmptyExecution> experiment(argv, argc, ".", ".", "microbench_" + name, seed, false);
+	auto &conv = experiment.push<layer::Convolution3D>(5, 5, 3, 16);
+	configure_layer(conv);
+	conv.parameter<bool>("save_random_start").set(false);
+	conv.parameter<bool>("log_spiking_neuron").set(false);
+	conv.parameter<bool>("quantized_infer").set(engine == "quantized");
+	conv.parameter<bool>("binary_infer").set(engine == "binary");
+	experiment.initialize(Shape({16, 16, 2, 8}));
+
+	std::default_random_engine random(seed);
+	bench_layer(bench, name, conv, random_spike_times(Shape({16, 16, 2, 8}), 0.1f, random), engine.empty());
+}
+
+static void bench_pooling(MicroBench &bench, int &argc, char **argv, int seed)
+{
+	Experiment<EmptyExecution> experiment(argv, argc, ".", ".", "microbench_pooling", seed, false);
+	auto &pool = experiment.push<layer::Pooling>(2, 2, 2, 2);
+	experiment.initialize(Shape({28, 28, 32}));
+
+	std::default_random_engine random(seed);
+	bench_layer(bench, "pooling", pool, random_spike_times(Shape({28, 28, 32}), 0.1f, random), false);
+}
+
+static void bench_processes(MicroBench &bench, int &argc, char **argv, int seed)
+{
+	Experiment<EmptyExecution> experiment(argv, argc, ".", ".", "microbench_processes", seed, false);
+	auto &filter = experiment.push<process::DefaultOnOffFilter>(7, 1.0, 4.0);
+	experiment.initialize(Shape({64, 64, 1}));
+
+	std::default_random_engine random(seed);
+	bench_layer(bench, "on_off_filter", filter, random_values(Shape({64, 64, 1}), 1.0f, random), false);
+
+	// The sum pooling is a postprocessing, it runs on the features of a layer
+	Experiment<EmptyExecution> pooling_experiment(argv, argc, ".", ".", "microbench_sum_pooling", seed, false);
+	auto &pooling = pooling_experiment.push<process::SumPooling>(4, 4);
+	pooling_experiment.initialize(Shape({28, 28, 64}));
+
+	bench_layer(bench, "sum_pooling", pooling, random_values(Shape({28, 28, 64}), 0.1f, random), false);
+}
+
+static void bench_spike_conversion(MicroBench &bench, int seed)
+{
+	std::default_random_engine random(seed);
+	Tensor<float> input = random_spike_times(Shape({28, 28, 64}), 0.1f, random);
+
+	std::vector<Spike> spikes;
+	SpikeConverter::to_spike(input, spikes);
+	size_t spike_number = spikes.size();
+
+	bench.run("to_spike", spike_number, [&]()
+			  { spikes.clear(); },
+			  [&]()
+			  { SpikeConverter::to_spike(input, spikes); });
+
+	Tensor<float> output(input.shape());
+	bench.run("from_spike", spike_number, []() {}, [&]()
+			  { SpikeConverter::from_spike(spikes, output); });
+
+	SparseTensor<float> sparse(input.shape());
+	bench.run("to_sparse_tensor", input.shape().product(), []() {}, [&]()
+			  { to_sparse_tensor(input, sparse); });
+
+	bench.run("from_sparse_tensor", sparse.values().size(), []() {}, [&]()
+			  { from_sparse_tensor(sparse, output); });
+}
+
+/**
+ * @brief The rules are initialized by the layers that hold them. Each call applies StdpUpdateNumber updates,
+ * with 10% of the presynaptic neurons that didn't fire, as in a sparse input.
+ */
+static void bench_stdp(MicroBench &bench, int &argc, char **argv, int seed)
+{
+	Experiment<EmptyExecution> experiment(argv, argc, ".", ".", "microbench_stdp", seed, false);
+	std::vector<std::pair<std::string, layer::Convolution *>> rules;
+
+	auto add_rule = [&](const std::string &name) -> SubClassParameterVariable<STDP> &
+	{
+		layer::Convolution &conv = experiment.push<layer::Convolution>(1, 1, 1);
+		configure_layer(conv);
+		conv.parameter<bool>("wta_infer").set(false);
+		rules.emplace_back(name, &conv);
+		return conv.parameter<STDP>("stdp");
+	};
+
+	add_rule("stdp_biological").set<stdp::Biological>(0.1f, 0.1f);
+	add_rule("stdp_biological_multiplicative").set<stdp::BiologicalMultiplicative>(0.1f, 1.0f, 0.1f);
+	add_rule("stdp_linear").set<stdp::Linear>(0.1f, 0.1f);
+	add_rule("stdp_multiplicative").set<stdp::Multiplicative>(0.1f, 1.0f);
+	add_rule("stdp_proportional").set<stdp::Proportional>(0.1f);
+	experiment.initialize(Shape({4, 4, 1}));
+
+	std::default_random_engine random(seed);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	std::vector<float> initial_weights(StdpUpdateNumber);
+	std::vector<Time> pre(StdpUpdateNumber);
+	std::vector<Time> post(StdpUpdateNumber);
+	for (size_t i = 0; i < StdpUpdateNumber; i++)
+	{
+		initial_weights[i] = uniform(random);
+		pre[i] = uniform(random) < 0.1f ? INFINITE_TIME : uniform(random);
+		post[i] = uniform(random);
+	}
+
+	std::vector<float> weights;
+	for (const std::pair<std::string, layer::Convolution *> &rule : rules)
+	{
+		STDP &stdp = rule.second->parameter<STDP>("stdp").get();
+		bench.run(rule.first, StdpUpdateNumber, [&]()
+				  { weights = initial_weights; },
+				  [&]()
+				  {
+					  for (size_t i = 0; i < StdpUpdateNumber; i++)
+						  weights[i] = stdp.process(weights[i], pre[i], post[i]);
+				  });
+	}
+}
+
+/**
+ * @brief Train and predict on a synthetic linearly separable problem: each sample is the sparse prototype of its class
+ * plus sparse noise, given as the sparse features of the sparse execution policies.
+ */
+static void bench_svm(MicroBench &bench, int &argc, char **argv, int seed)
+{
+	const size_t feature_number = 1024;
+	const size_t class_number = 10;
+	const size_t sample_number = 500;
+
+	// libsvm prints its solver progress with printf, out of reach of QuietOutput
+	::svm_set_print_string_function([](const char *) {});
+
+	std::default_random_engine random(seed);
+	std::vector<Tensor<float>> prototypes;
+	for (size_t i = 0; i < class_number; i++)
+		prototypes.push_back(random_values(Shape({feature_number}), 0.05f, random));
+
+	std::vector<std::pair<std::string, SparseTensor<float>>> samples;
+	for (size_t i = 0; i < sample_number; i++)
+	{
+		size_t label = i % class_number;
+		Tensor<float> sample = random_values(Shape({feature_number}), 0.05f, random);
+		for (size_t j = 0; j < feature_number; j++)
+			sample.at_index(j) += prototypes[label].at_index(j);
+		samples.emplace_back(std::to_string(label), to_sparse_tensor(sample));
+	}
+
+	for (uint32_t solver : {analysis::Svm::SolverLibsvm, analysis::Svm::SolverLinear})
+	{
+		std::string name = solver == analysis::Svm::SolverLinear ? "svm_linear" : "svm_libsvm";
+
+		// The analyses are attached to the output of a layer, the pooling only gives them a shape
+		Experiment<EmptyExecution> experiment(argv, argc, ".", ".", "microbench_" + name, seed, false);
+		auto &pool = experiment.push<layer::Pooling>(1, 1, 1, 1);
+		auto &svm = experiment.output<DefaultOutput>(pool, 0.0, 1.0).add_analysis<analysis::Svm>(0, solver);
+		experiment.initialize(Shape({1, 1, feature_number}));
+
+		auto train = [&]()
+		{
+			svm.resize(Shape({feature_number}));
+			for (size_t pass = 0; pass < svm.train_pass_number(); pass++)
+			{
+				svm.before_train_pass(pass);
+				for (const std::pair<std::string, SparseTensor<float>> &sample : samples)
+					svm.process_train_sparse_sample(sample.first, sample.second, pass);
+				svm.after_train_pass(pass);
+			}
+		};
+
+		auto test = [&]()
+		{
+			svm.before_test();
+			for (const std::pair<std::string, SparseTensor<float>> &sample : samples)
+				svm.process_test_sparse_sample(sample.first, sample.second);
+			svm.after_test();
+		};
+
+		// The test releases the libsvm model, an empty one frees the model of the previous training
+		auto release = [&]()
+		{
+			svm.before_test();
+			svm.after_test();
+		};
+
+		bench.run(name + "_train", sample_number, release, train);
+		bench.run(name + "_predict", sample_number, train, test);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 6)
+	{
+		throw std::runtime_error("Usage: " + std::string(argv[0]) + " [ <OUTPUT_JSON = microbench.json> ] [ <SEED = 0> ] [ <ITERATIONS = 100> ] [ <WARMUP = 10> ] [ <FILTER> ]");
+	}
+
+	std::string output_path = argc > 1 ? argv[1] : "microbench.json";
+	int seed = argc > 2 ? std::stoi(argv[2]) : 0;
+	size_t iterations = argc > 3 ? std::stoul(argv[3]) : 100;
+	size_t warmup = argc > 4 ? std::stoul(argv[4]) : 10;
+	std::string filter = argc > 5 ? argv[5] : "";
+
+	MicroBench bench(std::max(iterations, MinIterations), warmup, filter);
+
+	{
+		QuietOutput quiet;
+		bench_convolution(bench, argc, argv, seed);
+		bench_convolution_engine(bench, argc, argv, seed, "convolution_dense_input", 32, [](layer::Convolution &) {});
+		bench_convolution_engine(bench, argc, argv, seed, "convolution_dense_bins16", 32, [](layer::Convolution &conv)
+								 { conv.parameter<uint32_t>("dense_bins").set(16); });
+		bench_convolution_engine(bench, argc, argv, seed, "convolution_dense_quantized", 32, [](layer::Convolution &conv)
+								 { conv.parameter<bool>("quantized_infer").set(true); });
+		bench_convolution_engine(bench, argc, argv, seed, "convolution_dense_binary", 32, [](layer::Convolution &conv)
+								 { conv.parameter<bool>("binary_infer").set(true); });
+		// A wide layer with the WTA inference, the setting where the time-binned engine is meant to be used
+		bench_convolution_engine(bench, argc, argv, seed, "convolution_wide_input", 128, [](layer::Convolution &conv)
+								 { conv.parameter<bool>("wta_infer").set(true); });
+		bench_convolution_engine(bench, argc, argv, seed, "convolution_wide_bins16", 128, [](layer::Convolution &conv)
+								 {
+									 conv.parameter<bool>("wta_infer").set(true);
+									 conv.parameter<uint32_t>("dense_bins").set(16); });
+		bench_convolution3d(bench, argc, argv, seed, "");
+		bench_convolution3d(bench, argc, argv, seed, "quantized");
+		bench_convolution3d(bench, argc, argv, seed, "binary");
+		bench_pooling(bench, argc, argv, seed);
+		bench_processes(bench, argc, argv, seed);
+		bench_spike_conversion(bench, seed);
+		bench_stdp(bench, argc, argv, seed);
+		bench_svm(bench, argc, argv, seed);
+	}
+
+	bench.print(std::cout);
+	bench.save_json(output_path, seed);
+	std::cout << "Results written to " << output_path << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,179 @@
+#include "Experiment.h"
+#include "dataset/Synthetic.h"
+#include "stdp/Biological.h"
+#include "layer/Convolution3D.h"
+#include "layer/Pooling.h"
+#include "Distribution.h"
+#include "execution/SparseIntermediateExecution.h"
+#include "analysis/Svm.h"
+#include "process/Scaling.h"
+#include "process/Pooling.h"
+#include "tool/Tracer.h"
+#include "dep/ArduinoJson-v6.17.3.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+/**
+ * @brief End-to-end throughput of the canonical Convolution3D -> Pooling3D -> SVM pipeline on the synthetic datasets, a baseline
+ * that needs no data file. Each dataset runs as an experiment with tracing enabled; the spans of its trace are summed per phase
+ * (loading, training pass and test of each process, output conversion, analysis) and reported in samples per second.
+ *
+ * Usage: csnn_pipeline_bench [ <DATASET = all|image|video|spikes> ] [ <TRAIN_SAMPLES = 1000> ] [ <TEST_SAMPLES = 200> ] [ <OUTPUT_PATH = result> ] [ <SEED = 0> ]
+ */
+
+struct Phase
+{
+	std::string name;
+	double seconds;
+	size_t samples;
+};
+
+/**
+ * @brief Sums the spans of the trace per name. A phase counts the samples that go through it once: the training passes the
+ * train set, the tests the test set, the loading, the output conversion and the analyses both.
+ */
+static std::vector<Phase> read_phases(const std::string &trace_filename, size_t train_number, size_t test_number)
+{
+	std::ifstream file(trace_filename);
+	if (!file.good())
+		throw std::runtime_error("Can't open file " + trace_filename);
+
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	DynamicJsonDocument trace(4 * text.size() + 4096);
+	DeserializationError error = deserializeJson(trace, text);
+	if (error)
+		throw std::runtime_error("Can't parse " + trace_filename + ": " + error.c_str());
+
+	// The inputs share a single load phase
+	std::vector<Phase> phases;
+	for (JsonObject event : trace["traceEvents"].as<JsonArray>())
+	{
+		std::string category = event["cat"].as<std::string>();
+		std::string name = category == "load" ? "load" : category + " " + event["name"].as<std::string>();
+
+		size_t samples = train_number + test_number;
+		if (category == "train")
+			samples = train_number;
+		else if (category == "test")
+			samples = test_number;
+
+		auto it = std::find_if(std::begin(phases), std::end(phases), [&name](const Phase &phase)
+							   { return phase.name == name; });
+		if (it == std::end(phases))
+		{
+			phases.push_back(Phase{name, 0.0, samples});
+			it = std::end(phases) - 1;
+		}
+		it->seconds += event["dur"].as<double>() / 1e6;
+	}
+
+	return phases;
+}
+
+static void print_phases(const std::string &dataset, const std::vector<Phase> &phases)
+{
+	std::cout << std::endl
+			  << "===" << dataset << "===" << std::endl;
+	std::cout << std::left << std::setw(56) << "phase" << std::right << std::setw(12) << "seconds" << std::setw(10) << "samples"
+			  << std::setw(14) << "samples/s" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	for (const Phase &phase : phases)
+	{
+		std::cout << std::left << std::setw(56) << phase.name << std::right << std::setw(12) << phase.seconds << std::setw(10) << phase.samples
+				  << std::setw(14) << std::setprecision(1) << (phase.seconds > 0.0 ? phase.samples / phase.seconds : 0.0) << std::setprecision(3) << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+}
+
+static std::vector<Phase> run_pipeline(int &argc, char **argv, const std::string &dataset, size_t train_number, size_t test_number,
+									   const std::string &output_path, int seed)
+{
+	Experiment<SparseIntermediateExecution> experiment(argv, argc, output_path, output_path, "pipeline_" + dataset, seed, true);
+
+	// The train and test sets share their classes and differ by their sample seed
+	size_t filter_depth = 1;
+	if (dataset == "image")
+	{
+		experiment.add_train<dataset::SyntheticImage>(32, 32, 1, 10, train_number, 0.8f, seed);
+		experiment.add_test<dataset::SyntheticImage>(32, 32, 1, 10, test_number, 0.8f, seed + 1);
+		experiment.push<LatencyCoding>();
+	}
+	else if (dataset == "video")
+	{
+		experiment.add_train<dataset::SyntheticVideo>(32, 32, 1, 8, 8, train_number, 0.9f, seed);
+		experiment.add_test<dataset::SyntheticVideo>(32, 32, 1, 8, 8, test_number, 0.9f, seed + 1);
+		experiment.push<LatencyCoding>();
+		filter_depth = 3;
+	}
+	else if (dataset == "spikes")
+	{
+		experiment.add_train<dataset::SyntheticSpikes>(16, 16, 8, 10, train_number, 0.9f, seed);
+		experiment.add_test<dataset::SyntheticSpikes>(16, 16, 8, 10, test_number, 0.9f, seed + 1);
+	}
+	else
+	{
+		throw std::runtime_error("Unknown synthetic dataset " + dataset);
+	}
+
+	float t_obj = 0.75f;
+
+	auto &conv1 = experiment.push<layer::Convolution3D>(5, 5, filter_depth, 32);
+	conv1.set_name("conv1");
+	conv1.parameter<bool>("draw").set(false);
+	conv1.parameter<bool>("save_weights").set(false);
+	conv1.parameter<bool>("save_random_start").set(false);
+	conv1.parameter<bool>("log_spiking_neuron").set(false);
+	conv1.parameter<bool>("inhibition").set(true);
+	conv1.parameter<uint32_t>("epoch").set(1);
+	conv1.parameter<float>("annealing").set(0.95f);
+	conv1.parameter<float>("min_th").set(1.0f);
+	conv1.parameter<float>("t_obj").set(t_obj);
+	conv1.parameter<float>("lr_th").set(1.0f);
+	conv1.parameter<Tensor<float>>("w").distribution<distribution::Uniform>(0.0, 1.0);
+	conv1.parameter<Tensor<float>>("th").distribution<distribution::Gaussian>(8.0, 0.1);
+	conv1.parameter<STDP>("stdp").set<stdp::Biological>(0.1f, 0.1f);
+
+	auto &pool1 = experiment.push<layer::Pooling3D>(2, 2, 1, 2, 2);
+	pool1.set_name("pool1");
+
+	auto &pool1_out = experiment.output<TimeObjectiveOutput>(pool1, t_obj);
+	pool1_out.add_postprocessing<process::SumPooling>(2, 2);
+	pool1_out.add_postprocessing<process::FeatureScaling>();
+	pool1_out.add_analysis<analysis::Svm>();
+
+	experiment.enable_trace();
+	experiment.run(10000);
+	experiment.enable_trace(false);
+
+	return read_phases(output_path + "/trace_" + experiment.name() + ".json", train_number, test_number);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 6)
+	{
+		throw std::runtime_error("Usage: " + std::string(argv[0]) + " [ <DATASET = all|image|video|spikes> ] [ <TRAIN_SAMPLES = 1000> ] [ <TEST_SAMPLES = 200> ] [ <OUTPUT_PATH = result> ] [ <SEED = 0> ]");
+	}
+
+	std::string dataset = argc > 1 ? argv[1] : "all";
+	size_t train_number = argc > 2 ? std::stoul(argv[2]) : 1000;
+	size_t test_number = argc > 3 ? std::stoul(argv[3]) : 200;
+	std::string output_path = argc > 4 ? argv[4] : "result";
+	int seed = argc > 5 ? std::stoi(argv[5]) : 0;
+
+	std::vector<std::string> datasets;
+	if (dataset == "all")
+		datasets = {"image", "video", "spikes"};
+	else
+		datasets = {dataset};
+
+	std::vector<std::pair<std::string, std::vector<Phase>>> results;
+	for (const std::string &name : datasets)
+		results.emplace_back(name, run_pipeline(argc, argv, name, train_number, test_number, output_path, seed));
+
+	for (const std::pair<std::string, std::vector<Phase>> &result : results)
+		print_phases(result.first, result.second);
+
+	return 0;
+}
@@ -7,6 +7,7 @@
 #include "Distribution.h"
 #include "execution/TestingExecution.h"
 #include "execution/TestingSparseExecution.h"
+#include "execution/PipelinedExecution.h"
 #include "analysis/SaveFeatureNumpy.h"
 #include "analysis/Activity.h"
 #include "analysis/Coherence.h"
@@ -15,6 +16,7 @@
 #include "process/Pooling.h"
 #include "process/GrayScale.h"
 #include "process/OnOffFilter.h"
+#include "process/SpikeEncoder.h"
 #include "process/WhitenPatchesLoader.h"
 #include "process/SeparateSign.h"
 #include "dep/ArduinoJson-v6.17.3.h"
@@ -113,6 +115,11 @@ int main(int argc, char **argv)
 	{
 		experiment = new Experiment<TestingSparseExecution>(argv, argc, output_path, model_path, exp_name, 0, false);
 	}
+	else if (config.containsKey("pipelined") && config["pipelined"] == true)
+	{
+		// Streams the samples through the layers, each one on its own thread
+		experiment = new Experiment<PipelinedExecution>(argv, argc, output_path, model_path, exp_name, 0, false);
+	}
 	else
 	{
 		experiment = new Experiment<TestingExecution>(argv, argc, output_path, model_path, exp_name, 0, false);
@@ -123,7 +130,10 @@ int main(int argc, char **argv)
 	load_dataset(experiment, data_path, label_path, dataset_name);
 
 	// Preprocessing
-	if (config.containsKey("whiten") && config["whiten"] == true)
+	// With fused_encoding, the DoG filter, the scaling and the latency coding are done by a single SpikeEncoder stage
+	bool whiten = config.containsKey("whiten") && config["whiten"] == true;
+	bool fused_encoding = config.containsKey("fused_encoding") && config["fused_encoding"] == true && config["latency_coding"] == true;
+	if (whiten)
 	{
 		experiment->push<process::WhitenPatchesLoader>(get_build_path() + "/../whiten-filters/" + dataset_name);
 		experiment->push<process::SeparateSign>();
@@ -134,18 +144,27 @@ int main(int argc, char **argv)
 		{
 			experiment->push<process::GrayScale>();
 		}
-		if (!config["dog"].isNull())
+		if (!config["dog"].isNull() && !fused_encoding)
 		{
 			experiment->push<process::DefaultOnOffFilter>(config["dog"][0], config["dog"][1], config["dog"][2]);
 		}
 	}
-	if (config["feature_scaling"] == true)
+	if (fused_encoding)
 	{
-		experiment->push<process::FeatureScaling>();
+		bool dog = !whiten && !config["dog"].isNull();
+		uint32_t scaling = config["feature_scaling"] == true ? process::SpikeEncoder::ScaleFeature : process::SpikeEncoder::ScaleNone;
+		experiment->push<process::SpikeEncoder>(dog ? config["dog"][0].as<size_t>() : 0, dog ? config["dog"][1].as<float>() : 1.0f, dog ? config["dog"][2].as<float>() : 4.0f, 0.0f, scaling);
 	}
-	if (config["latency_coding"] == true)
+	else
 	{
-		experiment->push<LatencyCoding>();
+		if (config["feature_scaling"] == true)
+		{
+			experiment->push<process::FeatureScaling>();
+		}
+		if (config["latency_coding"] == true)
+		{
+			experiment->push<LatencyCoding>();
+		}
 	}
 
 	// Convolutional layer
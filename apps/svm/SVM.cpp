@@ -68,6 +68,8 @@ int main(int argc, char **argv)
 		svm_out.add_postprocessing<process::SumPooling>(20, 20);
 		// svm_out.add_postprocessing<process::TemporalPooling>(2);
 		svm_out.add_analysis<analysis::Svm>();
+		// To search c in a single run, evaluate a list of values by 5-fold cross-validation instead:
+		// svm_out.add_analysis<analysis::Svm>(std::vector<float>{0.01f, 0.1f, 1.0f, 10.0f, 100.0f}, 5);
 
 		experiment.run(10000);
 	}
@@ -22,6 +22,7 @@
 #include "tool/VideoFrameSelector.h"
 #include "tool/AutoFrameNumberSelector.h"
 #include "process/MaxScaling.h"
+#include "process/SpikeEncoder.h"
 
 /**
  *  use this loop to find the ideal t_obj, for (float tobj = 0.10f; tobj <= 1.01f; tobj += 0.05f) float rounded_down = floorf(tobj * 100) / 100;
@@ -73,10 +74,8 @@ int main(int argc, char **argv)
 		}
 		std::string input_path(input_path_ptr);
 
-		experiment.push<process::DefaultOnOffFilter>(7, 1.0, 4.0); //identificare contoururi
-
-		experiment.push<process::MaxScaling>(); //normalieaza datele intre 0 si 1
-		experiment.push<LatencyCoding>(); 
+		// DefaultOnOffFilter(7, 1.0, 4.0) -> MaxScaling -> LatencyCoding in a single stage
+		experiment.push<process::SpikeEncoder>(7, 1.0, 4.0, 0, process::SpikeEncoder::ScaleMax);
 
 		// The location of the dataset Videos, seperated into train and test folders that contain labeled folders of videos.
 		experiment.add_train<dataset::Video>(input_path + "/train", _video_frames, _frame_gap_train, _th_mv, _train_sample_per_video, _grey, experiment.name(), _draw, _frame_size_width, _frame_size_height);
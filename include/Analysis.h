@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include "Tensor.h"
+#include "SparseTensor.h"
 #include "ClassParameter.h"
 
 class AbstractExperiment;
@@ -31,6 +32,18 @@ public:
 	virtual void process_train_sample(const std::string& label, const Tensor<float>& sample, size_t current_pass) = 0;
 	virtual void process_test_sample(const std::string& label, const Tensor<float>& sample) = 0;
 
+	/**
+	 * @brief Entry points of the sparse execution policies. By default the sample is densified, the analyses that only need
+	 * the non-zero values override them to avoid rebuilding the dense tensor.
+	 */
+	virtual void process_train_sparse_sample(const std::string& label, const SparseTensor<float>& sample, size_t current_pass) {
+		process_train_sample(label, from_sparse_tensor(sample), current_pass);
+	}
+
+	virtual void process_test_sparse_sample(const std::string& label, const SparseTensor<float>& sample) {
+		process_test_sample(label, from_sparse_tensor(sample));
+	}
+
 	virtual void before_train_pass(size_t) {
 
 	}
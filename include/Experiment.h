@@ -19,6 +19,10 @@
 #include "InputLayer.h"
 #include "Logger.h"
 #include "Monitor.h"
+#include "tool/CheckpointWriter.h"
+#include "tool/Counters.h"
+#include "tool/StageCache.h"
+#include "tool/Tracer.h"
 
 #include <sys/stat.h>
 #include <unistd.h>
@@ -38,6 +42,7 @@ public:
 
 	void load(const std::string &filename);
 	void save(const std::string &filename) const;
+	void save_async(const std::string &filename) const;
 
 	template <typename T, typename... Args>
 	void add_tool(Args &&...args)
@@ -97,6 +102,13 @@ public:
 
 	void add_train_step(Layer& layer, size_t epoch_number);
 */
+	template<typename T, typename... Args>
+	T& add_monitor(Args&&... args) {
+		T* monitor = new T(std::forward<Args>(args)...);
+		_monitors.push_back(monitor);
+		return *monitor;
+	}
+
 	template <typename T, typename... Args>
 	Output &output(const Layer &layer, Args &&...args)
 	{
@@ -110,12 +122,49 @@ public:
 	void remove_all_output();
 
 	void initialize(const Shape &input_shape);
-	void run(size_t refresh_interval);
+	void enable_checkpoint(size_t epoch_interval = 1);
+	void enable_trace(bool enable = true);
+	void enable_cache(const std::string& path = "");
+	void run(size_t refresh_interval, bool resume = false);
 	int wait();
 
 	void tick(size_t current_layer_index, size_t sample_count);
 	void refresh(size_t current_layer_index);
-	void epoch(size_t current_layer_index, size_t epoch_count);
+	void epoch(const AbstractProcess& process, size_t epoch_count);
+	bool skip_train_pass(const AbstractProcess& process, size_t pass);
+
+	size_t cached_process_number() const;
+
+	/**
+	 * @brief Replaces the run of the process index, one of the first cached_process_number(), by its cache entry: its trained
+	 * parameters and the random generator are restored, and the output sets are loaded when a later stage needs them (an output
+	 * of the process, or the next process).
+	 */
+	template<typename Data>
+	void restore_cached_process(size_t index, Data& train_set, Data& test_set) {
+		std::string path = _restore_cached_state(index);
+		if(_cached_set_needed(index)) {
+			tool::TraceSpan span("cache", "load " + _process_list[index]->class_name() + " " + _process_list[index]->name());
+			tool::StageCache::read_set(path + "/train.bin", train_set);
+			tool::StageCache::read_set(path + "/test.bin", test_set);
+		}
+	}
+
+	/**
+	 * @brief Stores the output sets of the process index, with its trained parameters and the random generator, when the cache is enabled.
+	 */
+	template<typename Data>
+	void cache_process(size_t index, const Data& train_set, const Data& test_set) {
+		if(!_cache.is_open()) {
+			return;
+		}
+
+		tool::TraceSpan span("cache", "store " + _process_list[index]->class_name() + " " + _process_list[index]->name());
+		std::string path = _begin_cache_entry(index);
+		tool::StageCache::write_set(path + "/train.bin", train_set);
+		tool::StageCache::write_set(path + "/test.bin", test_set);
+		_cache.commit(_cache_keys[index]);
+	}
 
 	const std::string &name() const;
 
@@ -169,7 +218,14 @@ protected:
 	std::ostream &_print_date(std::ostream &stream) const;
 
 	void _save(const std::string &filename) const;
+	void _save(std::ostream &stream) const;
 	void _load(const std::string &filename);
+	void _save_checkpoint(const AbstractProcess& process, size_t epoch_count);
+	bool _load_checkpoint();
+	void _prepare_cache();
+	std::string _restore_cached_state(size_t index);
+	bool _cached_set_needed(size_t index) const;
+	std::string _begin_cache_entry(size_t index);
 	void _check_data_shape(const Shape &shape);
 
 #ifdef ENABLE_QT
@@ -205,6 +261,18 @@ protected:
 	std::vector<Monitor*> _monitors;
 
 	std::vector<Output*> _outputs;
+
+	std::string _checkpoint_path;
+	size_t _checkpoint_interval;
+	const AbstractProcess* _resume_process;
+	size_t _resume_pass;
+	std::string _resume_random_state;
+	mutable tool::CheckpointWriter _writer;
+
+	std::string _cache_path;
+	tool::StageCache _cache;
+	std::vector<std::string> _cache_keys;
+	size_t _cached_process_number;
 };
 /**
  * @brief 
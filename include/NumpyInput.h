@@ -1,9 +1,15 @@
 #ifndef _NUMPY_INPUT_H
 #define _NUMPY_INPUT_H
 
+#include <memory>
+
 #include "Input.h"
-#include "NumpyReader.h"
+#include "NumpyMapping.h"
 
+/**
+ * @brief Samples of an .npz archive saved with numpy.savez(data, label): arr_0.npy holds the N x width x height x depth samples and
+ * arr_1.npy the N labels. The archive is memory mapped, each sample is copied in one block from the mapping.
+ */
 class NumpyInput : public Input {
 
 public:
@@ -22,9 +28,10 @@ public:
 
 private:
 	std::string _name;
-	NumpyArchive _archive;
-	NumpyArray* _data;
-	NumpyArray* _label;
+	std::unique_ptr<NumpyMapping> _mapping;
+	const NumpyView* _data;
+	const NumpyView* _label;
+	Shape _shape;
 
 	size_t _current;
 };
@@ -0,0 +1,188 @@
+#ifndef _NUMPY_MAPPING_H
+#define _NUMPY_MAPPING_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+enum NumpyType {
+	NUMPY_FLOAT32,
+	NUMPY_FLOAT64,
+	NUMPY_INT32,
+	NUMPY_INT64,
+	NUMPY_UINT8
+};
+
+/**
+ * @brief Read-only view on an array of a NumpyMapping. The elements stay in the mapped pages, in their stored type and byte order,
+ * and are converted when they are copied out.
+ * The view borrows the pages: it is owned by its NumpyMapping and can't be copied, only moved into it. Use it by reference,
+ * while the mapping is alive.
+ */
+class NumpyView {
+
+public:
+	NumpyView(const char* data, const std::vector<size_t>& dimension, NumpyType type, bool swap);
+	NumpyView(const NumpyView& that) = delete;
+	NumpyView(NumpyView&& that) = default;
+	NumpyView& operator=(const NumpyView& that) = delete;
+	NumpyView& operator=(NumpyView&& that) = default;
+
+	size_t dimension_number() const {
+		return _dimension.size();
+	}
+
+	size_t dimension(size_t index) const {
+		return _dimension.at(index);
+	}
+
+	const std::vector<size_t>& dimensions() const {
+		return _dimension;
+	}
+
+	size_t size() const {
+		return _size;
+	}
+
+	NumpyType type() const {
+		return _type;
+	}
+
+	size_t element_size() const;
+
+	/**
+	 * @brief Copies count elements starting at the flat index, converted to T. The copy is a single memcpy when the array is stored as T
+	 * in the native byte order.
+	 */
+	template<typename T>
+	void copy(size_t index, size_t count, T* dst) const {
+		if(index+count > _size) {
+			throw std::out_of_range("NumpyView: range ["+std::to_string(index)+", "+std::to_string(index+count)+") out of "+std::to_string(_size));
+		}
+
+		switch(_type) {
+		case NUMPY_FLOAT32:
+			_copy<float>(index, count, dst);
+			break;
+		case NUMPY_FLOAT64:
+			_copy<double>(index, count, dst);
+			break;
+		case NUMPY_INT32:
+			_copy<int32_t>(index, count, dst);
+			break;
+		case NUMPY_INT64:
+			_copy<int64_t>(index, count, dst);
+			break;
+		case NUMPY_UINT8:
+			_copy<uint8_t>(index, count, dst);
+			break;
+		}
+	}
+
+	template<typename T>
+	T at_index(size_t index) const {
+		T out;
+		copy(index, 1, &out);
+		return out;
+	}
+
+	/**
+	 * @brief Pointer to the elements in the mapping, to use them in place. nullptr unless the array is stored as T, in the native byte
+	 * order and aligned for T (an .npz member starts wherever its zip header ends).
+	 */
+	template<typename T>
+	const T* data() const {
+		if(_swap || element_size() != sizeof(T) || reinterpret_cast<uintptr_t>(_data) % alignof(T) != 0) {
+			return nullptr;
+		}
+		if((std::is_same<T, float>::value && _type == NUMPY_FLOAT32) || (std::is_same<T, double>::value && _type == NUMPY_FLOAT64) ||
+		   (std::is_same<T, int32_t>::value && _type == NUMPY_INT32) || (std::is_same<T, int64_t>::value && _type == NUMPY_INT64) ||
+		   (std::is_same<T, uint8_t>::value && _type == NUMPY_UINT8)) {
+			return reinterpret_cast<const T*>(_data);
+		}
+		return nullptr;
+	}
+
+private:
+	template<typename S, typename T>
+	void _copy(size_t index, size_t count, T* dst) const {
+		const char* src = _data+index*sizeof(S);
+
+		if constexpr(std::is_same<S, T>::value) {
+			if(!_swap) {
+				std::memcpy(dst, src, count*sizeof(T));
+				return;
+			}
+		}
+
+		for(size_t i=0; i<count; i++) {
+			S value;
+			std::memcpy(&value, src+i*sizeof(S), sizeof(S));
+			if(_swap) {
+				char* bytes = reinterpret_cast<char*>(&value);
+				std::reverse(bytes, bytes+sizeof(S));
+			}
+			dst[i] = static_cast<T>(value);
+		}
+	}
+
+	const char* _data;
+	std::vector<size_t> _dimension;
+	size_t _size;
+	NumpyType _type;
+	bool _swap;
+};
+
+/**
+ * @brief Read-only memory mapping of a .npy file, or of the stored (uncompressed) members of a .npz archive.
+ * Opening the file only parses the headers: the pages of the arrays are read on their first access and the page cache is shared
+ * by all the processes that map the same file, so a large dataset neither has to be loaded up front nor be copied by each run.
+ */
+class NumpyMapping {
+
+public:
+	NumpyMapping(const std::string& filename);
+	NumpyMapping(const NumpyMapping& that) = delete;
+	NumpyMapping& operator=(const NumpyMapping& that) = delete;
+	~NumpyMapping();
+
+	bool has(const std::string& name) const;
+
+	/**
+	 * @brief Member of an .npz archive, with its file name (arr_0.npy, ...).
+	 */
+	const NumpyView& at(const std::string& name) const;
+
+	/**
+	 * @brief Array of an .npy file.
+	 */
+	const NumpyView& array() const;
+
+	const std::string& filename() const {
+		return _filename;
+	}
+
+	size_t byte_size() const {
+		return _size;
+	}
+
+private:
+	void _read_zip();
+	size_t _read_npy(size_t offset, const std::string& name);
+	void _check(size_t offset, size_t length) const;
+
+	template<typename T>
+	T _read(size_t offset) const;
+
+	std::string _filename;
+	const char* _data;
+	size_t _size;
+	std::map<std::string, NumpyView> _arrays;
+};
+
+#endif
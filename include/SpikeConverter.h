@@ -14,6 +14,12 @@ public:
 	static void to_spike(const Tensor<Time>& in, std::vector<Spike>& out, size_t x_start, size_t y_start, size_t x_end, size_t y_end);
 
 	static void from_spike(const std::vector<Spike>& in, Tensor<Time>& out);
+
+	/**
+	 * @brief Stable sort of a spike train by timestamp. Large trains are ordered with a LSD radix sort on the bit pattern
+	 * of the timestamps, which is linear in the number of spikes; spikes sharing a timestamp keep their scan order.
+	 */
+	static void sort(std::vector<Spike>& spikes);
 };
 
 #endif
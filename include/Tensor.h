@@ -7,6 +7,10 @@
 #include <sstream>
 #include <fstream>
 #include <numeric>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <initializer_list>
 #include "Spike.h"
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
@@ -23,39 +27,37 @@ class Shape
 {
 
 public:
-	Shape() : _dims(), _product()
+	// Maximum number of dimensions, the dimensions are stored inline so that copying a shape never allocates
+	static constexpr size_t MaxRank = 6;
+
+	Shape() : _number(0), _dims(), _product()
 	{
-		_product.push_back(0);
+		_product[0] = 0;
 	}
 
-	Shape(const std::vector<size_t> &dims) : _dims(dims), _product()
+	Shape(const size_t *dims, size_t number) : _number(number), _dims(), _product()
 	{
-		for (size_t i = 0; i < _dims.size(); i++)
+		if (number > MaxRank)
 		{
-			_product.push_back(std::accumulate(std::begin(_dims) + i, std::end(_dims), 1, std::multiplies<size_t>()));
-
+			throw std::runtime_error("Shape: at most " + std::to_string(MaxRank) + " dimensions are supported, got " + std::to_string(number));
 		}
-		_product.push_back(1);
-	}
 
-	Shape(const Shape &that) noexcept : _dims(that._dims), _product(that._product)
-	{
+		std::copy(dims, dims + number, _dims);
+		_product[number] = 1;
+		for (size_t i = number; i > 0; i--)
+		{
+			_product[i - 1] = _product[i] * _dims[i - 1];
+		}
 	}
 
-	Shape(Shape &&that) noexcept : _dims(std::move(that._dims)), _product(std::move(that._product))
+	Shape(std::initializer_list<size_t> dims) : Shape(dims.begin(), dims.size())
 	{
 	}
 
-	~Shape()
+	Shape(const std::vector<size_t> &dims) : Shape(dims.data(), dims.size())
 	{
 	}
 
-	Shape& operator=(const Shape& that) noexcept {
-		_dims = that._dims;
-		_product = that._product;
-		return *this;
-	}
-
 	/**
 	 * @brief return the number of dimentions
 	 *
@@ -63,7 +65,7 @@ public:
 	 */
 	size_t number() const
 	{
-		return _dims.size();
+		return _number;
 	}
 
 	/**
@@ -74,33 +76,46 @@ public:
 	 */
 	size_t dim(size_t i) const
 	{
-		return _dims.at(i);
+		if (i >= _number)
+		{
+			throw std::out_of_range("Shape::dim: " + std::to_string(i) + " >= " + std::to_string(_number));
+		}
+		return _dims[i];
+	}
+
+	/**
+	 * @brief return the distance between two consecutive indexes of the dimension i in a row-major storage.
+	 */
+	size_t stride(size_t i) const
+	{
+		ASSERT_DEBUG(i < _number);
+		return _product[i + 1];
 	}
 
 	size_t product() const
 	{
-		return _product.front();
+		return _product[0];
 	}
 
 	template <typename... Index>
 	size_t to_index(Index &&...index) const
 	{
-		ASSERT_DEBUG(sizeof...(Index) == _dims.size());
-		return _to_index<0, Index...>(std::forward<Index>(index)...);
+		ASSERT_DEBUG(sizeof...(Index) == _number);
+		return _to_index(std::make_index_sequence<sizeof...(Index)>(), static_cast<size_t>(index)...);
 	}
 
 	bool operator==(const Shape& that) const {
-		return _dims == that._dims;
+		return _number == that._number && std::equal(_dims, _dims + _number, that._dims);
 	}
 
 	bool operator!=(const Shape& that) const {
-		return _dims != that._dims;
+		return !(*this == that);
 	}
 
 	void print(std::ostream& stream) const {
 		stream << "[";
 
-		for(size_t i=0; i<_dims.size(); i++) {
+		for(size_t i=0; i<_number; i++) {
 			if(i != 0)
 				stream << ", ";
 			stream << _dims[i];
@@ -115,20 +130,322 @@ public:
 	}
 
 private:
-	template<size_t Index, typename Head, typename... Tail>
-	size_t _to_index(Head head, Tail&&... tail) const {
-		ASSERT_DEBUG(static_cast<int64_t>(head) >= 0 && static_cast<int64_t>(head) < static_cast<int64_t>(_dims.at(Index)));
-		return _product[Index+1]*head+_to_index<Index+1, Tail...>(std::forward<Tail>(tail)...);
+	// The recursion over the indexes is unrolled at compile time into a sum of products
+	template<size_t... I, typename... Index>
+	size_t _to_index(std::index_sequence<I...>, Index... index) const {
+		ASSERT_DEBUG(((index < _dims[I]) && ... && true));
+		return (static_cast<size_t>(0) + ... + (_product[I+1]*index));
+	}
+
+	size_t _number;
+	size_t _dims[MaxRank];
+	size_t _product[MaxRank+1];
+
+};
+
+/**
+ * @brief Storage of the tensors. Blocks are aligned on a cache line, so that SIMD kernels can use aligned loads.
+ * When TENSOR_POOL is defined, the blocks are rounded to power of two size classes and the freed ones are kept in a
+ * thread-local free list, so that processing samples of the same shapes doesn't reach the heap after the first ones.
+ */
+class TensorMemory
+{
+
+public:
+	static constexpr size_t Alignment = 64;
+
+	TensorMemory() = delete;
+
+	static void *allocate(size_t bytes, size_t &capacity)
+	{
+		if (bytes == 0)
+		{
+			capacity = 0;
+			return nullptr;
+		}
+#ifdef TENSOR_POOL
+		size_t size_class = _size_class(bytes);
+		capacity = static_cast<size_t>(1) << size_class;
+		std::vector<void *> &list = _pool().free_list[size_class];
+		if (!list.empty())
+		{
+			void *ptr = list.back();
+			list.pop_back();
+			return ptr;
+		}
+#else
+		capacity = (bytes + Alignment - 1) / Alignment * Alignment;
+#endif
+		return ::operator new(capacity, std::align_val_t(Alignment));
+	}
+
+	static void deallocate(void *ptr, size_t capacity)
+	{
+		if (ptr == nullptr)
+		{
+			return;
+		}
+#ifdef TENSOR_POOL
+		std::vector<void *> &list = _pool().free_list[_size_class(capacity)];
+		if (list.size() < PoolDepth)
+		{
+			list.push_back(ptr);
+			return;
+		}
+#else
+		(void)capacity;
+#endif
+		::operator delete(ptr, std::align_val_t(Alignment));
+	}
+
+private:
+#ifdef TENSOR_POOL
+	// Maximum number of cached blocks per size class and per thread
+	static constexpr size_t PoolDepth = 16;
+	static constexpr size_t SizeClassNumber = 8 * sizeof(size_t);
+
+	struct Pool
+	{
+		Pool() : free_list()
+		{
+		}
+
+		~Pool()
+		{
+			for (std::vector<void *> &list : free_list)
+			{
+				for (void *ptr : list)
+				{
+					::operator delete(ptr, std::align_val_t(Alignment));
+				}
+			}
+		}
+
+		std::vector<void *> free_list[SizeClassNumber];
+	};
+
+	static Pool &_pool()
+	{
+		static thread_local Pool pool;
+		return pool;
+	}
+
+	static size_t _size_class(size_t bytes)
+	{
+		size_t size_class = 6; // one cache line
+		while ((static_cast<size_t>(1) << size_class) < bytes)
+		{
+			size_class++;
+		}
+		return size_class;
+	}
+#endif
+};
+
+/**
+ * @brief Non-owning strided view on the storage of a tensor. Slicing or narrowing a view only changes its offset, shape and
+ * strides, so a frame of a video or a patch of a sample can be read or written in place instead of being copied into a new tensor.
+ * A view doesn't extend the lifetime of the storage, it must not be used after the tensor is destroyed or resized.
+ */
+template<typename T>
+class TensorView {
+
+public:
+	TensorView() : _data(nullptr), _shape(), _strides() {
+
+	}
+
+	TensorView(T* data, const Shape& shape) : _data(data), _shape(shape), _strides() {
+		for(size_t i=0; i<shape.number(); i++) {
+			_strides[i] = shape.stride(i);
+		}
+	}
+
+	TensorView(T* data, const Shape& shape, const size_t* strides) : _data(data), _shape(shape), _strides() {
+		std::copy(strides, strides+shape.number(), _strides);
+	}
+
+	template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value && !std::is_same<U, T>::value>::type>
+	TensorView(const TensorView<U>& that) : TensorView(that.data(), that.shape(), that.strides()) {
+
+	}
+
+	template<typename... Index>
+	T& at(Index... index) const {
+		ASSERT_DEBUG(sizeof...(Index) == _shape.number());
+		const size_t indexes[] = {static_cast<size_t>(index)...};
+		size_t offset = 0;
+		for(size_t i=0; i<sizeof...(Index); i++) {
+			ASSERT_DEBUG(indexes[i] < _shape.dim(i));
+			offset += indexes[i]*_strides[i];
+		}
+		return _data[offset];
+	}
+
+	T* data() const {
+		return _data;
+	}
+
+	const Shape& shape() const {
+		return _shape;
+	}
+
+	size_t stride(size_t i) const {
+		ASSERT_DEBUG(i < _shape.number());
+		return _strides[i];
+	}
+
+	const size_t* strides() const {
+		return _strides;
+	}
+
+	/**
+	 * @brief Fixes the index of one dimension and removes it, e.g. slice(3, k) is the frame k of a (height, width, depth, conv_depth) tensor.
+	 */
+	TensorView slice(size_t axis, size_t index) const {
+		if(axis >= _shape.number() || index >= _shape.dim(axis)) {
+			throw std::runtime_error("slice: index out of range");
+		}
+
+		size_t dims[Shape::MaxRank];
+		size_t strides[Shape::MaxRank];
+		size_t n = 0;
+		for(size_t i=0; i<_shape.number(); i++) {
+			if(i != axis) {
+				dims[n] = _shape.dim(i);
+				strides[n] = _strides[i];
+				n++;
+			}
+		}
+		return TensorView(_data+index*_strides[axis], Shape(dims, n), strides);
+	}
+
+	/**
+	 * @brief Restricts one dimension to the range [start, start+length), the rank is kept.
+	 */
+	TensorView narrow(size_t axis, size_t start, size_t length) const {
+		if(axis >= _shape.number() || start+length > _shape.dim(axis)) {
+			throw std::runtime_error("narrow: range out of bounds");
+		}
+
+		size_t dims[Shape::MaxRank];
+		for(size_t i=0; i<_shape.number(); i++) {
+			dims[i] = i == axis ? length : _shape.dim(i);
+		}
+		return TensorView(_data+start*_strides[axis], Shape(dims, _shape.number()), _strides);
+	}
+
+	/**
+	 * @brief Copies the values of a view of the same shape into this one.
+	 * The dimensions that are contiguous in both views are merged, so the inner loop copies the longest possible runs.
+	 */
+	template<typename U>
+	void assign(const TensorView<U>& src) const {
+		if(src.shape() != _shape) {
+			throw std::runtime_error("assign: incompatible shapes "+src.shape().to_string()+" and "+_shape.to_string());
+		}
+
+		if(_shape.product() == 0) {
+			return;
+		}
+
+		size_t dims[Shape::MaxRank];
+		size_t dst_strides[Shape::MaxRank];
+		size_t src_strides[Shape::MaxRank];
+		size_t number = 0;
+		for(size_t i=0; i<_shape.number(); i++) {
+			size_t n = _shape.dim(i);
+			if(n == 1) {
+				continue;
+			}
+			if(number > 0 && dst_strides[number-1] == _strides[i]*n && src_strides[number-1] == src.stride(i)*n) {
+				dims[number-1] *= n;
+				dst_strides[number-1] = _strides[i];
+				src_strides[number-1] = src.stride(i);
+			}
+			else {
+				dims[number] = n;
+				dst_strides[number] = _strides[i];
+				src_strides[number] = src.stride(i);
+				number++;
+			}
+		}
+
+		if(number == 0) {
+			*_data = *src.data();
+			return;
+		}
+		_assign(0, number, dims, dst_strides, src_strides, _data, src.data());
+	}
+
+private:
+	template<typename U>
+	static void _assign(size_t axis, size_t number, const size_t* dims, const size_t* dst_strides, const size_t* src_strides, T* dst, U* src) {
+		size_t n = dims[axis];
+		size_t dst_stride = dst_strides[axis];
+		size_t src_stride = src_strides[axis];
+
+		if(axis+1 == number) {
+			if(dst_stride == 1 && src_stride == 1) {
+				std::copy(src, src+n, dst);
+			}
+			else {
+				for(size_t i=0; i<n; i++) {
+					dst[i*dst_stride] = src[i*src_stride];
+				}
+			}
+			return;
+		}
+
+		for(size_t i=0; i<n; i++) {
+			_assign(axis+1, number, dims, dst_strides, src_strides, dst+i*dst_stride, src+i*src_stride);
+		}
 	}
 
-	template<size_t Index>
-	size_t _to_index() const {
-		return 0;
+	T* _data;
+	Shape _shape;
+	size_t _strides[Shape::MaxRank];
+};
+
+/**
+ * @brief Fixed-rank accessor on the storage of a tensor, for inner loops. The strides are read from the shape once when the
+ * accessor is created and the index computation is unrolled at compile time, with a unit stride on the last dimension.
+ * Like TensorView, it doesn't own the storage and must not be used after the tensor is destroyed or resized.
+ */
+template<typename T, size_t Rank>
+class TensorAccessor {
+
+	static_assert(Rank > 0 && Rank <= Shape::MaxRank, "TensorAccessor: unsupported rank");
+
+public:
+	TensorAccessor(T* data, const Shape& shape) : _data(data), _strides() {
+		if(shape.number() != Rank) {
+			throw std::runtime_error("TensorAccessor: rank "+std::to_string(Rank)+" expected, got shape "+shape.to_string());
+		}
+		for(size_t i=0; i<Rank; i++) {
+			_strides[i] = shape.stride(i);
+		}
+	}
+
+	template<typename... Index>
+	T& operator()(Index... index) const {
+		static_assert(sizeof...(Index) == Rank, "TensorAccessor: one index per dimension is expected");
+		const size_t indexes[] = {static_cast<size_t>(index)...};
+		return _data[_offset(std::make_index_sequence<Rank-1>(), indexes)+indexes[Rank-1]];
+	}
+
+	T* data() const {
+		return _data;
 	}
 
-	std::vector<size_t> _dims;
-	std::vector<size_t> _product;
+private:
+	template<size_t... I>
+	size_t _offset(std::index_sequence<I...>, const size_t* indexes) const {
+		return (static_cast<size_t>(0) + ... + (_strides[I]*indexes[I]));
+	}
 
+	T* _data;
+	size_t _strides[Rank];
 };
 
 template<typename T>
@@ -137,41 +454,50 @@ class Tensor {
 public:
     typedef T Type;
 
-	Tensor() : _shape(), _data(nullptr) {
+	static_assert(std::is_trivial<T>::value, "Tensor storage is not constructed, T must be a trivial type");
 
-	}
+	Tensor() : _shape(), _data(nullptr), _capacity(0) {
 
-	Tensor(const Shape& shape) : _shape(shape), _data(new T[_shape.product()]) {
+	}
 
+	Tensor(const Shape& shape) : _shape(shape), _data(nullptr), _capacity(0) {
+		_allocate(_shape.product());
 	}
 
-	Tensor(const Tensor& that) noexcept : _shape(that._shape), _data(new T[_shape.product()]) {
+	Tensor(const Tensor& that) noexcept : _shape(that._shape), _data(nullptr), _capacity(0) {
+		_allocate(_shape.product());
 		std::copy(that._data, that._data+_shape.product(), _data);
 	}
 
-	Tensor(Tensor&& that) noexcept : _shape(std::move(that._shape)), _data(that._data) {
+	Tensor(Tensor&& that) noexcept : _shape(std::move(that._shape)), _data(that._data), _capacity(that._capacity) {
 		that._data = nullptr;
+		that._capacity = 0;
 	}
 
 	~Tensor() {
-		delete[] _data;
+		TensorMemory::deallocate(_data, _capacity);
 	}
 
 	Tensor& operator=(const Tensor& that) noexcept {
-		if(_shape.product() != that.shape().product()) {
-			delete[] _data;
-			_data = new T[that._shape.product()];
+		if(this == &that) {
+			return *this;
 		}
+		_reserve(that._shape.product());
 		_shape = that._shape;
 		std::copy(that._data, that._data+_shape.product(), _data);
 		return *this;
 	}
 
 	Tensor& operator=(Tensor&& that) noexcept {
-		delete[] _data;
+		if(this == &that) {
+			return *this;
+		}
+		TensorMemory::deallocate(_data, _capacity);
 		_shape = std::move(that._shape);
 		_data = that._data;
+		_capacity = that._capacity;
 		that._data = nullptr;
+		that._capacity = 0;
 		return *this;
 	}
 
@@ -219,6 +545,24 @@ public:
 		return _shape;
 	}
 
+	TensorView<T> view() {
+		return TensorView<T>(_data, _shape);
+	}
+
+	TensorView<const T> view() const {
+		return TensorView<const T>(_data, _shape);
+	}
+
+	template<size_t Rank>
+	TensorAccessor<T, Rank> accessor() {
+		return TensorAccessor<T, Rank>(_data, _shape);
+	}
+
+	template<size_t Rank>
+	TensorAccessor<const T, Rank> accessor() const {
+		return TensorAccessor<const T, Rank>(_data, _shape);
+	}
+
 	void reshape(const Shape& shape) {
 		if(shape.product() != _shape.product()) {
 			throw std::runtime_error("reshape: Shape must be of same length");
@@ -226,6 +570,22 @@ public:
 		_shape = shape;
 	}
 
+	void reshape(Shape&& shape) {
+		if(shape.product() != _shape.product()) {
+			throw std::runtime_error("reshape: Shape must be of same length");
+		}
+		_shape = std::move(shape);
+	}
+
+	/**
+	 * @brief Changes the shape of the tensor, the storage is reused when it is large enough. The values are left unspecified.
+	 * This is the allocation free replacement of tensor = Tensor<T>(shape).
+	 */
+	void resize(const Shape& shape) {
+		_reserve(shape.product());
+		_shape = shape;
+	}
+
 	/**
 	 * @brief check if the tensor is empty.
 	 *
@@ -455,19 +815,14 @@ public:
 	 * @param out Tensor with a single conv depth.
 	 * @param conv_depth the number at which the depth is.
 	 */
-	Tensor<float> tensor_at_conv_depth(Tensor<float> &in, size_t conv_depth)
+	Tensor<float> tensor_at_conv_depth(const Tensor<float> &in, size_t conv_depth)
 	{
 		size_t _height = in.shape().dim(0);
 		size_t _width = in.shape().dim(1);
 		size_t _depth = in.shape().dim(2);
 		Tensor<float> out(Shape({_height, _width, _depth}));
 
-		for (size_t i = 0; i < _height; i++)
-			for (size_t j = 0; j < _width; j++)
-				for (size_t k = 0; k < _depth; k++)
-				{
-					out.at(i, j, k) = in.at(i, j, k, conv_depth);
-				}
+		out.view().assign(in.view().slice(3, conv_depth));
 		return out;
 	}
 
@@ -1106,15 +1461,10 @@ public:
 		// CONV_DEPTH by being incremented every frame.
 		size_t _conv_count = 0;
 
-		for (Tensor<float> _tensor : tensors)
-		{ // add the data inside the tensor.
-			for (size_t conv = 0; conv < _tmp_depth; conv++)
-				for (size_t i = 0; i < _height; i++)
-					for (size_t j = 0; j < _width; j++)
-						for (size_t k = 0; k < _depth; k++)
-						{
-							out.at(i, j, k, _conv_count) = _tensor.at(i, j, k, conv);
-						}
+		for (const Tensor<float> &_tensor : tensors)
+		{ // add the data inside the tensor, each temporal slice overwrites the previous one so only the last is kept.
+			if (_tmp_depth > 0)
+				out.view().slice(3, _conv_count).assign(_tensor.view().slice(3, _tmp_depth - 1));
 
 			_conv_count++;
 		}
@@ -1134,15 +1484,8 @@ public:
 		// CONV_DEPTH by being incremented every frame.
 		for (size_t conv = 0; conv < _conv_depth; conv++)
 		{
-			Tensor<float> out(Shape({_height, _width, _depth, 1}));
-
-			for (size_t i = 0; i < _height; i++)
-				for (size_t j = 0; j < _width; j++)
-					for (size_t k = 0; k < _depth; k++)
-					{
-						out.at(i, j, k, 0) = in.at(i, j, k, conv);
-					}
-			out_tensors.push_back(out);
+			out_tensors.emplace_back(Shape({_height, _width, _depth, 1}));
+			out_tensors.back().view().slice(3, 0).assign(in.view().slice(3, conv));
 		}
 	}
 
@@ -1687,15 +2030,8 @@ public:
 
 		for (size_t conv = 0; conv < _conv_depth; conv++)
 		{
-			Tensor<Time> t(Shape({_height, _width, _depth, 1}));
-
-			for (size_t i = 0; i < _height; i++)
-				for (size_t j = 0; j < _width; j++)
-					for (size_t k = 0; k < _depth; k++)
-					{
-						t.at(i, j, k, 0) = in.at(i, j, k, conv);
-					}
-			out.push_back(t);
+			out.emplace_back(Shape({_height, _width, _depth, 1}));
+			out.back().view().slice(3, 0).assign(in.view().slice(3, conv));
 		}
 	}
 
@@ -1710,12 +2046,7 @@ public:
 		size_t _conv_depth = in.size();
 
 		for (size_t conv = 0; conv < _conv_depth; conv++)
-			for (size_t i = 0; i < _height; i++)
-				for (size_t j = 0; j < _width; j++)
-					for (size_t k = 0; k < _depth; k++)
-					{
-						out.at(i, j, k, conv) = in[conv].at(i, j, k, 0);
-					}
+			out.view().narrow(0, 0, _height).narrow(1, 0, _width).narrow(2, 0, _depth).slice(3, conv).assign(in[conv].view().slice(3, 0));
 	}
 
 	/**
@@ -1728,16 +2059,7 @@ public:
 		size_t _depth = in[0].shape().dim(2);
 
 		for (size_t conv = 0; conv < in.size(); conv++)
-		{
-			Tensor<Time> t = in[conv];
-
-			for (size_t i = 0; i < _height; i++)
-				for (size_t j = 0; j < _width; j++)
-					for (size_t k = 0; k < _depth; k++)
-					{
-						out.at(i, j, k, conv) = t.at(i, j, k, 0);
-					}
-		}
+			out.view().narrow(0, 0, _height).narrow(1, 0, _width).narrow(2, 0, _depth).slice(3, conv).assign(in[conv].view().slice(3, 0));
 	}
 
 	/**
@@ -1858,11 +2180,7 @@ public:
 
 		Shape new_shape(dims);
 
-		if(new_shape.product() != _shape.product()) {
-			delete[] _data;
-			_data = new T[new_shape.product()];
-		}
-
+		_reserve(new_shape.product());
 		_shape = std::move(new_shape);
 
 		size_t size = _shape.product();
@@ -1889,8 +2207,22 @@ public:
 	}
 
 private:
+	void _allocate(size_t size) {
+		_data = static_cast<T*>(TensorMemory::allocate(size*sizeof(T), _capacity));
+	}
+
+	void _reserve(size_t size) {
+		if(size*sizeof(T) > _capacity) {
+			TensorMemory::deallocate(_data, _capacity);
+			_data = nullptr;
+			_capacity = 0;
+			_allocate(size);
+		}
+	}
+
 	Shape _shape;
 	T* _data;
+	size_t _capacity; // in bytes
 	std::map<std::string, std::string> m_metadata;
 
 public:
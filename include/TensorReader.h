@@ -3,14 +3,22 @@
 
 #include <fstream>
 #include <iostream>
+#include <deque>
+#include <future>
+#include <vector>
 
 #include "Input.h"
 
+/**
+ * @brief Reads the files of TensorWriter (see TensorFileFormat).
+ * A v2 file can be read from any tensor with seek(). The next thread_number blocks are read ahead and, with more than one thread,
+ * decoded in parallel while the current block is consumed.
+ */
 class TensorReader : public Input {
 
 public:
 	TensorReader();
-	TensorReader(const std::string& filename);
+	TensorReader(const std::string& filename, size_t thread_number = 1);
 	~TensorReader();
 
 	TensorReader(TensorReader&& that) noexcept;
@@ -25,12 +33,28 @@ public:
 	void close();
 	void reset();
 
+	size_t size() const;
+	void seek(size_t index);
+	void set_thread_number(size_t thread_number);
+
 	virtual std::string to_string() const;
 
 	virtual const Shape& shape() const;
 
 private:
 	void _read_header();
+	void _read_index();
+
+	std::pair<std::string, Tensor<InputType>> _next_v1();
+	std::pair<std::string, Tensor<InputType>> _next_v2();
+	void _skip_v2();
+
+	void _load_block(size_t block);
+	void _schedule();
+	static std::vector<char> _decode(std::string stored, uint32_t raw_size);
+
+	template<typename T>
+	T _take();
 
 	std::string _name;
 	std::ifstream _file;
@@ -38,6 +62,17 @@ private:
 	size_t _cursor;
 	bool _sparse;
 
+	uint32_t _version;
+	std::vector<uint64_t> _block_offsets;
+	std::vector<uint64_t> _block_firsts;
+	std::vector<char> _block;
+	size_t _block_index;
+	size_t _block_cursor;
+
+	std::deque<std::future<std::vector<char>>> _ahead;
+	size_t _ahead_next;
+	size_t _thread_number;
+
 };
 
 #endif
@@ -2,25 +2,61 @@
 #define _TENSOR_WRITER_H
 
 #include <fstream>
+#include <vector>
 
 #include "Tensor.h"
 
+/**
+ * @brief Layouts of the tensor files.
+ *
+ * TENSOR_FILE_V1 is a sequential stream: header, then each tensor (uint8 label length, label, uint8 dimension number, uint16 dims, data).
+ *
+ * TENSOR_FILE_V2 groups the tensors in blocks of about block_size bytes, each block optionally compressed with tool::Lz, and ends with
+ * an index of the blocks, so that a reader can seek to any tensor and decode several blocks at once:
+ * - header: uint32 magic, uint8 flags (0x1 sparse, 0x2 compressed)
+ * - blocks: uint32 raw size, uint32 stored size (equal to the raw size when the block is stored uncompressed), payload.
+ *   A tensor is: uint32 label length, label, uint8 dimension number, uint32 dims, then the dense floats, or for a sparse file
+ *   uint32 count, count uint32 indexes and count floats.
+ * - index: for each block, uint64 file offset and uint64 index of its first tensor
+ * - footer: uint64 index offset, uint64 tensor number, uint64 block number, uint32 magic
+ */
+enum TensorFileFormat {
+	TENSOR_FILE_V1,
+	TENSOR_FILE_V2
+};
+
 class TensorWriter {
 
 public:
+	static constexpr size_t DefaultBlockSize = 1 << 20;
+
 	TensorWriter();
-	TensorWriter(const std::string& filename, bool sparse = false);
+	TensorWriter(const std::string& filename, bool sparse = false, TensorFileFormat format = TENSOR_FILE_V1, bool compress = false);
 	~TensorWriter();
 
-	void open(const std::string& filename, bool sparse = false);
+	void open(const std::string& filename, bool sparse = false, TensorFileFormat format = TENSOR_FILE_V1, bool compress = false);
 	void write(const std::string& label, const Tensor<float>& t);
 	void close();
 
+	void set_block_size(size_t block_size);
+
 private:
+	void _write_v1(const std::string& label, const Tensor<float>& t);
+	void _append_v2(const std::string& label, const Tensor<float>& t);
+	void _flush_block();
+
 	std::ofstream _file;
 	size_t _tensor_counter;
 	bool _sparse;
-
+	TensorFileFormat _format;
+	bool _compress;
+	size_t _block_size;
+
+	std::string _block;
+	std::string _buffer;
+	std::vector<uint64_t> _block_offsets;
+	std::vector<uint64_t> _block_firsts;
+	size_t _block_first;
 };
 
 #endif
@@ -8,6 +8,7 @@ namespace analysis {
 	/**
  	* @brief Coherence measures the ammount of redundant features. The less the coherence, the more features leared by the SNN.
 	* The training should have  acertain incoherence with SNNs.
+	* The pairwise similarities come from one Gram matrix product, so the analysis is cheap enough to run after every epoch.
  	*/
 	class Coherence : public NoPassAnalysis {
 
@@ -17,6 +18,9 @@ namespace analysis {
 		virtual void resize(const Shape& shape);
 
 		virtual void process();
+
+	private:
+		void _coherence(const Tensor<float>& w, std::vector<float>& list);
 	};
 
 }
@@ -5,20 +5,36 @@
 #include "dep/libsvm/svm.h"
 #include <filesystem>
 #include "tool/Operations.h"
+#include "tool/LinearSvm.h"
 
 	/**
  	* @brief SVM (support vector machine), this CSNN simulator uses STDP unsupervised learning, 
 	* so a classification layer is needed to evaluate the accuracy of the network.
 	* Any other supervised learning method can be used, but the SVM was chosen for it's simplicity and efficacity.
     * @param draw A flag that draws the features that will be classified by the SVM, the information is recorded in the folder in the build file.
+    * @param solver SolverLibsvm trains a C-SVC with a linear kernel through libsvm (one-vs-one),
+    * SolverLinear uses the dual coordinate descent solver of tool::LinearSvm (one-vs-rest), which is much faster on large feature sets.
+    * @param c_path When not empty, the C values are evaluated on the same feature set, in increasing order, each linear solve
+    * starting from the solution of the previous one. The model of the best C is kept for the test.
+    * @param fold_number With 2 or more folds, the C values are ranked by k-fold cross-validation on the training set (folds trained in parallel),
+    * otherwise on a validation fold of 1/5 of the training set. The test set is never used to choose C, the test rate of each C is only logged.
  	*/
 
 namespace analysis {
 	class Svm : public TwoPassAnalysis {
 
 	public:
+		static constexpr size_t HoldoutFoldNumber = 5;
+
+		enum Solver : uint32_t
+		{
+			SolverLibsvm = 0,
+			SolverLinear = 1
+		};
+
 		Svm();
-		Svm(const size_t &draw);
+		Svm(const size_t &draw, uint32_t solver = SolverLibsvm);
+		Svm(const std::vector<float>& c_path, size_t fold_number = 0, const size_t &draw = 0);
 
 		Svm(const Svm& that) = delete;
 		Svm& operator=(const Svm& that) = delete;
@@ -28,13 +44,32 @@ namespace analysis {
 		virtual void process_train(const std::string& label, const Tensor<float>& sample);
 		virtual void process_test(const std::string& label, const Tensor<float>& sample);
 
+		virtual void process_train_sparse_sample(const std::string& label, const SparseTensor<float>& sample, size_t current_pass);
+		virtual void process_test_sparse_sample(const std::string& label, const SparseTensor<float>& sample);
+
 		virtual void before_train();
 		virtual void after_train();
 		virtual void before_test();
 		virtual void after_test();
 
+		/**
+		 * @brief Fraction of the test samples classified correctly by the last test, in [0, 1].
+		 */
+		float classification_rate() const;
+
 	private:
+		void _register_sample(const std::string& label);
+		void _draw_sample(const std::string& label, const Tensor<float>& sample);
+		void _add_train_value(uint32_t index, float value);
+		void _end_train_sample(const std::string& label);
+		size_t _test_label(const std::string& label) const;
+		void _predict(std::vector<size_t>& predictions) const;
+		void _search_c();
+		void _cross_validate(size_t fold_number, size_t evaluated_fold_number, std::vector<size_t>& correct_samples, size_t& validation_sample_number) const;
+		size_t _count_correct(const std::vector<size_t>& predictions) const;
+
 		float _c;
+		uint32_t _solver;
 
 		std::map<std::string, double> _label_index;
 		size_t _size;
@@ -45,8 +80,18 @@ namespace analysis {
 
 		svm_problem _problem;
 		svm_model* _model;
-		svm_node* _train_nodes;
-		svm_node* _test_nodes;
+		std::vector<svm_node> _train_nodes;
+		std::vector<size_t> _train_offsets;
+		std::vector<double> _train_labels;
+		std::vector<svm_node*> _train_samples;
+
+		tool::LinearSvm _linear;
+		tool::LinearSvm::Problem _train_problem;
+		tool::LinearSvm::Problem _test_problem;
+
+		std::vector<float> _c_path;
+		size_t _fold_number;
+		std::vector<tool::LinearSvm> _path_models;
 
 		size_t _correct_sample;
 		size_t _total_sample;
@@ -5,14 +5,17 @@
 #include <cassert>
 #include <fstream>
 #include <limits>
+#include <memory>
 
 #include "Tensor.h"
 #include "Input.h"
+#include "NumpyMapping.h"
 
 
 namespace dataset {
 
 	// Generic data loader for spikes 
+	// The .npy files are memory mapped: the run starts without reading them and the samples are copied in blocks from the mapping
 	//
 	class Spikes : public Input {
 
@@ -35,20 +38,17 @@ namespace dataset {
 		std::string _spikes_filename;
 		std::string _label_filename;
 
-		std::ifstream _spikes_file;
-		std::ifstream _label_file;
+		std::unique_ptr<NumpyMapping> _spikes;
+		std::unique_ptr<NumpyMapping> _labels;
 
+		std::string _name;
 
-		Shape _shape;
-		unsigned long _size;
-		unsigned long _idx,_idx_local;
+		unsigned int _width, _height, _depth;
 
-		std::vector<float> _data;
-		std::vector<int> _label;
-	
-		unsigned int _width, _height, _depth;	
+		unsigned long _idx,_idx_local;
 
-		std::string _name;
+		Shape _shape;
+		unsigned long _size;
 	};
 
 }
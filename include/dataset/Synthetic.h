@@ -0,0 +1,130 @@
+#ifndef _DATASET_SYNTHETIC_H
+#define _DATASET_SYNTHETIC_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Tensor.h"
+#include "Input.h"
+
+namespace dataset {
+
+	/**
+	 * @brief Seeded synthetic images, to run an experiment without any dataset file. As dataset::Image, the samples have a temporal
+	 * depth of 1 (width x height x depth x 1), the input shape of Convolution3D.
+	 * Each class has a random template; a sample is the template of its class with a fraction of its pixels redrawn.
+	 * The samples cycle through the classes (sample i has the label i % class_number).
+	 *
+	 * The templates only depend on class_seed and sample i only on (sample_seed, i): reset() replays the same samples,
+	 * and a train and a test set share their classes when they only differ by their sample_seed.
+	 *
+	 * @param sparsity Fraction of the pixels that are 0, the others are in [0.5, 1].
+	 * @param noise Fraction of the pixels of the template that are redrawn in each sample.
+	 */
+	class SyntheticImage : public Input {
+
+	public:
+		SyntheticImage(size_t width, size_t height, size_t depth, size_t class_number, size_t sample_number,
+					   float sparsity = 0.8f, uint32_t sample_seed = 0, uint32_t class_seed = 0, float noise = 0.1f);
+
+		virtual bool has_next() const;
+		virtual std::pair<std::string, Tensor<InputType>> next();
+		virtual void reset();
+		virtual void close();
+
+		size_t size() const;
+		virtual std::string to_string() const;
+
+		virtual const Shape& shape() const;
+
+	private:
+		Shape _shape;
+		size_t _class_number;
+		size_t _sample_number;
+		float _sparsity;
+		uint32_t _sample_seed;
+		uint32_t _class_seed;
+		float _noise;
+
+		size_t _cursor;
+		std::vector<Tensor<InputType>> _templates;
+	};
+
+	/**
+	 * @brief Seeded synthetic video clips of blob_number bright discs moving over a black background, of shape
+	 * width x height x depth x frame_number (the input shape of Convolution3D).
+	 * The class is the direction of the motion: the blobs of class c move by one pixel per frame at the angle 2*pi*c/class_number,
+	 * wrapping around the borders. The start positions and the intensities are drawn for each sample.
+	 *
+	 * @param sparsity Fraction of the pixels of a frame outside of the blobs, it sets the radius of the blobs.
+	 */
+	class SyntheticVideo : public Input {
+
+	public:
+		SyntheticVideo(size_t width, size_t height, size_t depth, size_t frame_number, size_t class_number, size_t sample_number,
+					   float sparsity = 0.9f, uint32_t sample_seed = 0, size_t blob_number = 3);
+
+		virtual bool has_next() const;
+		virtual std::pair<std::string, Tensor<InputType>> next();
+		virtual void reset();
+		virtual void close();
+
+		size_t size() const;
+		virtual std::string to_string() const;
+
+		virtual const Shape& shape() const;
+
+	private:
+		Shape _shape;
+		size_t _class_number;
+		size_t _sample_number;
+		float _sparsity;
+		uint32_t _sample_seed;
+		size_t _blob_number;
+		float _radius;
+
+		size_t _cursor;
+	};
+
+	/**
+	 * @brief Seeded pre-encoded spike tensors of shape width x height x depth x 1 (spike times in [0, 1), INFINITE_TIME for the
+	 * neurons that don't fire), to feed the layers directly, without input converter.
+	 * Each class has a template of firing neurons and timestamps; in a sample, a fraction noise of the neurons is redrawn and the
+	 * others keep the spike of the template, shifted by a gaussian jitter. Seeds and labels work as in SyntheticImage.
+	 *
+	 * @param sparsity Fraction of the neurons that don't fire.
+	 */
+	class SyntheticSpikes : public Input {
+
+	public:
+		SyntheticSpikes(size_t width, size_t height, size_t depth, size_t class_number, size_t sample_number,
+						float sparsity = 0.9f, uint32_t sample_seed = 0, uint32_t class_seed = 0, float noise = 0.1f, float jitter = 0.05f);
+
+		virtual bool has_next() const;
+		virtual std::pair<std::string, Tensor<InputType>> next();
+		virtual void reset();
+		virtual void close();
+
+		size_t size() const;
+		virtual std::string to_string() const;
+
+		virtual const Shape& shape() const;
+
+	private:
+		Shape _shape;
+		size_t _class_number;
+		size_t _sample_number;
+		float _sparsity;
+		uint32_t _sample_seed;
+		uint32_t _class_seed;
+		float _noise;
+		float _jitter;
+
+		size_t _cursor;
+		std::vector<Tensor<InputType>> _templates;
+	};
+
+}
+
+#endif
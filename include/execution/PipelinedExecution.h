@@ -0,0 +1,66 @@
+#ifndef _EXECUTION_PIPELINED_EXECUTION_H
+#define _EXECUTION_PIPELINED_EXECUTION_H
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include "Experiment.h"
+#include "SpikeConverter.h"
+#include "tool/BoundedQueue.h"
+
+/**
+ * @brief Test-only execution policy for trained networks (like TestingExecution), where the samples stream through the processes
+ * instead of each process going over the whole test set: every process runs on its own thread and hands its output samples
+ * to the next one through a bounded queue, so sample n can be in conv2 while sample n+1 is in conv1. Each output gets a
+ * thread too, which converts the samples, runs the postprocessing and feeds the analysis.
+ *
+ * Only queue_capacity samples wait between two stages, instead of the whole dataset, and the throughput grows with the number
+ * of stages, up to the number of cores (it is bounded by the slowest stage). A process keeps a single thread, so it sees the
+ * samples in order and its state (inhibition, counters) is the same as with TestingExecution.
+ *
+ * The size of the test set is not known while it streams: process_test_sample gets number = 0, except for the last sample
+ * which gets its exact count, so that the end of set of the layers is still detected.
+ *
+ * @param experiment The experiment that owns the policy
+ * @param queue_capacity size_t - Number of samples that can wait between two stages
+ */
+class PipelinedExecution {
+
+public:
+	typedef Experiment<PipelinedExecution> ExperimentType;
+
+	PipelinedExecution(ExperimentType& experiment, size_t queue_capacity = 4);
+
+	void process(size_t refresh_interval);
+
+	Tensor<Time> compute_time_at(size_t i) const;
+
+private:
+	struct Sample {
+		std::string label = std::string();
+		Tensor<float> value = Tensor<float>();
+		size_t index = 0;
+		bool last = false;
+	};
+
+	typedef tool::BoundedQueue<Sample> Queue;
+
+	void _load_params(AbstractProcess& process);
+
+	void _read_inputs(Queue& out);
+	void _run_process(AbstractProcess& process, Queue& in, const std::vector<Queue*>& out);
+	void _run_output(Output& output, Queue& in);
+
+	void _fail(std::exception_ptr error);
+	bool _failed();
+
+	ExperimentType& _experiment;
+	size_t _queue_capacity;
+
+	std::vector<std::unique_ptr<Queue>> _queues;
+	std::mutex _log_mutex;
+	std::mutex _error_mutex;
+	std::exception_ptr _error;
+};
+
+#endif
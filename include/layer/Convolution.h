@@ -7,6 +7,8 @@
 #include <fstream>
 #include <iostream>
 #include "tool/Operations.h"
+#include "tool/WeightLogger.h"
+#include "tool/Quantization.h"
 #include "plot/Threshold.h"
 #include "plot/Evolution.h"
 // #include <execution>
@@ -63,6 +65,101 @@ namespace layer
 			Tensor<bool> _wta;
 		};
 #endif
+
+		/**
+		 * @brief Dense inference engine of Convolution, used by test() when dense_bins > 0. The input times are quantized into
+		 * dense_bins bins of [0, 1); for each bin, the im2col matrix of the inputs firing in the bin is multiplied by the weights
+		 * and accumulated into the potentials. The matrix is packed: each row (output position) only holds its synapses firing
+		 * in the bin, so the product adds their contiguous weight rows, over all the filters at once. Only the positions where
+		 * a neuron crosses its threshold during the bin replay its spikes of the bin, in input order, to resolve the firing
+		 * times and the inhibitions.
+		 *
+		 * With non-negative weights, the output spikes are the ones of the event-driven engine (up to the rounding of the sums):
+		 * a potential can then only cross its threshold in the bin where it ends above it.
+		 * The work is the one of the event-driven engine, done as vector adds instead of one neuron at a time, so this engine
+		 * pays off on dense inputs and wide layers.
+		 */
+		class ConvolutionDenseImpl
+		{
+
+		public:
+			ConvolutionDenseImpl(Convolution &model);
+
+			void resize();
+			void test(const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike);
+
+		private:
+			Convolution &_model;
+			std::vector<uint32_t> _inputs;
+			std::vector<uint32_t> _entries;
+			std::vector<uint32_t> _bin_offset;
+			std::vector<uint16_t> _bin;
+			std::vector<uint32_t> _rank;
+			std::vector<std::pair<uint32_t, uint32_t>> _order;
+			std::vector<size_t> _crossing;
+			std::vector<uint32_t> _trigger;
+			std::vector<float> _previous;
+			Tensor<float> _a;
+			std::vector<uint8_t> _fired;
+			std::vector<uint8_t> _won;
+		};
+
+		/**
+		 * @brief Integer inference engine of Convolution, used by test() when quantized_infer is set: uint8 weights, int16 (or
+		 * int32) potentials and SIMD threshold comparisons (see tool::QuantizedWeights). The spikes are integrated in the order of
+		 * the event-driven engine, so the outputs only differ by the rounding of the weights and thresholds.
+		 *
+		 * The weights are quantized on the first test sample after a change (training, load_params). The first
+		 * quantization_calibration samples after a quantization also run the float engine, and the differences of their
+		 * output spikes are reported (see tool::QuantizationReport).
+		 */
+		class ConvolutionQuantizedImpl
+		{
+
+		public:
+			ConvolutionQuantizedImpl(Convolution &model);
+
+			void resize();
+			void invalidate();
+			void test(const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike);
+
+			const tool::QuantizationReport &report() const;
+
+		private:
+			template<typename Potential>
+			void _test(const std::vector<Spike> &input_spike, std::vector<Spike> &output_spike, std::vector<Potential> &a);
+
+			Convolution &_model;
+			tool::QuantizedWeights _weights;
+			tool::QuantizationReport _report;
+			std::vector<int16_t> _a16;
+			std::vector<int32_t> _a32;
+			std::vector<uint8_t> _won;
+			std::vector<Spike> _reference;
+		};
+
+		/**
+		 * @brief Bit-packed binary inference engine of Convolution, used by test() when binary_infer is set: the weights are
+		 * binarized at binary_cut and each input spike adds a bitset across the filters to bit-sliced counters (see
+		 * tool::BinaryWeights). Meant for trained layers whose weights saturated at 0 or 1.
+		 * The weights are binarized on the first test sample after a change (training, load_params).
+		 */
+		class ConvolutionBinaryImpl
+		{
+
+		public:
+			ConvolutionBinaryImpl(Convolution &model);
+
+			void resize();
+			void invalidate();
+			void test(const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike);
+
+		private:
+			Convolution &_model;
+			tool::BinaryWeights _weights;
+			std::vector<uint64_t> _counters;
+			std::vector<uint8_t> _won;
+		};
 	}
 
 	/**
@@ -77,11 +174,20 @@ namespace layer
 	 * @param stride_y size_t - The step of the convolutional filter in the y diresction
 	 * @param padding_x size_t - added padding to the filter in the x direction
 	 * @param padding_y size_t - added padding to the filter in the y direction
+	 *
+	 * The parameter dense_bins (0 by default) selects the inference engine: 0 for the event-driven one, T > 0 for the
+	 * time-binned sparse-dense product engine with T bins (see _priv::ConvolutionDenseImpl). quantized_infer (false by default) selects the
+	 * integer engine (see _priv::ConvolutionQuantizedImpl), quantization_calibration sets its number of calibration samples.
+	 * binary_infer (false by default) selects the binary engine (see _priv::ConvolutionBinaryImpl), with the weights binarized
+	 * at binary_cut (0.5 by default).
 	 */
 	class Convolution : public Layer3D
 	{
 
 		friend class _priv::ConvolutionImpl;
+		friend class _priv::ConvolutionDenseImpl;
+		friend class _priv::ConvolutionQuantizedImpl;
+		friend class _priv::ConvolutionBinaryImpl;
 
 	public:
 		Convolution();
@@ -106,6 +212,9 @@ namespace layer
 
 		virtual bool load_params(const std::string& filename);
 		virtual bool save_params(const std::string& filename);
+
+		const tool::QuantizationReport &quantization_report() const;
+
 	private:
 		uint32_t _epoch_number;
 
@@ -115,6 +224,8 @@ namespace layer
 		uint32_t _sample_number;
 		uint32_t _sample_count;
 		uint32_t _drawn_weights;
+		uint32_t _saved_weights;
+		uint32_t _snapshot_interval; // with save_weights, a snapshot every n weight updates of the last epoch, 0 for only the first one
 		std::string _file_path;
 
 		float _annealing;
@@ -134,8 +245,23 @@ namespace layer
 		size_t _input_conv_depth;
 
 		bool _wta_infer;
+		uint32_t _dense_bins;
+		bool _quantized_infer;
+		uint32_t _quantization_calibration;
+		bool _binary_infer;
+		float _binary_cut;
+
+		Tensor<Time> _input_time;
+		std::vector<Spike> _input_spike;
+		std::vector<Spike> _output_spike;
+
+		// writes the weight snapshots and the neuron events in the background
+		tool::WeightLogger _weight_logger;
 
 		_priv::ConvolutionImpl _impl;
+		_priv::ConvolutionDenseImpl _dense;
+		_priv::ConvolutionQuantizedImpl _quantized;
+		_priv::ConvolutionBinaryImpl _binary;
 	};
 }
 #endif
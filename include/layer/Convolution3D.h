@@ -8,6 +8,8 @@
 #include <fstream>
 #include <iostream>
 #include "tool/Operations.h"
+#include "tool/WeightLogger.h"
+#include "tool/Quantization.h"
 #include "plot/Threshold.h"
 #include "plot/Evolution.h"
 #include <thread> // std::this_thread::sleep_for
@@ -66,6 +68,61 @@ namespace layer
 			uint32_t epoch_number;
 		};
 #endif
+
+		/**
+		 * @brief Integer inference engine of Convolution3D, used by test() when quantized_infer is set: uint8 weights, int16 (or
+		 * int32) potentials and SIMD threshold comparisons (see tool::QuantizedWeights). The weights are repacked with the filters
+		 * innermost, and the potentials of an output position (x, y, k) are contiguous.
+		 *
+		 * The weights are quantized on the first test sample after a training sample. The first quantization_calibration samples
+		 * after a quantization also run the float engine, and the differences of their output spikes are reported
+		 * (see tool::QuantizationReport).
+		 */
+		class Convolution3DQuantizedImpl
+		{
+
+		public:
+			Convolution3DQuantizedImpl(Convolution3D &model);
+
+			void resize();
+			void invalidate();
+			void test(const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike);
+
+			const tool::QuantizationReport &report() const;
+
+		private:
+			template <typename Potential>
+			void _test(const std::vector<Spike> &input_spike, std::vector<Spike> &output_spike, std::vector<Potential> &a);
+
+			Convolution3D &_model;
+			tool::QuantizedWeights _weights;
+			tool::QuantizationReport _report;
+			std::vector<int16_t> _a16;
+			std::vector<int32_t> _a32;
+			std::vector<Spike> _reference;
+		};
+
+		/**
+		 * @brief Bit-packed binary inference engine of Convolution3D, used by test() when binary_infer is set: the weights are
+		 * binarized at binary_cut and each input spike adds a bitset across the filters to bit-sliced counters (see
+		 * tool::BinaryWeights). Meant for trained layers whose weights saturated at 0 or 1.
+		 * The weights are binarized on the first test sample after a training sample.
+		 */
+		class Convolution3DBinaryImpl
+		{
+
+		public:
+			Convolution3DBinaryImpl(Convolution3D &model);
+
+			void resize();
+			void invalidate();
+			void test(const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike);
+
+		private:
+			Convolution3D &_model;
+			tool::BinaryWeights _weights;
+			std::vector<uint64_t> _counters;
+		};
 	} // namespace _priv
 
 	/**
@@ -84,11 +141,17 @@ namespace layer
 	 * @param padding_x added padding to the filter in the x direction
 	 * @param padding_y added padding to the filter in the y direction
 	 * @param padding_k added padding to the filter in the z direction
+	 *
+	 * The parameter quantized_infer (false by default) selects the integer inference engine (see _priv::Convolution3DQuantizedImpl),
+	 * quantization_calibration sets its number of calibration samples. binary_infer (false by default) selects the binary engine
+	 * (see _priv::Convolution3DBinaryImpl), with the weights binarized at binary_cut (0.5 by default).
 	 */
 	class Convolution3D : public Layer4D
 	{
 
 		friend class _priv::Convolution3DImpl;
+		friend class _priv::Convolution3DQuantizedImpl;
+		friend class _priv::Convolution3DBinaryImpl;
 
 	public:
 		/**
@@ -123,6 +186,8 @@ namespace layer
 		void plot_threshold(bool only_in_train);
 		void plot_evolution(bool only_in_train);
 
+		const tool::QuantizationReport &quantization_report() const;
+
 	private:
 		uint32_t _epoch_number;
 		uint32_t _current_epoch_number;
@@ -134,6 +199,7 @@ namespace layer
 		uint32_t _sample_count;
 		uint32_t _drawn_weights;
 		uint32_t _saved_weights;
+		uint32_t _snapshot_interval; // with save_weights, a snapshot every n weight updates of the last epoch, 0 for only the first one
 		uint32_t _saved_random_start;
 		uint32_t _logged_spiking_neuron;
 		std::string _file_path;
@@ -165,8 +231,23 @@ namespace layer
 		size_t _input_conv_depth;
 
 		bool _wta_infer;
+		// integer inference (uint8 weights), and its number of calibration samples against the float inference
+		bool _quantized_infer;
+		uint32_t _quantization_calibration;
+		// bit-packed inference with binarized weights, and the weight value from which a weight is 1
+		bool _binary_infer;
+		float _binary_cut;
+
+		Tensor<Time> _input_time;
+		std::vector<Spike> _input_spike;
+		std::vector<Spike> _output_spike;
+
+		// writes the weight snapshots and the neuron events in the background
+		tool::WeightLogger _weight_logger;
 
 		_priv::Convolution3DImpl _impl;
+		_priv::Convolution3DQuantizedImpl _quantized;
+		_priv::Convolution3DBinaryImpl _binary;
 	};
 
 } // namespace layer
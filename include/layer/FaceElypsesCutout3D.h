@@ -8,6 +8,7 @@
 #include <fstream>
 #include <iostream>
 #include "tool/Operations.h"
+#include "tool/WeightLogger.h"
 #include "plot/Threshold.h"
 #include "plot/Evolution.h"
 #include <thread> // std::this_thread::sleep_for
@@ -135,6 +136,7 @@ namespace layer
 		uint32_t _sample_count;
 		uint32_t _drawn_weights;
 		uint32_t _saved_weights;
+		uint32_t _snapshot_interval; // with save_weights, a snapshot every n weight updates of the last epoch, 0 for only the first one
 		uint32_t _saved_random_start;
 		uint32_t _logged_spiking_neuron;
 		std::string _file_path;
@@ -167,6 +169,9 @@ namespace layer
 
 		bool _wta_infer;
 
+		// writes the weight snapshots and the neuron events in the background
+		tool::WeightLogger _weight_logger;
+
 		_priv::FaceElypsesCutout3DImpl _impl;
 		
 		// Helper method for elliptical sampling
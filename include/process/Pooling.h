@@ -9,6 +9,19 @@ namespace process
 	static int _train_sample_count = 0;
 	static int _test_sample_count = 0;
 
+	namespace _priv
+	{
+		class PoolingHelper
+		{
+
+		public:
+			PoolingHelper() = delete;
+
+			static void sum_pool(const Tensor<float> &in, Tensor<float> &out, size_t filter_width, size_t filter_height, size_t filter_conv_depth);
+			static void sum_pool(Tensor<float> &sample, const Shape &output_shape, size_t filter_width, size_t filter_height, size_t filter_conv_depth);
+		};
+	}
+
 	/**
 	 * @brief A type of pooling that reduces the size of the input sample by averaging the values of the each set of pixels in the pooling filter. In both the spatial and temporal dimensions.
 	 * @param target_width The desired output width after pooling
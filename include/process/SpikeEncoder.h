@@ -0,0 +1,77 @@
+#ifndef _PROCESS_SPIKE_ENCODER_H
+#define _PROCESS_SPIKE_ENCODER_H
+
+#include <iostream>
+#include "Process.h"
+#include "Spike.h"
+
+namespace process
+{
+
+	/**
+	 * @brief Fused input encoding stage. It replaces the chain DefaultOnOffFilter -> MaxScaling/FeatureScaling -> LatencyCoding
+	 * by a single process: the on/off DoG response is computed once in a reusable buffer, then scaled and converted to
+	 * latency-coded timestamps in the same pass. The output is the Tensor<Time> the chain would produce, so it can be
+	 * used as a drop-in first stage in front of the convolution layers.
+	 * encode() goes directly from pixels to a time-ordered spike train for callers that consume spikes.
+	 *
+	 * @param filter_size size_t - The size of the on-center/off-center filter, 0 disables the filter (no channel doubling).
+	 * @param center_dev float - The variance of the Gaussian kernels DoG center.
+	 * @param surround_dev float - The variance of the Gaussian kernels DoG surround.
+	 * @param cutoff float - The minimum filter response, used to reduce noise.
+	 * @param scaling uint32_t - The scaling applied to the filter response (ScaleNone, ScaleMax or ScaleFeature).
+	 * @param scalar float - With ScaleMax, divides by this value instead of the sample maximum when > 0.
+	 * @param max_timestamp float - Latest timestamp emitted by the latency coding, 0 means no limit.
+	 */
+	class SpikeEncoder : public TwoPassProcess
+	{
+
+	public:
+		enum Scaling : uint32_t
+		{
+			ScaleNone = 0,
+			ScaleMax = 1,
+			ScaleFeature = 2
+		};
+
+		SpikeEncoder();
+		SpikeEncoder(size_t filter_size, float center_dev = 1, float surround_dev = 4, float cutoff = 0, uint32_t scaling = ScaleMax, float scalar = 0, float max_timestamp = 0);
+
+		virtual Shape compute_shape(const Shape &shape);
+		virtual size_t train_pass_number() const;
+		virtual void process_train_sample(const std::string &label, Tensor<float> &sample, size_t current_pass, size_t current_index, size_t number);
+		virtual void compute(const std::string &label, const Tensor<float> &sample);
+		virtual void process_train(const std::string &label, Tensor<float> &sample);
+		virtual void process_test(const std::string &label, Tensor<float> &sample);
+		virtual bool save_params(const std::string &path);
+		virtual bool load_params(const std::string &path);
+
+		void encode(const Tensor<float> &in, std::vector<Spike> &out);
+
+	private:
+		float _filter(const Tensor<float> &in);
+		float _divisor(float max) const;
+		Time _code(size_t i, float divisor) const;
+		void _process(Tensor<float> &sample);
+
+		size_t _filter_size;
+		float _center_dev;
+		float _surround_dev;
+		float _cutoff;
+		uint32_t _scaling;
+		float _scalar;
+		float _max_timestamp;
+
+		size_t _height;
+		size_t _width;
+		size_t _depth;
+		size_t _conv_depth;
+		size_t _size;
+		Tensor<float> _kernel;
+		Tensor<float> _buffer;
+		Tensor<float> _min;
+		Tensor<float> _max;
+	};
+
+}
+#endif
@@ -40,6 +40,7 @@ namespace process {
 
 	private:
 		void _process(const std::string& label, Tensor<float>& in) const;
+		void _filter_slice(const float* in, float* out) const;
 
 		size_t _draw;
 		std::string _expName;
@@ -52,7 +53,11 @@ namespace process {
 		size_t _height;
 		size_t _depth;
 		size_t _conv_depth;
+		size_t _input_conv_depth;
 		Tensor<float> _filter;
+		// _taps[k*_filter_size+fk] is the clamped input frame read by the tap fk of the output frame k
+		std::vector<size_t> _taps;
+		std::vector<size_t> _rows;
 	};	
 }
 #endif
@@ -10,6 +10,19 @@
 
 namespace process {
 
+	namespace _priv {
+
+		class WhiteningHelper {
+
+		public:
+			WhiteningHelper() = delete;
+
+			static Tensor<float> filter_matrix(const std::vector<Tensor<float>>& filter);
+			static void apply(const Tensor<float>& filter_matrix, size_t patch_size, Tensor<float>& sample);
+
+		};
+	}
+
 	class WhiteningPatches : public TwoPassProcess {
 
 	public:
@@ -35,6 +48,7 @@ namespace process {
 
 		std::vector<Tensor<float>> _list;
 		std::vector<Tensor<float>> _filter;
+		Tensor<float> _filter_matrix;
 	};
 
 }
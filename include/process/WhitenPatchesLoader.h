@@ -7,6 +7,7 @@
 #include "Tensor.h"
 #include "Process.h"
 #include "Math.h"
+#include "process/WhitenPatches.h"
 
 namespace process {
 
@@ -31,6 +32,7 @@ namespace process {
 		size_t _max_sample;
 
 		std::vector<Tensor<float>> _filter;
+		Tensor<float> _filter_matrix;
 	};
 
 }
@@ -0,0 +1,96 @@
+#ifndef _TOOL_BOUNDED_QUEUE_H
+#define _TOOL_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace tool {
+
+	/**
+	 * @brief Blocking FIFO queue of at most capacity elements, between the threads of a pipeline: push() waits while the queue is full,
+	 * pop() waits while it is empty. close() ends the stream, the consumers still get the elements already queued;
+	 * cancel() also drops them and wakes up the producers, to stop a pipeline on error.
+	 *
+	 * @param capacity size_t - Maximum number of queued elements (at least 1).
+	 */
+	template<typename T>
+	class BoundedQueue {
+
+	public:
+		BoundedQueue(size_t capacity) : _mutex(), _not_full(), _not_empty(), _queue(), _capacity(capacity > 0 ? capacity : 1), _closed(false) {
+
+		}
+
+		BoundedQueue(const BoundedQueue& that) = delete;
+		BoundedQueue& operator=(const BoundedQueue& that) = delete;
+
+		/**
+		 * @brief Queues value, waiting for a free slot.
+		 * @return false if the queue was closed, value is then dropped
+		 */
+		bool push(T value) {
+			std::unique_lock<std::mutex> lock(_mutex);
+			_not_full.wait(lock, [this]() {
+				return _queue.size() < _capacity || _closed;
+			});
+			if(_closed) {
+				return false;
+			}
+			_queue.push_back(std::move(value));
+			lock.unlock();
+			_not_empty.notify_one();
+			return true;
+		}
+
+		/**
+		 * @brief Takes the oldest element, waiting for one.
+		 * @return false when the queue is closed and empty
+		 */
+		bool pop(T& value) {
+			std::unique_lock<std::mutex> lock(_mutex);
+			_not_empty.wait(lock, [this]() {
+				return !_queue.empty() || _closed;
+			});
+			if(_queue.empty()) {
+				return false;
+			}
+			value = std::move(_queue.front());
+			_queue.pop_front();
+			lock.unlock();
+			_not_full.notify_one();
+			return true;
+		}
+
+		void close() {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_closed = true;
+			}
+			_not_full.notify_all();
+			_not_empty.notify_all();
+		}
+
+		void cancel() {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_closed = true;
+				_queue.clear();
+			}
+			_not_full.notify_all();
+			_not_empty.notify_all();
+		}
+
+	private:
+		std::mutex _mutex;
+		std::condition_variable _not_full;
+		std::condition_variable _not_empty;
+		std::deque<T> _queue;
+		size_t _capacity;
+		bool _closed;
+	};
+
+}
+
+#endif
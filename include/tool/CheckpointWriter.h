@@ -0,0 +1,46 @@
+#ifndef _TOOL_CHECKPOINT_WRITER_H
+#define _TOOL_CHECKPOINT_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace tool {
+
+	/**
+	 * @brief Writes files from a background thread (started on the first file), so that the caller only pays for serializing the content in memory.
+	 * A file is written to <filename>.tmp and then renamed, so that a crash during the write leaves the previous version intact.
+	 * When a file is queued again before being written, only its most recent content is kept.
+	 * The pending files are written before the destruction of the writer.
+	 */
+	class CheckpointWriter {
+
+	public:
+		CheckpointWriter();
+		~CheckpointWriter();
+
+		CheckpointWriter(const CheckpointWriter& that) = delete;
+		CheckpointWriter& operator=(const CheckpointWriter& that) = delete;
+
+		void write(const std::string& filename, std::string content);
+		void flush();
+
+	private:
+		void _run();
+		static void _write(const std::string& filename, const std::string& content);
+
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		std::deque<std::pair<std::string, std::string>> _queue;
+		bool _writing;
+		bool _running;
+		std::once_flag _started;
+		std::thread _thread;
+	};
+
+}
+
+#endif
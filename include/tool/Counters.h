@@ -0,0 +1,143 @@
+#ifndef _TOOL_COUNTERS_H
+#define _TOOL_COUNTERS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Tensor.h"
+#include "SparseTensor.h"
+
+namespace tool {
+
+	/**
+	 * @brief Performance counters of the processes: input and output spikes, synaptic integrations, STDP weight updates,
+	 * bytes of intermediate storage and a latency histogram of the samples.
+	 * They are compiled only when PERF_COUNTERS is defined (cmake -DPERF_COUNTERS=ON), otherwise all the functions are empty.
+	 *
+	 * Each thread increments its own block of counters, so that there is neither lock nor shared cache line on the hot path.
+	 * The blocks are linked in a lock-free list, and the export sums them.
+	 * Counters are indexed by the position of the process in the experiment, the processes of the outputs (and the ones after MaxProcess) are not counted.
+	 */
+	class Counters {
+
+	public:
+		enum Counter {
+			InputSpikes, OutputSpikes, SynapticIntegrations, StdpUpdates, StorageBytes, Samples, LatencyNanoseconds, CounterNumber
+		};
+
+		static constexpr size_t MaxProcess = 64;
+		// Bin b counts the samples which took [2^b, 2^(b+1)) ns
+		static constexpr size_t LatencyBinNumber = 40;
+
+		static constexpr bool enabled() {
+#ifdef PERF_COUNTERS
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		static void add(size_t process_index, Counter counter, uint64_t value) {
+#ifdef PERF_COUNTERS
+			if(process_index < MaxProcess) {
+				_increment(_local().counters[process_index][counter], value);
+			}
+#else
+			(void)process_index;
+			(void)counter;
+			(void)value;
+#endif
+		}
+
+		static void add_latency(size_t process_index, uint64_t nanoseconds);
+
+		/**
+		 * @brief Adds the size of the output set of a process (Tensor or SparseTensor samples, with their labels).
+		 */
+		template<typename Data>
+		static void add_storage(size_t process_index, const Data& data) {
+#ifdef PERF_COUNTERS
+			uint64_t total = 0;
+			for(const auto& entry : data) {
+				total += entry.first.size() + _bytes(entry.second);
+			}
+			add(process_index, StorageBytes, total);
+#else
+			(void)process_index;
+			(void)data;
+#endif
+		}
+
+		static void reset();
+		static void save_json(const std::string& filename, const std::vector<std::string>& process_names);
+		static void save_csv(const std::string& filename, const std::vector<std::string>& process_names);
+
+	private:
+		struct Block {
+			std::atomic<uint64_t> counters[MaxProcess][CounterNumber];
+			std::atomic<uint64_t> latency[MaxProcess][LatencyBinNumber];
+			Block* next;
+		};
+
+		struct Summary {
+			uint64_t counters[CounterNumber];
+			uint64_t latency[LatencyBinNumber];
+		};
+
+		// Only the owner thread writes a block, a relaxed load/store pair is enough and avoids the locked instruction of fetch_add
+		static void _increment(std::atomic<uint64_t>& counter, uint64_t value) {
+			counter.store(counter.load(std::memory_order_relaxed)+value, std::memory_order_relaxed);
+		}
+
+		template<typename T>
+		static uint64_t _bytes(const Tensor<T>& tensor) {
+			return tensor.shape().product()*sizeof(T);
+		}
+
+		template<typename T>
+		static uint64_t _bytes(const SparseTensor<T>& tensor) {
+			return tensor.values().size()*sizeof(std::pair<uint32_t, T>);
+		}
+
+		static Block& _local();
+		static std::vector<Summary> _summarize(size_t process_number);
+		static uint64_t _percentile(const Summary& summary, double p);
+
+		static std::atomic<Block*> _blocks;
+	};
+
+	/**
+	 * @brief Adds the time spent between its construction and its destruction to the latency histogram of a process.
+	 */
+	class ScopedLatency {
+
+	public:
+#ifdef PERF_COUNTERS
+		ScopedLatency(size_t process_index) : _process_index(process_index), _start(std::chrono::steady_clock::now()) {
+
+		}
+
+		~ScopedLatency() {
+			Counters::add_latency(_process_index, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-_start).count());
+		}
+#else
+		ScopedLatency(size_t) {
+
+		}
+#endif
+
+		ScopedLatency(const ScopedLatency& that) = delete;
+		ScopedLatency& operator=(const ScopedLatency& that) = delete;
+
+#ifdef PERF_COUNTERS
+	private:
+		size_t _process_index;
+		std::chrono::steady_clock::time_point _start;
+#endif
+	};
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _TOOL_LINEAR_SVM_H
+#define _TOOL_LINEAR_SVM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace tool {
+
+	/**
+	 * @brief Linear SVM trained by dual coordinate descent (the L2-regularized L1-loss solver of liblinear, Hsieh et al. 2008),
+	 * one-vs-rest over the classes. Unlike the SMO solver of libsvm, there is no kernel cache and the cost of an iteration is
+	 * linear in the number of non-zero features, so it scales to large feature sets.
+	 * The bias is learned as an extra feature of constant value 1.
+	 * The classifiers are trained in parallel, and the weights are stored feature-major so that prediction is a product
+	 * between the sparse samples and a dense (feature x class) matrix.
+	 * The dual variables of the last training are kept, so that a training on the same problem with another C can start
+	 * from the previous solution (warm start), which makes the search of C along a regularization path cheap.
+	 *
+	 * @param eps float - Stopping tolerance on the projected gradient.
+	 * @param max_iteration size_t - Maximum number of passes over the samples for each classifier.
+	 */
+	class LinearSvm {
+
+	public:
+		/**
+		 * @brief Training samples in compressed sparse row format, the feature indexes are 0-based.
+		 */
+		class Problem {
+
+		public:
+			Problem();
+
+			void clear();
+			void reserve(size_t sample_number, size_t value_number);
+			void add_value(uint32_t index, float value);
+			void end_sample(size_t label);
+			void add_sample(const Problem& from, size_t i);
+
+			size_t sample_number() const;
+
+			std::vector<size_t> offsets;
+			std::vector<uint32_t> indexes;
+			std::vector<float> values;
+			std::vector<size_t> labels;
+		};
+
+		LinearSvm(float eps = 0.1, size_t max_iteration = 1000);
+
+		void train(const Problem& problem, size_t feature_number, size_t class_number, float c, bool warm_start = false);
+		size_t predict(const uint32_t* indexes, const float* values, size_t n) const;
+		void predict(const Problem& problem, std::vector<size_t>& predictions) const;
+
+		size_t class_number() const;
+
+	private:
+		size_t _decide(const uint32_t* indexes, const float* values, size_t n, double* scores) const;
+		void _solve(const Problem& problem, size_t positive_class, float c, double* w, double* alpha) const;
+
+		float _eps;
+		size_t _max_iteration;
+
+		size_t _feature_number;
+		size_t _class_number;
+		size_t _classifier_number;
+		std::vector<double> _weights;
+		std::vector<double> _alpha;
+	};
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _TOOL_LZ_H
+#define _TOOL_LZ_H
+
+#include <cstddef>
+#include <string>
+
+namespace tool {
+
+	/**
+	 * @brief Byte-oriented LZ77 block codec in the spirit of LZ4: a single pass with a hash table of the last position of each
+	 * 4-byte sequence, and matches within a 64 KiB window. It favors the decoding speed over the ratio, runs of zeros
+	 * (sparse feature maps) compress well, dense floats much less.
+	 *
+	 * A block is a list of sequences: a token (literal length on the high 4 bits, match length-4 on the low 4 bits, 15 meaning
+	 * that extension bytes follow, as in LZ4), the literals, and a 2-byte little-endian match offset. The last sequence has no match.
+	 */
+	class Lz {
+
+	public:
+		Lz() = delete;
+
+		/**
+		 * @brief Appends the compressed block of src to dst.
+		 */
+		static void compress(const char* src, size_t size, std::string& dst);
+
+		/**
+		 * @brief Decodes the block src into dst, which holds exactly raw_size bytes. Throws on a corrupted block.
+		 */
+		static void decompress(const char* src, size_t size, char* dst, size_t raw_size);
+	};
+
+}
+
+#endif
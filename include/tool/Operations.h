@@ -122,16 +122,6 @@ void SaveFeature(std::string fileName, std::string label, Tensor<float> time_out
  */
 void JSONstringEdits(std::string fileName);
 
-/**
- * @brief This function saves the log of which neuron fired at which sample.
- *
- * @param fileName the save location of the JSON file that contains the weights.
- * @param label the label of the clss responsible for these weights
- * @param neuron the neuron that fired.
- */
-void LogSpikingNeuron(std::string fileName, std::string label, size_t neuron);
-
-void LogUpdatedFilter(std::string fileName, size_t spike_number);
 void LogSpikeNumber(std::string fileName, size_t spike_number);
 
 /**
@@ -0,0 +1,237 @@
+#ifndef _TOOL_QUANTIZATION_H
+#define _TOOL_QUANTIZATION_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Tensor.h"
+#include "Spike.h"
+
+namespace tool {
+
+	/**
+	 * @brief uint8 copy of the weights and integer copy of the thresholds of a convolution layer, for its integer inference mode.
+	 * The weights (non-negative, as produced by the STDP rules that clamp them to [0, 1]) are scaled by 255 / max(w) and rounded;
+	 * the thresholds get the same scale.
+	 *
+	 * The weights are stored as rows of filter_number values, one per synapse of the filter, so that an input spike adds one
+	 * contiguous row to the potentials of a position. The potentials are int16 when the sum of all the weights of a filter fits,
+	 * int32 otherwise.
+	 *
+	 * A neuron that fires is inhibited by resetting its potential to Floor<Potential>(): the remaining integrations of the
+	 * sample can't bring it back to its threshold, so the kernels don't need an inhibition mask.
+	 */
+	class QuantizedWeights {
+
+	public:
+		QuantizedWeights();
+
+		/**
+		 * @brief Quantizes w, seen as synapse_number rows of filter_number weights, and th.
+		 */
+		void quantize(const Tensor<float>& w, const Tensor<float>& th, size_t synapse_number, size_t filter_number);
+
+		void invalidate() {
+			_ready = false;
+		}
+
+		bool ready() const {
+			return _ready;
+		}
+
+		bool narrow() const {
+			return _narrow;
+		}
+
+		float scale() const {
+			return _scale;
+		}
+
+		size_t filter_number() const {
+			return _filter_number;
+		}
+
+		const uint8_t* row(size_t synapse) const {
+			return _w.data()+synapse*_filter_number;
+		}
+
+		template<typename Potential>
+		const Potential* thresholds() const;
+
+		template<typename Potential>
+		static constexpr Potential Floor() {
+			return std::numeric_limits<Potential>::min();
+		}
+
+		/**
+		 * @brief Adds the weights w to the potentials a and tells whether one of them reached its threshold.
+		 * Integer SIMD (AVX2) when the compiler targets it.
+		 */
+		static bool integrate(int16_t* a, const uint8_t* w, const int16_t* th, size_t n);
+		static bool integrate(int32_t* a, const uint8_t* w, const int32_t* th, size_t n);
+
+	private:
+		bool _ready;
+		bool _narrow;
+		float _scale;
+		size_t _filter_number;
+		std::vector<uint8_t> _w;
+		std::vector<int16_t> _th16;
+		std::vector<int32_t> _th32;
+	};
+
+	template<>
+	inline const int16_t* QuantizedWeights::thresholds<int16_t>() const {
+		return _th16.data();
+	}
+
+	template<>
+	inline const int32_t* QuantizedWeights::thresholds<int32_t>() const {
+		return _th32.data();
+	}
+
+	/**
+	 * @brief Binary copy of the weights of a convolution layer, for its bit-packed inference mode: after a long STDP training,
+	 * most weights saturate at 0 or 1. A weight is 1 when it is >= cut, and then counts as a weight of 1.0; the thresholds are
+	 * rounded up to integers.
+	 *
+	 * The weights are stored as rows of bitsets across the filters (filter z is bit z % 64 of word z / 64), one row per synapse.
+	 * The potentials of an output position are bit-sliced counters, one bitset per bit of the counters: adding a row to them is
+	 * a ripple-carry over the planes, 64 filters per instruction. Each counter starts at 2^B - th so that it reaches the
+	 * top plane B when it reaches its threshold, and no comparison is needed. After the planes comes the bitset of the neurons
+	 * that already fired; together they are the whole state of a position: counter_size() words.
+	 */
+	class BinaryWeights {
+
+	public:
+		BinaryWeights();
+
+		/**
+		 * @brief Binarizes w, seen as synapse_number rows of filter_number weights, and th.
+		 */
+		void binarize(const Tensor<float>& w, const Tensor<float>& th, size_t synapse_number, size_t filter_number, float cut);
+
+		void invalidate() {
+			_ready = false;
+		}
+
+		bool ready() const {
+			return _ready;
+		}
+
+		size_t counter_size() const {
+			return (_plane_number+1)*_word_number;
+		}
+
+		/**
+		 * @brief Sets the counters of position_number positions to their initial value.
+		 */
+		void reset(std::vector<uint64_t>& counters, size_t position_number) const;
+
+		/**
+		 * @brief Adds the row of synapse to the counters of a position, and calls emit(z) for each neuron z that is at its threshold,
+		 * in increasing z order. With inhibition, a neuron is only emitted the first time.
+		 * @return the number of emitted neurons
+		 */
+		template<typename Emit>
+		size_t integrate(uint64_t* counters, size_t synapse, bool inhibition, Emit emit) const {
+			const uint64_t* row = _w.data()+synapse*_word_number;
+			uint64_t* fired = counters+_plane_number*_word_number;
+			size_t emitted = 0;
+
+			for(size_t word=0; word<_word_number; word++) {
+				uint64_t carry = row[word];
+				for(size_t plane=0; plane<_plane_number && carry != 0; plane++) {
+					uint64_t& bits = counters[plane*_word_number+word];
+					uint64_t next = bits & carry;
+					bits ^= carry;
+					carry = next;
+				}
+
+				uint64_t spikes = counters[(_plane_number-1)*_word_number+word];
+				if(inhibition) {
+					spikes &= ~fired[word];
+					fired[word] |= spikes;
+				}
+
+				while(spikes != 0) {
+					emit(word*64+static_cast<size_t>(__builtin_ctzll(spikes)));
+					spikes &= spikes-1;
+					emitted++;
+				}
+			}
+
+			return emitted;
+		}
+
+		/**
+		 * @brief Fraction of the weights that are 1.
+		 */
+		float density() const {
+			return _density;
+		}
+
+		/**
+		 * @brief Mean of |w - b| over the weights, 0 when all of them are saturated.
+		 */
+		float error() const {
+			return _error;
+		}
+
+		std::string to_string() const;
+
+	private:
+		bool _ready;
+		size_t _word_number;
+		size_t _plane_number;
+		float _density;
+		float _error;
+		std::vector<uint64_t> _w;
+		std::vector<uint64_t> _initial;
+	};
+
+	/**
+	 * @brief Calibration of an integer inference mode: the output spikes of the quantized path are compared to the ones of the
+	 * float path on the same samples.
+	 *
+	 * A neuron is matched when it fires in both paths; it is retimed when it fires at another time. The firing order change is
+	 * the mean displacement of the matched neurons between their ranks in the two spike trains, relative to the number of matched
+	 * neurons of the sample and averaged over the samples (0: same order, about 1/3: unrelated orders).
+	 */
+	class QuantizationReport {
+
+	public:
+		QuantizationReport();
+
+		void reset();
+
+		/**
+		 * @brief Adds a sample. The neuron of a spike is identified by its (x, y, z, k) coordinates.
+		 */
+		void add(const std::vector<Spike>& reference, const std::vector<Spike>& quantized);
+
+		size_t sample_number() const {
+			return _sample_number;
+		}
+
+		double match_ratio() const;
+		double retimed_ratio() const;
+		double rank_displacement() const;
+
+		std::string to_string() const;
+
+	private:
+		size_t _sample_number;
+		size_t _reference_spikes;
+		size_t _quantized_spikes;
+		size_t _matched;
+		size_t _retimed;
+		size_t _ordered_samples;
+		double _displacement;
+		double _max_time_shift;
+	};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef _TOOL_STAGE_CACHE_H
+#define _TOOL_STAGE_CACHE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "Tensor.h"
+#include "SparseTensor.h"
+#include "TensorReader.h"
+#include "TensorWriter.h"
+
+namespace tool {
+
+	/**
+	 * @brief Content-addressed store of the output sets of the processes of an experiment. The key of an entry is a hash of everything
+	 * the output depends on, so that an entry found under the same key can replace the run of the process.
+	 *
+	 * An entry is a directory <path>/<key>/ holding train.bin and test.bin, the output sets as compressed TENSOR_FILE_V2 files,
+	 * plus the files the caller adds. It is written in <key>.tmp/ and renamed when complete, so that an interrupted run never
+	 * leaves a partial entry. Nothing is ever evicted: remove the directory to clear the cache.
+	 */
+	class StageCache {
+
+	public:
+		StageCache();
+
+		void open(const std::string& path);
+
+		bool is_open() const {
+			return !_path.empty();
+		}
+
+		const std::string& path() const {
+			return _path;
+		}
+
+		/**
+		 * @brief FNV-1a-128 hash of the parent key followed by content, in hexadecimal.
+		 */
+		static std::string key(const std::string& parent, const std::string& content);
+
+		bool contains(const std::string& key) const;
+		std::string entry_path(const std::string& key) const;
+
+		/**
+		 * @brief Creates the temporary directory of a new entry and returns its path.
+		 */
+		std::string begin(const std::string& key);
+		void commit(const std::string& key);
+
+		template<typename Data>
+		static void write_set(const std::string& filename, const Data& data) {
+			TensorWriter writer(filename, false, TENSOR_FILE_V2, true);
+			for(const auto& entry : data) {
+				writer.write(entry.first, _dense(entry.second));
+			}
+			writer.close();
+		}
+
+		template<typename T>
+		static void read_set(const std::string& filename, std::vector<std::pair<std::string, T>>& data) {
+			data.clear();
+			TensorReader reader(filename);
+			data.reserve(reader.size());
+			while(reader.has_next()) {
+				std::pair<std::string, Tensor<float>> entry = reader.next();
+				data.emplace_back(std::move(entry.first), _convert(std::move(entry.second), static_cast<T*>(nullptr)));
+			}
+			reader.close();
+		}
+
+	private:
+		static const Tensor<float>& _dense(const Tensor<float>& tensor) {
+			return tensor;
+		}
+
+		static Tensor<float> _dense(const SparseTensor<float>& tensor) {
+			return from_sparse_tensor(tensor);
+		}
+
+		static Tensor<float> _convert(Tensor<float>&& tensor, Tensor<float>*) {
+			return std::move(tensor);
+		}
+
+		static SparseTensor<float> _convert(Tensor<float>&& tensor, SparseTensor<float>*) {
+			return to_sparse_tensor(tensor);
+		}
+
+		std::string _path;
+	};
+
+}
+
+#endif
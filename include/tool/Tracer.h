@@ -0,0 +1,79 @@
+#ifndef _TOOL_TRACER_H
+#define _TOOL_TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tool {
+
+	/**
+	 * @brief Timeline of the execution in the Chrome trace event format (complete "X" events), to open in Perfetto or chrome://tracing.
+	 * Disabled by default, the spans cost a relaxed atomic load until enable(true) is called.
+	 *
+	 * Each thread records its spans in its own ring buffer of Capacity events (the oldest are overwritten when it is full),
+	 * the buffers are only locked by their owner and by save(), which writes and clears them.
+	 */
+	class Tracer {
+
+	public:
+		static constexpr size_t Capacity = 65536;
+
+		static void enable(bool enable);
+		static bool enabled() {
+			return _enabled.load(std::memory_order_relaxed);
+		}
+
+		static int64_t now();
+		static void record(const char* category, std::string name, int64_t start, int64_t end);
+		static void save(const std::string& filename);
+
+	private:
+		struct Event {
+			const char* category;
+			std::string name;
+			int64_t start;
+			int64_t duration;
+		};
+
+		struct Buffer {
+			std::mutex mutex;
+			std::vector<Event> events;
+			size_t next;
+			size_t thread_id;
+		};
+
+		static Buffer& _local();
+
+		static std::atomic<bool> _enabled;
+		static std::mutex _mutex;
+		static std::vector<std::shared_ptr<Buffer>> _buffers;
+	};
+
+	/**
+	 * @brief Span from its construction to end() or its destruction. Nothing is copied when the tracer is disabled.
+	 */
+	class TraceSpan {
+
+	public:
+		TraceSpan(const char* category, const std::string& name);
+		~TraceSpan();
+
+		TraceSpan(const TraceSpan& that) = delete;
+		TraceSpan& operator=(const TraceSpan& that) = delete;
+
+		void end();
+
+	private:
+		const char* _category;
+		std::string _name;
+		int64_t _start;
+		bool _open;
+	};
+
+}
+
+#endif
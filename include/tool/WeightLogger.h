@@ -0,0 +1,86 @@
+#ifndef _TOOL_WEIGHT_LOGGER_H
+#define _TOOL_WEIGHT_LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Tensor.h"
+
+namespace tool {
+
+	/**
+	 * @brief Asynchronous writer of the training logs: weight snapshots and neuron events (spiking neuron, updated filter).
+	 * The training thread only copies the record into a bounded lock-free queue, a background thread (started on the first record)
+	 * serializes the records into binary files that stay open until the logger is destroyed. The writer sleeps on a condition variable
+	 * while the queue is empty, and creates the directory of a file when it opens it.
+	 *
+	 * Files, in native byte order:
+	 * - <path>.weights.bin: "CSNNWGT1", then per snapshot: uint32 label size, label, uint32 rank, uint64 dims[rank], float data[product].
+	 * - <path>.events.bin: "CSNNEVT1", then per event: uint32 value (neuron or filter index), uint32 label size, label.
+	 * src/tool/read_weight_log.py reads both formats.
+	 *
+	 * @param capacity size_t - Number of pending records, rounded up to a power of 2. When the queue is full, the caller waits for the writer.
+	 */
+	class WeightLogger {
+
+	public:
+		WeightLogger(size_t capacity = 4096);
+		~WeightLogger();
+
+		WeightLogger(const WeightLogger& that) = delete;
+		WeightLogger& operator=(const WeightLogger& that) = delete;
+
+		void log_weights(const std::string& path, const std::string& label, const Tensor<float>& w);
+		void log_event(const std::string& path, const std::string& label, uint32_t value);
+		void flush();
+
+		static bool is_snapshot(size_t update_index, size_t interval);
+
+	private:
+		struct Record {
+			bool weights;
+			std::string path;
+			std::string label;
+			uint32_t value;
+			std::vector<uint64_t> dims;
+			std::vector<float> data;
+		};
+
+		struct Cell {
+			std::atomic<size_t> sequence;
+			Record* record;
+		};
+
+		void _push(std::unique_ptr<Record> record);
+		Record* _pop();
+		void _run();
+		void _write(const Record& record);
+
+		std::unique_ptr<Cell[]> _cells;
+		size_t _mask;
+		alignas(64) std::atomic<size_t> _enqueue_position;
+		alignas(64) std::atomic<size_t> _dequeue_position;
+
+		std::atomic<size_t> _pushed_count;
+		std::atomic<size_t> _flushed_count;
+		std::atomic<bool> _running;
+		std::atomic<bool> _sleeping;
+		std::mutex _wake_mutex;
+		std::condition_variable _wake;
+		std::condition_variable _flushed;
+		std::once_flag _started;
+		std::thread _thread;
+
+		std::map<std::string, std::ofstream> _files;
+	};
+
+}
+
+#endif
@@ -1,5 +1,8 @@
 #include "Experiment.h"
 
+#include <filesystem>
+#include <sstream>
+
 
 #ifdef ENABLE_QT
 
@@ -23,7 +26,9 @@ AbstractExperiment::AbstractExperiment(const std::string& output_path, const std
 #ifdef ENABLE_QT
 	_plots(),
 #endif
-	_monitors(), _outputs() {
+	_monitors(), _outputs(), _checkpoint_path(output_path+"/checkpoint_"+name), _checkpoint_interval(0),
+	_resume_process(nullptr), _resume_pass(0), _resume_random_state(), _writer(),
+	_cache_path(), _cache(), _cache_keys(), _cached_process_number(0) {
 
 	_print.add_output(std::cout);
 
@@ -81,6 +86,10 @@ AbstractExperiment::~AbstractExperiment() {
 	for(Output* o : _outputs) {
 		delete o;
 	}
+
+	for(Monitor* m : _monitors) {
+		delete m;
+	}
 }
 
 void AbstractExperiment::load(const std::string& filename) {
@@ -90,6 +99,15 @@ void AbstractExperiment::load(const std::string& filename) {
 void AbstractExperiment::save(const std::string& filename) const {
 	_save(filename);
 }
+
+/**
+ * @brief Serializes the experiment in memory, the file is written by a background thread.
+ */
+void AbstractExperiment::save_async(const std::string& filename) const {
+	std::ostringstream stream(std::ios::out | std::ios::binary);
+	_save(stream);
+	_writer.write(filename, stream.str());
+}
 /*
 void AbstractExperiment::add_train_step(Layer& layer, size_t epoch_number) {
 	size_t layer_index = 0;
@@ -162,11 +180,49 @@ void AbstractExperiment::initialize(const Shape& input_shape) {
 	}
 }
 
-void AbstractExperiment::run(size_t refresh_interval) {
+/**
+ * @brief Saves a checkpoint of the processes every epoch_interval training epochs of a layer.
+ * The checkpoint is written by a background thread in <output_path>/checkpoint_<name>, the name given to the experiment before any renaming,
+ * so that a run restarted with the same name finds it.
+ */
+void AbstractExperiment::enable_checkpoint(size_t epoch_interval) {
+	_checkpoint_interval = epoch_interval;
+}
+
+/**
+ * @brief Records a timeline of the run (data loading, training passes, tests, outputs, checkpoints), saved at the end of the run
+ * in <output_path>/trace_<name>.json, in the Chrome trace event format.
+ */
+void AbstractExperiment::enable_trace(bool enable) {
+	tool::Tracer::enable(enable);
+}
+
+/**
+ * @brief Caches the output sets of the processes in path (<output_path>/cache by default). A process is skipped, and its outputs read
+ * from the cache, when it runs after the same processes on the same inputs: the key of its entry hashes the descriptions of the
+ * train and test inputs, the seed and state of the random generator after the initialization, and the parameters of the process
+ * and of all the ones before it (as saved by ClassParameter::save, weights included). The outputs are not part of the keys, so
+ * changing an analysis reuses all the processes. Changes of the code or of the files behind an input description are not detected.
+ */
+void AbstractExperiment::enable_cache(const std::string& path) {
+	_cache_path = path.empty() ? _output_path + "/cache" : path;
+}
+
+/**
+ * @brief Runs the experiment. With resume, the processes are restored from the last checkpoint (if any) and the training continues
+ * after the epoch where it stopped: the layers trained before the checkpoint only run their last pass, which computes their output.
+ */
+void AbstractExperiment::run(size_t refresh_interval, bool resume) {
 	auto t_start = std::chrono::high_resolution_clock ::now();
 	_log << "Run start at ";
 	_print_date(_log) << std::endl;
 
+	tool::Counters::reset();
+
+	if(resume && !_load_checkpoint()) {
+		_log << "No checkpoint " << _checkpoint_path << ", start from the beginning" << std::endl;
+	}
+
 	if(_input_shape == nullptr) {
 		std::runtime_error("Require input data");
 	}
@@ -224,9 +280,27 @@ void AbstractExperiment::run(size_t refresh_interval) {
 		_plots[i].first->show();
 	}
 #endif
+	_prepare_cache();
+
+	tool::TraceSpan span("experiment", _name);
 	process(refresh_interval);
+	span.end();
 
 	_save(_output_path + "/" + "param"+_name);
+	_writer.flush();
+
+	if(tool::Counters::enabled()) {
+		std::vector<std::string> process_names;
+		for(AbstractProcess* entry : _process_list) {
+			process_names.push_back(entry->class_name()+" "+entry->name());
+		}
+		tool::Counters::save_json(_output_path + "/" + "counters_" + _name + ".json", process_names);
+		tool::Counters::save_csv(_output_path + "/" + "counters_" + _name + ".csv", process_names);
+	}
+
+	if(tool::Tracer::enabled()) {
+		tool::Tracer::save(_output_path + "/" + "trace_" + _name + ".json");
+	}
 
 	auto t_end = std::chrono::high_resolution_clock ::now();
 
@@ -283,12 +357,46 @@ void AbstractExperiment::refresh(size_t) {
 }
 #endif
 
-void AbstractExperiment::epoch(size_t current_layer_index, size_t epoch_count) {
+/**
+ * @brief Called at the end of each training pass of a process. A checkpoint is saved after the training epochs of the layers,
+ * not after their last pass which only computes their output.
+ */
+void AbstractExperiment::epoch(const AbstractProcess& process, size_t epoch_count) {
 	for(Monitor* m : _monitors) {
-		m->on_epoch(*this, current_layer_index, epoch_count);
+		m->on_epoch(*this, process.index(), epoch_count);
+	}
+
+	if(_checkpoint_interval > 0 && dynamic_cast<const Layer*>(&process) != nullptr && epoch_count+1 < process.train_pass_number() &&
+	   (epoch_count+1) % _checkpoint_interval == 0 && process.index() < _process_list.size() && _process_list[process.index()] == &process) {
+		_save_checkpoint(process, epoch_count);
 	}
 }
 
+/**
+ * @brief Tells the execution policy whether a training pass was already done before the checkpoint the run resumes from.
+ * The random generator is restored when the first pass after the checkpoint starts.
+ */
+bool AbstractExperiment::skip_train_pass(const AbstractProcess& process, size_t pass) {
+	if(_resume_process == nullptr || process.index() >= _process_list.size() || _process_list[process.index()] != &process) {
+		return false;
+	}
+
+	if(&process == _resume_process) {
+		if(pass <= _resume_pass) {
+			return true;
+		}
+
+		std::istringstream random_state(_resume_random_state);
+		random_state >> _random_generator;
+		_resume_process = nullptr;
+		_log << "Resume training of " << process.name() << " at epoch " << (pass+1) << std::endl;
+		return false;
+	}
+
+	// Parameters of the previous layers are restored, only their output is computed. The other processes have no saved state, they are replayed.
+	return process.index() < _resume_process->index() && dynamic_cast<const Layer*>(&process) != nullptr && pass+1 < process.train_pass_number();
+}
+
 const std::string& AbstractExperiment::name() const {
 	return _name;
 }
@@ -429,6 +537,11 @@ void AbstractExperiment::_save(const std::string& filename) const {
 	if(!file.good()) {
 		throw std::runtime_error("Unable to open param"+_name);
 	}
+
+	_save(file);
+}
+
+void AbstractExperiment::_save(std::ostream& file) const {
 /*
 	uint32_t preprocessing_size = _preprocessing.size();
 	file.write(reinterpret_cast<const char*>(&preprocessing_size), sizeof(uint32_t));
@@ -524,6 +637,203 @@ void AbstractExperiment::_load(const std::string& filename) {
 
 }
 
+/**
+ * @brief Copies the state of the processes in memory, then queues it to the background writer.
+ * Format: "CSNNCKP1", uint32 process index, uint32 epoch, random generator state, uint32 process count, then each process as in _save.
+ * The trained parameters (weights, thresholds, annealed learning rates of the layers and of their STDP) are saved with the process parameters.
+ */
+void AbstractExperiment::_save_checkpoint(const AbstractProcess& process, size_t epoch_count) {
+	tool::TraceSpan span("checkpoint", "serialize " + _checkpoint_path);
+	std::ostringstream stream(std::ios::out | std::ios::binary);
+	stream.write("CSNNCKP1", 8);
+
+	uint32_t process_index = process.index();
+	stream.write(reinterpret_cast<const char*>(&process_index), sizeof(uint32_t));
+	uint32_t epoch_index = epoch_count;
+	stream.write(reinterpret_cast<const char*>(&epoch_index), sizeof(uint32_t));
+
+	std::ostringstream random_state;
+	random_state << _random_generator;
+	Persistence::save_string(random_state.str(), stream);
+
+	uint32_t process_size = _process_list.size();
+	stream.write(reinterpret_cast<const char*>(&process_size), sizeof(uint32_t));
+
+	for(AbstractProcess* entry : _process_list) {
+		Persistence::save_string(entry->name(), stream);
+		entry->save(stream);
+	}
+
+	_writer.write(_checkpoint_path, stream.str());
+}
+
+/**
+ * @brief Loads the parameters of the processes from the checkpoint, before their initialization.
+ * Returns false if there is no checkpoint.
+ */
+bool AbstractExperiment::_load_checkpoint() {
+	std::ifstream file(_checkpoint_path, std::ios::in | std::ios::binary);
+
+	if(!file.good()) {
+		return false;
+	}
+
+	char magic[8];
+	file.read(magic, 8);
+	if(!file.good() || std::string(magic, 8) != "CSNNCKP1") {
+		throw std::runtime_error("Invalid checkpoint "+_checkpoint_path);
+	}
+
+	uint32_t process_index;
+	file.read(reinterpret_cast<char*>(&process_index), sizeof(uint32_t));
+	uint32_t epoch_index;
+	file.read(reinterpret_cast<char*>(&epoch_index), sizeof(uint32_t));
+	std::string random_state = Persistence::load_string(file);
+
+	uint32_t process_size;
+	file.read(reinterpret_cast<char*>(&process_size), sizeof(uint32_t));
+	if(process_size != _process_list.size() || process_index >= process_size) {
+		throw std::runtime_error("Checkpoint "+_checkpoint_path+" doesn't match the experiment");
+	}
+
+	for(AbstractProcess* entry : _process_list) {
+		Persistence::load_string(file);
+
+		uint32_t class_magic;
+		file.read(reinterpret_cast<char*>(&class_magic), sizeof(uint32_t));
+		std::string factory_name = Persistence::load_string(file);
+		std::string class_name = Persistence::load_string(file);
+
+		if(class_magic != ClassParameter::Magic || factory_name != entry->factory_name() || class_name != entry->class_name()) {
+			throw std::runtime_error("Checkpoint "+_checkpoint_path+" doesn't match the experiment: expected "+entry->factory_name()+"."+entry->class_name()+
+									 ", got "+factory_name+"."+class_name);
+		}
+
+		entry->load(file);
+	}
+
+	_resume_process = _process_list[process_index];
+	_resume_pass = epoch_index;
+	_resume_random_state = random_state;
+
+	_log << "Resume from " << _checkpoint_path << ": " << _resume_process->name() << ", epoch " << (_resume_pass+1) << std::endl;
+	return true;
+}
+
+/**
+ * @brief Computes the cache keys of the processes, each one chained to the key of the previous process, and counts the leading
+ * processes whose entry exists.
+ */
+void AbstractExperiment::_prepare_cache() {
+	_cache_keys.clear();
+	_cached_process_number = 0;
+
+	if(_cache_path.empty()) {
+		return;
+	}
+
+	_cache.open(_cache_path);
+
+	std::ostringstream root(std::ios::out | std::ios::binary);
+	root.write("CSNNSTG1", 8);
+	Persistence::save_string(std::to_string(_seed), root);
+	for(Input* input : _train_data) {
+		Persistence::save_string("train "+input->to_string(), root);
+	}
+	for(Input* input : _test_data) {
+		Persistence::save_string("test "+input->to_string(), root);
+	}
+	std::ostringstream random_state;
+	random_state << _random_generator;
+	Persistence::save_string(random_state.str(), root);
+
+	std::string key = tool::StageCache::key("", root.str());
+	for(AbstractProcess* entry : _process_list) {
+		std::ostringstream stream(std::ios::out | std::ios::binary);
+		entry->save(stream);
+		key = tool::StageCache::key(key, stream.str());
+		_cache_keys.push_back(key);
+	}
+
+	while(_cached_process_number < _cache_keys.size() && _cache.contains(_cache_keys[_cached_process_number])) {
+		_cached_process_number++;
+	}
+
+	_log << "Cache " << _cache_path << ": " << _cached_process_number << " of " << _process_list.size() << " processes cached" << std::endl;
+}
+
+size_t AbstractExperiment::cached_process_number() const {
+	return _cached_process_number;
+}
+
+/**
+ * @brief Loads the parameters saved with the entry of the process index and restores the random generator.
+ * Format of the state file: "CSNNSTG1", uint8 1 if params/ holds the save_params of the process, random generator state.
+ */
+std::string AbstractExperiment::_restore_cached_state(size_t index) {
+	AbstractProcess& process = *_process_list.at(index);
+	std::string path = _cache.entry_path(_cache_keys.at(index));
+
+	std::ifstream file(path + "/state", std::ios::in | std::ios::binary);
+	char magic[8];
+	file.read(magic, 8);
+	if(!file.good() || std::string(magic, 8) != "CSNNSTG1") {
+		throw std::runtime_error("Invalid cache entry "+path);
+	}
+
+	uint8_t saved;
+	file.read(reinterpret_cast<char*>(&saved), sizeof(uint8_t));
+	std::istringstream random_state(Persistence::load_string(file));
+	random_state >> _random_generator;
+
+	if(saved != 0 && !process.load_params(path + "/params/")) {
+		throw std::runtime_error("Can't load the cached parameters of "+process.name()+" from "+path);
+	}
+
+	_log << "Restore " << process.class_name() << " " << process.name() << " from cache " << _cache_keys.at(index) << std::endl;
+	return path;
+}
+
+/**
+ * @brief The output sets of a cached process are only read when one of its outputs or the next process (which is not cached) needs them.
+ */
+bool AbstractExperiment::_cached_set_needed(size_t index) const {
+	if(index+1 == _cached_process_number) {
+		return true;
+	}
+
+	for(const Output* output : _outputs) {
+		if(output->index() == index) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Starts the entry of the process index, with its trained parameters and the random generator state. Returns the path where the
+ * output sets go.
+ */
+std::string AbstractExperiment::_begin_cache_entry(size_t index) {
+	AbstractProcess& process = *_process_list.at(index);
+	std::string path = _cache.begin(_cache_keys.at(index));
+
+	std::filesystem::create_directories(path + "/params/");
+	uint8_t saved = process.save_params(path + "/params/") ? 1 : 0;
+
+	std::ofstream file(path + "/state", std::ios::out | std::ios::trunc | std::ios::binary);
+	file.write("CSNNSTG1", 8);
+	file.write(reinterpret_cast<const char*>(&saved), sizeof(uint8_t));
+	std::ostringstream random_state;
+	random_state << _random_generator;
+	Persistence::save_string(random_state.str(), file);
+
+	if(!file.good()) {
+		throw std::runtime_error("Can't write the cache entry "+path);
+	}
+	return path;
+}
+
 void AbstractExperiment::_check_data_shape(const Shape& shape) {
 	if(_input_shape == nullptr) {
 		_input_shape = new Shape(shape);
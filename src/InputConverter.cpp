@@ -17,14 +17,14 @@ void InputConverter::process_train_sample(const std::string&, Tensor<float>& sam
 	Tensor<Time> out(sample.shape());
 	out.fill(INFINITE_TIME);
 	process(sample, out);
-	sample = out;
+	sample = std::move(out);
 }
 
 void InputConverter::process_test_sample(const std::string&, Tensor<float>& sample, size_t, size_t) {
 	Tensor<Time> out(sample.shape());
 	out.fill(INFINITE_TIME);
 	process(sample, out);
-	sample = out;
+	sample = std::move(out);
 }
 
 //
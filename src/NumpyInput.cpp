@@ -1,9 +1,8 @@
 #include "NumpyInput.h"
 
-NumpyInput::NumpyInput(const std::string& filename) : _name(filename), _archive(), _data(nullptr), _label(nullptr), _current(0) {
-	NumpyReader::load(filename, _archive);
-	_data = &_archive.at("arr_0.npy");
-	_label = &_archive.at("arr_1.npy");
+NumpyInput::NumpyInput(const std::string& filename) : _name(filename), _mapping(new NumpyMapping(filename)), _data(nullptr), _label(nullptr), _shape(), _current(0) {
+	_data = &_mapping->at("arr_0.npy");
+	_label = &_mapping->at("arr_1.npy");
 
 	if(_data->dimension_number() != 4) {
 		throw std::runtime_error("[NumpyInput] Unknown format (expected 4-dimension data tensor)");
@@ -15,6 +14,8 @@ NumpyInput::NumpyInput(const std::string& filename) : _name(filename), _archive(
 	if(_data->dimension(0) != _label->dimension(0)) {
 		throw std::runtime_error("[NumpyInput] Incompatible data and label tensor");
 	}
+
+	_shape = Shape({_data->dimension(1), _data->dimension(2), _data->dimension(3)});
 }
 
 bool NumpyInput::has_next() const {
@@ -22,19 +23,10 @@ bool NumpyInput::has_next() const {
 }
 
 std::pair<std::string, Tensor<InputType>> NumpyInput::next() {
-	size_t width = _data->dimension(1);
-	size_t height = _data->dimension(2);
-	size_t depth = _data->dimension(3);
-
-	std::pair<std::string, Tensor<InputType>> out(std::to_string(_label->at(_current)), Shape({width, height, depth}));
-
-	for(size_t x=0; x<width; x++) {
-		for(size_t y=0; y<height; y++) {
-			for(size_t z=0; z<depth; z++) {
-				out.second.at(x, y, z) = _data->at(_current, x, y, z);
-			}
-		}
-	}
+	std::pair<std::string, Tensor<InputType>> out(std::to_string(_label->at_index<double>(_current)), _shape);
+
+	// Tensor and numpy (C order) share the row-major layout: a sample is a contiguous block of the array
+	_data->copy(_current*_shape.product(), _shape.product(), out.second.ptr_index(0));
 
 	_current++;
 	return out;
@@ -45,9 +37,9 @@ void NumpyInput::reset() {
 }
 
 void NumpyInput::close() {
-	_archive.clear();
 	_data = nullptr;
 	_label = nullptr;
+	_mapping.reset();
 }
 
 std::string NumpyInput::to_string() const {
@@ -55,5 +47,5 @@ std::string NumpyInput::to_string() const {
 }
 
 const Shape& NumpyInput::shape() const {
-	throw std::runtime_error("Unimplemented");
+	return _shape;
 }
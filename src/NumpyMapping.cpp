@@ -0,0 +1,268 @@
+#include "NumpyMapping.h"
+#include "NumpyStruct.h"
+
+#include <numeric>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ZIP_DATA_DESCRIPTOR_MAGIC 0x08074b50
+#define ZIP64_EXTRA_FIELD 0x0001
+#define ZIP_SIZE_IN_ZIP64 0xFFFFFFFF
+#define ZIP_FLAG_DATA_DESCRIPTOR 0x0008
+
+//
+//	NumpyView
+//
+
+NumpyView::NumpyView(const char* data, const std::vector<size_t>& dimension, NumpyType type, bool swap) :
+	_data(data), _dimension(dimension), _size(std::accumulate(std::begin(dimension), std::end(dimension), static_cast<size_t>(1), std::multiplies<size_t>())),
+	_type(type), _swap(swap) {
+
+}
+
+size_t NumpyView::element_size() const {
+	switch(_type) {
+	case NUMPY_FLOAT32:
+	case NUMPY_INT32:
+		return 4;
+	case NUMPY_FLOAT64:
+	case NUMPY_INT64:
+		return 8;
+	case NUMPY_UINT8:
+		return 1;
+	}
+	return 0;
+}
+
+//
+//	NumpyMapping
+//
+
+template<typename T>
+T NumpyMapping::_read(size_t offset) const {
+	_check(offset, sizeof(T));
+	T value;
+	std::memcpy(&value, _data+offset, sizeof(T));
+	return LittleEndian::convert(value);
+}
+
+NumpyMapping::NumpyMapping(const std::string& filename) : _filename(filename), _data(nullptr), _size(0), _arrays() {
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd < 0) {
+		throw std::runtime_error("Unable to open "+filename);
+	}
+
+	struct stat info;
+	if(::fstat(fd, &info) != 0 || info.st_size == 0) {
+		::close(fd);
+		throw std::runtime_error("Unable to map "+filename+" (empty or unreadable file)");
+	}
+	_size = static_cast<size_t>(info.st_size);
+
+	// The mapping keeps its own reference on the file
+	void* data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if(data == MAP_FAILED) {
+		throw std::runtime_error("Unable to map "+filename);
+	}
+	_data = static_cast<const char*>(data);
+
+	// Inputs read their samples in order
+	::madvise(data, _size, MADV_SEQUENTIAL);
+
+	try {
+		if(_size >= sizeof(uint32_t) && _read<uint32_t>(0) == ZIP_FILE_MAGIC) {
+			_read_zip();
+		}
+		else {
+			_read_npy(0, "");
+		}
+	}
+	catch(...) {
+		::munmap(const_cast<char*>(_data), _size);
+		throw;
+	}
+}
+
+NumpyMapping::~NumpyMapping() {
+	::munmap(const_cast<char*>(_data), _size);
+}
+
+bool NumpyMapping::has(const std::string& name) const {
+	return _arrays.find(name) != std::end(_arrays);
+}
+
+const NumpyView& NumpyMapping::at(const std::string& name) const {
+	auto it = _arrays.find(name);
+	if(it == std::end(_arrays)) {
+		throw std::runtime_error("No array "+name+" in "+_filename);
+	}
+	return it->second;
+}
+
+const NumpyView& NumpyMapping::array() const {
+	return at("");
+}
+
+/**
+ * @brief Walks the local file headers of the archive, up to the central directory. The members have to be stored: a compressed
+ * member has no byte range to map.
+ */
+void NumpyMapping::_read_zip() {
+	size_t offset = 0;
+
+	while(offset+sizeof(uint32_t) <= _size) {
+		uint32_t magic = _read<uint32_t>(offset);
+
+		if(magic == ZIP_DICTIONNARY_MAGIC) {
+			return;
+		}
+		if(magic != ZIP_FILE_MAGIC) {
+			throw std::runtime_error("Bad file format : unknwon zip magic in "+_filename);
+		}
+
+		_check(offset, 30);
+		uint16_t general_flag = _read<uint16_t>(offset+6);
+		uint16_t compression_method = _read<uint16_t>(offset+8);
+		uint64_t compressed_size = _read<uint32_t>(offset+18);
+		uint64_t uncompressed_size = _read<uint32_t>(offset+22);
+		uint16_t name_length = _read<uint16_t>(offset+26);
+		uint16_t extra_field_length = _read<uint16_t>(offset+28);
+
+		_check(offset+30, name_length+extra_field_length);
+		std::string name(_data+offset+30, name_length);
+
+		// numpy always writes zip64 headers: the sizes are then in the extra field
+		bool zip64 = false;
+		size_t extra = offset+30+name_length;
+		size_t extra_end = extra+extra_field_length;
+		while(extra+4 <= extra_end) {
+			uint16_t id = _read<uint16_t>(extra);
+			uint16_t length = _read<uint16_t>(extra+2);
+			if(id == ZIP64_EXTRA_FIELD) {
+				zip64 = true;
+				size_t field = extra+4;
+				if(uncompressed_size == ZIP_SIZE_IN_ZIP64 && field+8 <= extra+4+length) {
+					uncompressed_size = _read<uint64_t>(field);
+					field += 8;
+				}
+				if(compressed_size == ZIP_SIZE_IN_ZIP64 && field+8 <= extra+4+length) {
+					compressed_size = _read<uint64_t>(field);
+				}
+			}
+			extra += 4+length;
+		}
+
+		if(compression_method != 0 || compressed_size != uncompressed_size) {
+			throw std::runtime_error("Unsupported compression method for "+name+" in "+_filename+" (use numpy.savez, not numpy.savez_compressed)");
+		}
+
+		size_t begin = extra_end;
+		size_t end = _read_npy(begin, name);
+
+		// Sizes only known after the data (streamed archive) are in a descriptor behind it
+		if(general_flag & ZIP_FLAG_DATA_DESCRIPTOR) {
+			if(end+sizeof(uint32_t) <= _size && _read<uint32_t>(end) == ZIP_DATA_DESCRIPTOR_MAGIC) {
+				end += 4;
+			}
+			end += zip64 ? 4+8+8 : 4+4+4;
+		}
+		else if(compressed_size != ZIP_SIZE_IN_ZIP64) {
+			end = begin+compressed_size;
+		}
+
+		offset = end;
+	}
+}
+
+/**
+ * @brief Parses the npy header at offset (format versions 1.0 to 3.0) and registers a view on its data.
+ * @return the offset of the end of the data.
+ */
+size_t NumpyMapping::_read_npy(size_t offset, const std::string& name) {
+	_check(offset, 10);
+
+	if(static_cast<uint8_t>(_data[offset]) != NPY_MAGIC_1 || std::string(_data+offset+1, 5) != NPY_MAGIC_2) {
+		throw std::runtime_error("Bad file format : "+(name.empty() ? _filename : name)+" is not a numpy file");
+	}
+
+	uint8_t major_version = static_cast<uint8_t>(_data[offset+6]);
+
+	size_t header_offset;
+	size_t header_length;
+	if(major_version == 1) {
+		header_length = _read<uint16_t>(offset+8);
+		header_offset = offset+10;
+	}
+	else if(major_version == 2 || major_version == 3) {
+		_check(offset, 12);
+		header_length = _read<uint32_t>(offset+8);
+		header_offset = offset+12;
+	}
+	else {
+		throw std::runtime_error("Unsupported npy version "+std::to_string(major_version));
+	}
+
+	_check(header_offset, header_length);
+	std::string header_str(_data+header_offset, header_length);
+
+	size_t cursor = 0;
+	std::unique_ptr<NumpyHeaderObject> header = NumpyHeaderObject::read(header_str, cursor);
+	NumpyHeaderMap& cast_header = dynamic_cast<NumpyHeaderMap&>(*header);
+
+	auto fortran_order = cast_header.value().find("fortran_order");
+	if(fortran_order != std::end(cast_header.value()) && dynamic_cast<NumpyHeaderBool&>(*fortran_order->second).value()) {
+		throw std::runtime_error("Unsupported fortran order in "+(name.empty() ? _filename : name));
+	}
+
+	NumpyHeaderTuple& shape = dynamic_cast<NumpyHeaderTuple&>(*cast_header.value().at("shape"));
+
+	std::vector<size_t> dimensions;
+	std::transform(std::begin(shape.value()), std::end(shape.value()), std::back_inserter(dimensions), [](const std::unique_ptr<NumpyHeaderObject>& element) {
+		return static_cast<size_t>(dynamic_cast<NumpyHeaderInt&>(*element).value());
+	});
+
+	std::string descr = dynamic_cast<NumpyHeaderString&>(*cast_header.value().at("descr")).value();
+	if(descr.size() < 2) {
+		throw std::runtime_error("unsupported format: "+descr);
+	}
+
+	char byte_order = descr.at(0);
+	std::string kind = descr.substr(1);
+
+	NumpyType type;
+	if(kind == "f4")
+		type = NUMPY_FLOAT32;
+	else if(kind == "f8")
+		type = NUMPY_FLOAT64;
+	else if(kind == "i4")
+		type = NUMPY_INT32;
+	else if(kind == "i8")
+		type = NUMPY_INT64;
+	else if(kind == "u1" || kind == "b1")
+		type = NUMPY_UINT8;
+	else
+		throw std::runtime_error("unsupported format: "+descr);
+
+	bool swap = (byte_order == '>' && ByteOrer::is_little_endian()) || (byte_order == '<' && ByteOrer::is_big_endian());
+
+	size_t data_offset = header_offset+header_length;
+	NumpyView view(_data+data_offset, dimensions, type, swap);
+
+	size_t data_length = view.size()*view.element_size();
+	_check(data_offset, data_length);
+
+	_arrays.erase(name);
+	_arrays.emplace(name, std::move(view));
+
+	return data_offset+data_length;
+}
+
+void NumpyMapping::_check(size_t offset, size_t length) const {
+	if(offset > _size || length > _size-offset) {
+		throw std::runtime_error("Bad file format : "+_filename+" is truncated");
+	}
+}
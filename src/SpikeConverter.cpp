@@ -1,4 +1,9 @@
 #include "SpikeConverter.h"
+#include <algorithm>
+#include <cstring>
+
+// Below this size the radix passes cost more than a comparison sort
+#define _SPIKE_CONVERTER_RADIX_THRESHOLD 256
 
 void SpikeConverter::to_spike(const Tensor<Time> &in, std::vector<Spike> &out)
 {
@@ -41,7 +46,7 @@ void SpikeConverter::to_spike(const Tensor<Time> &in, std::vector<Spike> &out)
 			}
 		}
 
-	std::sort(std::begin(out), std::end(out), TimeComparator());
+	sort(out);
 }
 
 void SpikeConverter::to_spike(const Tensor<Time> &in, std::vector<Spike> &out, size_t x_start, size_t y_start, size_t x_end, size_t y_end)
@@ -73,7 +78,7 @@ void SpikeConverter::to_spike(const Tensor<Time> &in, std::vector<Spike> &out, s
 							out.emplace_back(t, x - x_start, y - y_start, z, k);
 						}
 					}
-	std::sort(std::begin(out), std::end(out), TimeComparator());
+	sort(out);
 }
 
 void SpikeConverter::from_spike(const std::vector<Spike> &in, Tensor<Time> &out)
@@ -90,3 +95,73 @@ void SpikeConverter::from_spike(const std::vector<Spike> &in, Tensor<Time> &out)
 			out.at(spike.x, spike.y, spike.z, spike.k) = spike.time;
 		}
 }
+
+void SpikeConverter::sort(std::vector<Spike> &spikes)
+{
+	size_t n = spikes.size();
+	if (n < _SPIKE_CONVERTER_RADIX_THRESHOLD)
+	{
+		std::stable_sort(std::begin(spikes), std::end(spikes), TimeComparator());
+		return;
+	}
+
+	// Scratch buffers are kept per thread so that sorting a sample doesn't allocate
+	static thread_local std::vector<uint32_t> keys;
+	static thread_local std::vector<uint32_t> tmp_keys;
+	static thread_local std::vector<Spike> tmp_spikes;
+
+	keys.resize(n);
+	tmp_keys.resize(n);
+	tmp_spikes.assign(std::begin(spikes), std::end(spikes));
+
+	// Map the float bit pattern to an unsigned key with the same ordering
+	for (size_t i = 0; i < n; i++)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &spikes[i].time, sizeof(uint32_t));
+		keys[i] = bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+	}
+
+	std::vector<Spike> *src = &spikes;
+	std::vector<Spike> *dst = &tmp_spikes;
+	std::vector<uint32_t> *src_keys = &keys;
+	std::vector<uint32_t> *dst_keys = &tmp_keys;
+
+	for (size_t shift = 0; shift < 32; shift += 8)
+	{
+		size_t offsets[256] = {0};
+		for (size_t i = 0; i < n; i++)
+		{
+			offsets[((*src_keys)[i] >> shift) & 0xFF]++;
+		}
+
+		// All the keys share this digit, the pass would be the identity
+		if (offsets[((*src_keys)[0] >> shift) & 0xFF] == n)
+		{
+			continue;
+		}
+
+		size_t sum = 0;
+		for (size_t b = 0; b < 256; b++)
+		{
+			size_t count = offsets[b];
+			offsets[b] = sum;
+			sum += count;
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			size_t j = offsets[((*src_keys)[i] >> shift) & 0xFF]++;
+			(*dst)[j] = (*src)[i];
+			(*dst_keys)[j] = (*src_keys)[i];
+		}
+
+		std::swap(src, dst);
+		std::swap(src_keys, dst_keys);
+	}
+
+	if (src != &spikes)
+	{
+		std::copy(std::begin(*src), std::end(*src), std::begin(spikes));
+	}
+}
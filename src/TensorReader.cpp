@@ -1,17 +1,34 @@
 #include "TensorReader.h"
+#include "tool/Lz.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#define TENSOR_FILE_V1_MAGIC 0x234264FF
+#define TENSOR_FILE_V2_MAGIC 0x234265FF
+#define TENSOR_FILE_V2_FOOTER_SIZE (3*sizeof(uint64_t)+sizeof(uint32_t))
+
+static constexpr size_t NoBlock = std::numeric_limits<size_t>::max();
 
 TensorReader::TensorReader() :
-	_name(), _file(), _tensor_counter(0), _cursor(0), _sparse(false) {
+	_name(), _file(), _tensor_counter(0), _cursor(0), _sparse(false),
+	_version(1), _block_offsets(), _block_firsts(), _block(), _block_index(NoBlock), _block_cursor(0),
+	_ahead(), _ahead_next(0), _thread_number(1) {
 
 }
 
-TensorReader::TensorReader(const std::string& filename) :
-	_name(filename), _file(), _tensor_counter(0), _cursor(0), _sparse(false) {
+TensorReader::TensorReader(const std::string& filename, size_t thread_number) : TensorReader() {
+	_name = filename;
+	set_thread_number(thread_number);
 	open(filename);
 }
 
 TensorReader::TensorReader(TensorReader&& that) noexcept :
-	_name(that._name), _file(std::move(that._file)), _tensor_counter(that._tensor_counter), _cursor(that._cursor), _sparse(that._sparse) {
+	_name(that._name), _file(std::move(that._file)), _tensor_counter(that._tensor_counter), _cursor(that._cursor), _sparse(that._sparse),
+	_version(that._version), _block_offsets(std::move(that._block_offsets)), _block_firsts(std::move(that._block_firsts)),
+	_block(std::move(that._block)), _block_index(that._block_index), _block_cursor(that._block_cursor),
+	_ahead(std::move(that._ahead)), _ahead_next(that._ahead_next), _thread_number(that._thread_number) {
 
 }
 
@@ -41,6 +58,164 @@ bool TensorReader::has_next() const {
 }
 
 std::pair<std::string, Tensor<InputType>> TensorReader::next() {
+	std::pair<std::string, Tensor<InputType>> t = _version == 2 ? _next_v2() : _next_v1();
+	_cursor++;
+	return t;
+}
+
+void TensorReader::reset() {
+	_ahead.clear();
+	_ahead_next = 0;
+	_block.clear();
+	_block_index = NoBlock;
+	_block_cursor = 0;
+
+	_file.clear();
+	_file.seekg(0, std::ios::beg);
+	_cursor = 0;
+	_read_header();
+}
+
+void TensorReader::close() {
+	// Waits for the blocks being decoded
+	_ahead.clear();
+	if(_file.is_open()) {
+		_file.close();
+	}
+}
+
+size_t TensorReader::size() const {
+	return _tensor_counter;
+}
+
+/**
+ * @brief Moves to the tensor index: next() then returns it. A v2 file only decodes the block of the tensor, a v1 file is read from
+ * the beginning.
+ */
+void TensorReader::seek(size_t index) {
+	if(index > _tensor_counter) {
+		throw std::out_of_range("TensorReader: seek to "+std::to_string(index)+" in "+std::to_string(_tensor_counter)+" tensors");
+	}
+
+	if(_version != 2) {
+		if(index < _cursor) {
+			reset();
+		}
+		while(_cursor < index) {
+			next();
+		}
+		return;
+	}
+
+	if(index == _tensor_counter) {
+		_cursor = index;
+		_block.clear();
+		_block_cursor = 0;
+		_block_index = _block_offsets.size();
+		return;
+	}
+
+	size_t block = std::distance(std::begin(_block_firsts), std::upper_bound(std::begin(_block_firsts), std::end(_block_firsts), index))-1;
+	if(block == _block_index && index >= _cursor) {
+		// Forward in the current block
+	}
+	else if(block == _block_index) {
+		_block_cursor = 0;
+		_cursor = _block_firsts[block];
+	}
+	else {
+		_load_block(block);
+		_cursor = _block_firsts[block];
+	}
+
+	while(_cursor < index) {
+		_skip_v2();
+		_cursor++;
+	}
+}
+
+void TensorReader::set_thread_number(size_t thread_number) {
+	_ahead.clear();
+	_ahead_next = _block_index == NoBlock ? 0 : _block_index+1;
+	_thread_number = std::max<size_t>(thread_number, 1);
+}
+
+void TensorReader::_read_header() {
+	uint32_t magic = 0;
+	_file.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+
+	if(magic == TENSOR_FILE_V2_MAGIC) {
+		uint8_t flag = 0;
+		_file.read(reinterpret_cast<char*>(&flag), sizeof(uint8_t));
+		_sparse = (flag & 0x1) != 0;
+		_version = 2;
+		_read_index();
+	}
+	else if(magic == TENSOR_FILE_V1_MAGIC) { //v1
+		uint8_t flag = 0;
+		_file.read(reinterpret_cast<char*>(&flag), sizeof(uint8_t));
+		_sparse = (flag & 0x1) != 0;
+		uint32_t counter = 0;
+		_file.read(reinterpret_cast<char*>(&counter), sizeof(uint32_t));
+		_tensor_counter = counter;
+		_version = 1;
+	}
+	else { //v0
+		_tensor_counter = magic;
+		_version = 0;
+	}
+}
+
+void TensorReader::_read_index() {
+	_file.seekg(0, std::ios::end);
+	uint64_t file_size = _file.tellg();
+	if(file_size < sizeof(uint32_t)+sizeof(uint8_t)+TENSOR_FILE_V2_FOOTER_SIZE) {
+		throw std::runtime_error("Truncated tensor file "+_name);
+	}
+
+	_file.seekg(file_size-TENSOR_FILE_V2_FOOTER_SIZE, std::ios::beg);
+	uint64_t index_offset = 0;
+	uint64_t tensor_number = 0;
+	uint64_t block_number = 0;
+	uint32_t magic = 0;
+	_file.read(reinterpret_cast<char*>(&index_offset), sizeof(uint64_t));
+	_file.read(reinterpret_cast<char*>(&tensor_number), sizeof(uint64_t));
+	_file.read(reinterpret_cast<char*>(&block_number), sizeof(uint64_t));
+	_file.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+
+	if(magic != TENSOR_FILE_V2_MAGIC || index_offset+block_number*2*sizeof(uint64_t)+TENSOR_FILE_V2_FOOTER_SIZE != file_size) {
+		throw std::runtime_error("Bad tensor file index in "+_name+" (file not closed?)");
+	}
+
+	std::vector<uint64_t> index(2*block_number);
+	_file.seekg(index_offset, std::ios::beg);
+	_file.read(reinterpret_cast<char*>(index.data()), index.size()*sizeof(uint64_t));
+
+	_block_offsets.resize(block_number);
+	_block_firsts.resize(block_number);
+	for(size_t i=0; i<block_number; i++) {
+		_block_offsets[i] = index[2*i];
+		_block_firsts[i] = index[2*i+1];
+	}
+	_tensor_counter = tensor_number;
+
+	if(!_file.good()) {
+		throw std::runtime_error("Can't read the index of "+_name);
+	}
+}
+
+template<typename T>
+T TensorReader::_take() {
+	if(_block_cursor > _block.size() || sizeof(T) > _block.size()-_block_cursor) {
+		throw std::runtime_error("Corrupted tensor block in "+_name);
+	}
+	T value;
+	std::memcpy(&value, _block.data()+_block_cursor, sizeof(T));
+	_block_cursor += sizeof(T);
+	return value;
+}
+
+std::pair<std::string, Tensor<InputType>> TensorReader::_next_v1() {
 	uint8_t label_size = 0;
 	_file.read(reinterpret_cast<char*>(&label_size), sizeof(uint8_t));
 	char* label_buffer = new char[label_size];
@@ -75,38 +250,128 @@ std::pair<std::string, Tensor<InputType>> TensorReader::next() {
 		_file.read(reinterpret_cast<char*>(t.second.begin()), sizeof(float)*shape.product());
 	}
 
-	_cursor++;
+	return t;
+}
+
+std::pair<std::string, Tensor<InputType>> TensorReader::_next_v2() {
+	if(_block_index == NoBlock || _block_cursor >= _block.size()) {
+		_load_block(_block_index == NoBlock ? 0 : _block_index+1);
+	}
+
+	uint32_t label_size = _take<uint32_t>();
+	if(label_size > _block.size()-_block_cursor) {
+		throw std::runtime_error("Corrupted tensor block in "+_name);
+	}
+	std::string label(_block.data()+_block_cursor, label_size);
+	_block_cursor += label_size;
+
+	uint8_t dim_number = _take<uint8_t>();
+	std::vector<size_t> dims;
+	for(size_t i = 0; i<dim_number; i++) {
+		dims.push_back(_take<uint32_t>());
+	}
+	Shape shape(dims);
+	std::pair<std::string, Tensor<InputType>> t(label, shape);
+	size_t size = shape.product();
+
+	if(_sparse) {
+		uint32_t count = _take<uint32_t>();
+		if(count > size || 2*sizeof(uint32_t)*static_cast<size_t>(count) > _block.size()-_block_cursor) {
+			throw std::runtime_error("Corrupted tensor block in "+_name);
+		}
+		t.second.fill(0);
+		const char* indexes = _block.data()+_block_cursor;
+		const char* values = indexes+count*sizeof(uint32_t);
+		for(size_t k=0; k<count; k++) {
+			uint32_t index;
+			float value;
+			std::memcpy(&index, indexes+k*sizeof(uint32_t), sizeof(uint32_t));
+			std::memcpy(&value, values+k*sizeof(float), sizeof(float));
+			if(index >= size) {
+				throw std::runtime_error("Corrupted tensor block in "+_name);
+			}
+			t.second.at_index(index) = value;
+		}
+		_block_cursor += 2*sizeof(uint32_t)*count;
+	}
+	else {
+		if(sizeof(float)*size > _block.size()-_block_cursor) {
+			throw std::runtime_error("Corrupted tensor block in "+_name);
+		}
+		std::memcpy(t.second.begin(), _block.data()+_block_cursor, sizeof(float)*size);
+		_block_cursor += sizeof(float)*size;
+	}
 
 	return t;
 }
 
-void TensorReader::reset() {
-	_file.seekg(0, std::ios::beg);
-	_cursor = 0;
-	_read_header();
+void TensorReader::_skip_v2() {
+	uint32_t label_size = _take<uint32_t>();
+	_block_cursor += label_size;
+
+	uint8_t dim_number = _take<uint8_t>();
+	size_t size = 1;
+	for(size_t i = 0; i<dim_number; i++) {
+		size *= _take<uint32_t>();
+	}
+
+	_block_cursor += _sparse ? 2*sizeof(uint32_t)*_take<uint32_t>() : sizeof(float)*size;
 }
 
-void TensorReader::close() {
-	if(_file.is_open()) {
-		_file.close();
+/**
+ * @brief Makes block the current block, from the read-ahead queue when it was scheduled, then refills the queue with the following blocks.
+ */
+void TensorReader::_load_block(size_t block) {
+	if(block >= _block_offsets.size()) {
+		throw std::runtime_error("No more tensor in "+_name);
+	}
+
+	if(_ahead.empty() || _ahead_next-_ahead.size() != block) {
+		_ahead.clear();
+		_ahead_next = block;
+		_schedule();
 	}
+
+	_block = _ahead.front().get();
+	_ahead.pop_front();
+	_block_index = block;
+	_block_cursor = 0;
+
+	_schedule();
 }
 
-void TensorReader::_read_header() {
-	uint32_t magic = 0;
-	_file.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+void TensorReader::_schedule() {
+	while(_ahead.size() < _thread_number && _ahead_next < _block_offsets.size()) {
+		uint32_t raw_size = 0;
+		uint32_t stored_size = 0;
 
-	if(magic == 0x234264FF) { //v1
-		uint8_t flag = 0;
-		_file.read(reinterpret_cast<char*>(&flag), sizeof(uint8_t));
-		_sparse = (flag & 0x1) != 0;
-		uint32_t counter = 0;
-		_file.read(reinterpret_cast<char*>(&counter), sizeof(uint32_t));
-		_tensor_counter = counter;
+		_file.clear();
+		_file.seekg(_block_offsets[_ahead_next], std::ios::beg);
+		_file.read(reinterpret_cast<char*>(&raw_size), sizeof(uint32_t));
+		_file.read(reinterpret_cast<char*>(&stored_size), sizeof(uint32_t));
+
+		std::string stored(stored_size, '\0');
+		_file.read(&stored[0], stored_size);
+
+		if(!_file.good()) {
+			throw std::runtime_error("Can't read tensor block "+std::to_string(_ahead_next)+" of "+_name);
+		}
+
+		// The file is read on the calling thread, only the decoding runs in parallel
+		_ahead.push_back(std::async(_thread_number > 1 ? std::launch::async : std::launch::deferred, &TensorReader::_decode, std::move(stored), raw_size));
+		_ahead_next++;
 	}
-	else { //v0
-		_tensor_counter = magic;
+}
+
+std::vector<char> TensorReader::_decode(std::string stored, uint32_t raw_size) {
+	std::vector<char> raw(raw_size);
+	if(stored.size() == raw_size) {
+		std::copy(std::begin(stored), std::end(stored), std::begin(raw));
+	}
+	else {
+		tool::Lz::decompress(stored.data(), stored.size(), raw.data(), raw_size);
 	}
+	return raw;
 }
 
 std::string TensorReader::to_string() const {
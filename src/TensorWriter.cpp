@@ -1,37 +1,65 @@
 #include "TensorWriter.h"
+#include "tool/Lz.h"
 
-TensorWriter::TensorWriter() : _file(), _tensor_counter(0),_sparse(false) {
+#include <limits>
 
+#define TENSOR_FILE_V1_MAGIC 0x234264FF
+#define TENSOR_FILE_V2_MAGIC 0x234265FF
+
+template<typename T>
+static void append(std::string& buffer, T value) {
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
 }
 
-TensorWriter::TensorWriter(const std::string& filename, bool sparse) : TensorWriter() {
-	open(filename, sparse);
+TensorWriter::TensorWriter() : _file(), _tensor_counter(0), _sparse(false), _format(TENSOR_FILE_V1), _compress(false), _block_size(DefaultBlockSize),
+	_block(), _buffer(), _block_offsets(), _block_firsts(), _block_first(0) {
+
+}
+
+TensorWriter::TensorWriter(const std::string& filename, bool sparse, TensorFileFormat format, bool compress) : TensorWriter() {
+	open(filename, sparse, format, compress);
 }
 
 TensorWriter::~TensorWriter() {
 	close();
 }
 
-void TensorWriter::open(const std::string& filename, bool sparse) {
+void TensorWriter::open(const std::string& filename, bool sparse, TensorFileFormat format, bool compress) {
 	if(_file.is_open()) {
 		throw std::runtime_error("File already open");
 	}
 
 	_file.open(filename, std::ios::out | std::ios::trunc | std::ios::binary);
 	_sparse = sparse;
+	_format = format;
+	_compress = compress;
+	_tensor_counter = 0;
+	_block.clear();
+	_block_offsets.clear();
+	_block_firsts.clear();
+	_block_first = 0;
 
 	if(!_file.is_open()) {
 		throw std::runtime_error("Unable to open "+filename);
 	}
 
-	uint32_t v1_magic = 0x234264FF;
-	_file.write(reinterpret_cast<const char*>(&v1_magic), sizeof(uint32_t));
+	if(_format == TENSOR_FILE_V1) {
+		uint32_t v1_magic = TENSOR_FILE_V1_MAGIC;
+		_file.write(reinterpret_cast<const char*>(&v1_magic), sizeof(uint32_t));
 
-	uint8_t flag = (sparse ? 0x1 : 0x0);
-	_file.write(reinterpret_cast<const char*>(&flag), sizeof(uint8_t));
+		uint8_t flag = (sparse ? 0x1 : 0x0);
+		_file.write(reinterpret_cast<const char*>(&flag), sizeof(uint8_t));
 
-	uint32_t counter = 0;
-	_file.write(reinterpret_cast<const char*>(&counter), sizeof(uint32_t));
+		uint32_t counter = 0;
+		_file.write(reinterpret_cast<const char*>(&counter), sizeof(uint32_t));
+	}
+	else {
+		uint32_t v2_magic = TENSOR_FILE_V2_MAGIC;
+		_file.write(reinterpret_cast<const char*>(&v2_magic), sizeof(uint32_t));
+
+		uint8_t flag = (sparse ? 0x1 : 0x0) | (compress ? 0x2 : 0x0);
+		_file.write(reinterpret_cast<const char*>(&flag), sizeof(uint8_t));
+	}
 }
 
 void TensorWriter::write(const std::string& label, const Tensor<float>& t) {
@@ -39,47 +67,153 @@ void TensorWriter::write(const std::string& label, const Tensor<float>& t) {
 		throw std::runtime_error("No open file");
 	}
 
-	uint8_t label_size = label.size();
-	_file.write(reinterpret_cast<const char*>(&label_size), sizeof(uint8_t));
-	_file.write(label.c_str(), label_size);
+	if(_format == TENSOR_FILE_V1) {
+		_write_v1(label, t);
+	}
+	else {
+		_append_v2(label, t);
+	}
+
+	_tensor_counter++;
 
-	uint8_t dim_number = t.shape().number();
-	_file.write(reinterpret_cast<const char*>(&dim_number), sizeof(uint8_t));
-	for(size_t i = 0; i<dim_number; i++) {
-		uint16_t dim = t.shape().dim(i);
-		_file.write(reinterpret_cast<const char*>(&dim), sizeof(uint16_t));
+	if(_format == TENSOR_FILE_V2 && _block.size() >= _block_size) {
+		_flush_block();
+	}
+}
+
+void TensorWriter::close() {
+	if(!_file.is_open()) {
+		return;
+	}
+
+	if(_format == TENSOR_FILE_V1) {
+		_file.clear();
+		_file.seekp(sizeof(uint32_t)+sizeof(uint8_t), std::ios::beg);
+
+		uint32_t counter = _tensor_counter;
+		_file.write(reinterpret_cast<const char*>(&counter), sizeof(uint32_t));
+	}
+	else {
+		_flush_block();
+
+		uint64_t index_offset = _file.tellp();
+		std::string index;
+		for(size_t i=0; i<_block_offsets.size(); i++) {
+			append<uint64_t>(index, _block_offsets[i]);
+			append<uint64_t>(index, _block_firsts[i]);
+		}
+		append<uint64_t>(index, index_offset);
+		append<uint64_t>(index, _tensor_counter);
+		append<uint64_t>(index, _block_offsets.size());
+		append<uint32_t>(index, TENSOR_FILE_V2_MAGIC);
+		_file.write(index.data(), index.size());
+	}
+
+	_file.flush();
+	_file.close();
+}
+
+void TensorWriter::set_block_size(size_t block_size) {
+	if(block_size == 0 || block_size > std::numeric_limits<uint32_t>::max()) {
+		throw std::runtime_error("Invalid block size");
+	}
+	_block_size = block_size;
+}
+
+void TensorWriter::_write_v1(const std::string& label, const Tensor<float>& t) {
+	if(label.size() > std::numeric_limits<uint8_t>::max()) {
+		throw std::runtime_error("Label too long for the v1 tensor format: "+label);
+	}
+
+	_buffer.clear();
+
+	append<uint8_t>(_buffer, label.size());
+	_buffer.append(label);
+
+	append<uint8_t>(_buffer, t.shape().number());
+	for(size_t i = 0; i<t.shape().number(); i++) {
+		if(t.shape().dim(i) > std::numeric_limits<uint16_t>::max()) {
+			throw std::runtime_error("Dimension too large for the v1 tensor format: "+t.shape().to_string());
+		}
+		append<uint16_t>(_buffer, t.shape().dim(i));
 	}
 
 	if(_sparse) {
 		size_t size = t.shape().product();
 		for(uint32_t i=0; i<size; i++) {
 			if(t.at_index(i) != 0.0) {
-				 _file.write(reinterpret_cast<const char*>(&i), sizeof(uint32_t));
-				 float f = t.at_index(i);
-				 _file.write(reinterpret_cast<const char*>(&f), sizeof(float));
+				append<uint32_t>(_buffer, i);
+				append<float>(_buffer, t.at_index(i));
 			}
 		}
-		uint32_t eol = 0xFFFFFFFF;
-		_file.write(reinterpret_cast<const char*>(&eol), sizeof(uint32_t));
-
+		append<uint32_t>(_buffer, 0xFFFFFFFF);
+		_file.write(_buffer.data(), _buffer.size());
 	}
 	else {
+		_file.write(_buffer.data(), _buffer.size());
 		_file.write(reinterpret_cast<const char*>(t.begin()), sizeof(float)*t.shape().product());
 	}
+}
 
+void TensorWriter::_append_v2(const std::string& label, const Tensor<float>& t) {
+	append<uint32_t>(_block, label.size());
+	_block.append(label);
 
-	_file.flush();
-	_tensor_counter++;
+	append<uint8_t>(_block, t.shape().number());
+	for(size_t i = 0; i<t.shape().number(); i++) {
+		append<uint32_t>(_block, t.shape().dim(i));
+	}
+
+	size_t size = t.shape().product();
+	if(_sparse) {
+		// Indexes then values: each run compresses better than interleaved pairs
+		uint32_t count = 0;
+		for(size_t i=0; i<size; i++) {
+			if(t.at_index(i) != 0.0f)
+				count++;
+		}
+		append<uint32_t>(_block, count);
+		for(uint32_t i=0; i<size; i++) {
+			if(t.at_index(i) != 0.0f)
+				append<uint32_t>(_block, i);
+		}
+		for(size_t i=0; i<size; i++) {
+			if(t.at_index(i) != 0.0f)
+				append<float>(_block, t.at_index(i));
+		}
+	}
+	else {
+		_block.append(reinterpret_cast<const char*>(t.begin()), sizeof(float)*size);
+	}
+
+	if(_block.size() > std::numeric_limits<uint32_t>::max()) {
+		throw std::runtime_error("Tensor too large for the v2 tensor format");
+	}
 }
 
-void TensorWriter::close() {
-	if(_file.is_open()) {
-		_file.clear();
-		_file.seekp(sizeof(uint32_t)+sizeof(uint8_t), std::ios::beg);
+void TensorWriter::_flush_block() {
+	if(_block.empty()) {
+		return;
+	}
 
-		uint32_t counter = _tensor_counter;
-		_file.write(reinterpret_cast<const char*>(&counter), sizeof(uint32_t));
-		_file.flush();
-		_file.close();
+	_block_offsets.push_back(_file.tellp());
+	_block_firsts.push_back(_block_first);
+
+	const std::string* payload = &_block;
+	if(_compress) {
+		_buffer.clear();
+		tool::Lz::compress(_block.data(), _block.size(), _buffer);
+		// Blocks that don't shrink are stored as is
+		if(_buffer.size() < _block.size())
+			payload = &_buffer;
 	}
+
+	uint32_t raw_size = _block.size();
+	uint32_t stored_size = payload->size();
+	_file.write(reinterpret_cast<const char*>(&raw_size), sizeof(uint32_t));
+	_file.write(reinterpret_cast<const char*>(&stored_size), sizeof(uint32_t));
+	_file.write(payload->data(), payload->size());
+
+	_block.clear();
+	_block_first = _tensor_counter;
 }
@@ -1,5 +1,6 @@
 #include "analysis/Coherence.h"
 #include "Experiment.h"
+#include "Math.h"
 
 using namespace analysis;
 
@@ -19,116 +20,19 @@ void Coherence::process() {
 	if(experiment().process_at(layer_index()).has_parameter("w") && experiment().process_at(layer_index()).is_type<Tensor<float>>("w")) {
 		const Tensor<float>& w = experiment().process_at(layer_index()).parameter<Tensor<float>>("w").get();
 
-		if(w.shape().number() == 4) {
-
-			size_t width = w.shape().dim(0);
-			size_t height = w.shape().dim(1);
-			size_t depth = w.shape().dim(2);
-			size_t n = w.shape().dim(3);
-
+		if(w.shape().number() == 4 || w.shape().number() == 5) {
 			std::vector<float> list;
-
-			for(size_t i=0; i<n; i++) {
-				for(size_t j=i+1; j<n;j++) {
-					float value = 0;
-					float ni = 0;
-					float nj = 0;
-
-					for(size_t x=0; x<width; x++) {
-						for(size_t y=0; y<height; y++) {
-							for(size_t z=0; z<depth; z++) {
-								value += w.at(x, y, z, i)*w.at(x, y, z, j);
-								ni += w.at(x, y, z, i)*w.at(x, y, z, i);
-								nj += w.at(x, y, z, j)*w.at(x, y, z, j);
-							}
-						}
-					}
-					list.push_back(value / (std::numeric_limits<float>::epsilon() + std::sqrt(ni) * std::sqrt(nj)));
-
-				}
-			}
+			_coherence(w, list);
 
 			std::sort(std::begin(list), std::end(list));
 
 			// Mean weights
-			float mean_w = 0;
-			for(size_t i=0; i<n; i++) {
-				for(size_t x=0; x<width; x++) {
-					for(size_t y=0; y<height; y++) {
-						for(size_t z=0; z<depth; z++) {
-							mean_w += w.at(x, y, z, i);
-						}
-					}
-				}
-			}
-			mean_w = mean_w / w.shape().product();
+			float mean_w = std::accumulate(w.begin(), w.end(), 0.0f) / w.shape().product();
 
 			experiment().log() << "Mean weights: " << mean_w << std::endl;
 			experiment().log() << "------" << std::endl;
 			experiment().log() << "N: " << list.size() << std::endl;
-			experiment().log() << "Min: " << list.front() << std::endl;
-			experiment().log() << "Q1: " << list.at(std::min(list.size() - 1, (list.size() * 1) / 4)) << std::endl;
-			experiment().log() << "Q2: " << list.at(std::min(list.size() - 1, (list.size() * 2) / 4)) << std::endl;
-			experiment().log() << "Q3: " << list.at(std::min(list.size() - 1, (list.size() * 3) / 4)) << std::endl;
-			experiment().log() << "Max: " << list.back() << std::endl;
-		}
-		else if (w.shape().number() == 5)
-		{
-
-			size_t width = w.shape().dim(0);
-			size_t height = w.shape().dim(1);
-			size_t depth = w.shape().dim(2);
-			size_t n = w.shape().dim(3);
-			size_t conv_depth = w.shape().dim(4);
-
-			std::vector<float> list;
-
-			for (size_t i = 0; i < n; i++)
-			{
-				for (size_t j = i + 1; j < n; j++)
-				{
-					float value = 0;
-					float ni = 0;
-					float nj = 0;
-
-					for (size_t x = 0; x < width; x++)
-					{
-						for (size_t y = 0; y < height; y++)
-						{
-							for (size_t z = 0; z < depth; z++)
-							{
-								for (size_t k = 0; k < conv_depth; k++)
-								{
-									value += w.at(x, y, z, i, k) * w.at(x, y, z, j, k);
-									ni += w.at(x, y, z, i, k) * w.at(x, y, z, i, k);
-									nj += w.at(x, y, z, j, k) * w.at(x, y, z, j, k);
-								}
-							}
-						}
-
-						list.push_back(value / (std::numeric_limits<float>::epsilon() + std::sqrt(ni) * std::sqrt(nj)));
-					}
-				}
-
-				std::sort(std::begin(list), std::end(list));
-
-			// Mean weights
-			float mean_w = 0;
-			for(size_t i=0; i<n; i++) {
-				for(size_t x=0; x<width; x++) {
-					for(size_t y=0; y<height; y++) {
-						for(size_t z=0; z<depth; z++) {
-							for(size_t k=0; k<conv_depth; k++) {
-								mean_w += w.at(x, y, z, i,k);
-							}
-						}
-					}
-				}
-			}
-			mean_w = mean_w / w.shape().product();
-			experiment().log() << "Mean weights: " << mean_w << std::endl;
-			experiment().log() << "------" << std::endl;
-				experiment().log() << "N: " << list.size() << std::endl;
+			if(!list.empty()) {
 				experiment().log() << "Min: " << list.front() << std::endl;
 				experiment().log() << "Q1: " << list.at(std::min(list.size() - 1, (list.size() * 1) / 4)) << std::endl;
 				experiment().log() << "Q2: " << list.at(std::min(list.size() - 1, (list.size() * 2) / 4)) << std::endl;
@@ -147,3 +51,41 @@ void Coherence::process() {
 
 	experiment().log() << std::endl;
 }
+
+/**
+ * @brief Cosine similarity of every pair of filters, taken from the Gram matrix of the flattened filters computed by a single
+ * cblas_ssyrk. The norms are the square roots of its diagonal.
+ * In the 4D layout (x, y, z, filter), the weights are already a (x*y*z) x filter matrix. In the 5D layout (x, y, z, filter, k),
+ * the temporal depth is interleaved with the filters, so the weights are first packed one filter per row.
+ */
+void Coherence::_coherence(const Tensor<float>& w, std::vector<float>& list) {
+	size_t n = w.shape().dim(3);
+	size_t conv_depth = w.shape().number() == 5 ? w.shape().dim(4) : 1;
+	size_t rows = w.shape().dim(0)*w.shape().dim(1)*w.shape().dim(2);
+	size_t filter_size = rows*conv_depth;
+
+	std::vector<float> gram(n*n);
+
+	if(conv_depth == 1) {
+		cblas_ssyrk(CblasRowMajor, CblasUpper, CblasTrans, n, rows, 1.0, w.begin(), n, 0.0, gram.data(), n);
+	}
+	else {
+		std::vector<float> filters(n*filter_size);
+		const float* data = w.begin();
+		for(size_t r=0; r<rows; r++) {
+			for(size_t i=0; i<n; i++) {
+				std::copy(data+(r*n+i)*conv_depth, data+(r*n+i+1)*conv_depth, filters.data()+i*filter_size+r*conv_depth);
+			}
+		}
+		cblas_ssyrk(CblasRowMajor, CblasUpper, CblasNoTrans, n, filter_size, 1.0, filters.data(), filter_size, 0.0, gram.data(), n);
+	}
+
+	list.clear();
+	list.reserve(n*(n-1)/2);
+	for(size_t i=0; i<n; i++) {
+		float ni = std::sqrt(gram[i*n+i]);
+		for(size_t j=i+1; j<n; j++) {
+			list.push_back(gram[i*n+j] / (std::numeric_limits<float>::epsilon() + ni * std::sqrt(gram[j*n+j])));
+		}
+	}
+}
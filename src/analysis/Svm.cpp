@@ -1,35 +1,48 @@
 #include "analysis/Svm.h"
 
 #include "Experiment.h"
+#include <execution>
 
 using namespace analysis;
 
 static RegisterClassParameter<Svm, AnalysisFactory> _register("Svm");
 
 Svm::Svm() : TwoPassAnalysis(_register),
-			 _c(0), _label_index(), _size(0), _node_count(0), _sample_count(0),
-			 _problem(), _model(nullptr), _train_nodes(nullptr), _test_nodes(nullptr),
+			 _c(0), _solver(SolverLibsvm), _label_index(), _size(0), _node_count(0), _sample_count(0), _draw(0),
+			 _problem(), _model(nullptr), _train_nodes(), _train_offsets(), _train_labels(), _train_samples(),
+			 _linear(), _train_problem(), _test_problem(), _c_path(), _fold_number(0), _path_models(),
 			 _correct_sample(0), _total_sample(0)
 {
 
 	add_parameter("c", _c, 1.0f);
+	add_parameter("solver", _solver, static_cast<uint32_t>(SolverLibsvm));
 
 	_problem.l = 0;
 	_problem.x = nullptr;
 	_problem.y = nullptr;
 }
 
-Svm::Svm(const size_t &draw) : TwoPassAnalysis(_register),
-							   _draw(draw), _c(0), _label_index(), _size(0), _node_count(0), _sample_count(0),
-							   _problem(), _model(nullptr), _train_nodes(nullptr), _test_nodes(nullptr),
-							   _correct_sample(0), _total_sample(0)
+Svm::Svm(const size_t &draw, uint32_t solver) : Svm()
 {
+	if (solver > SolverLinear)
+		throw std::runtime_error("Unknown svm solver " + std::to_string(solver));
 
-	add_parameter("c", _c, 1.0f);
+	_draw = draw;
+	parameter<uint32_t>("solver").set(solver);
+}
 
-	_problem.l = 0;
-	_problem.x = nullptr;
-	_problem.y = nullptr;
+Svm::Svm(const std::vector<float>& c_path, size_t fold_number, const size_t &draw) : Svm(draw, SolverLinear)
+{
+	if(c_path.empty())
+		throw std::runtime_error("Svm: empty C path");
+
+	if(std::any_of(std::begin(c_path), std::end(c_path), [](float c) { return c <= 0; }))
+		throw std::runtime_error("Svm: C values must be positive");
+
+	// Increasing C relaxes the box constraint of the dual, so the previous solution stays feasible
+	_c_path = c_path;
+	std::sort(std::begin(_c_path), std::end(_c_path));
+	_fold_number = fold_number;
 }
 
 void Svm::resize(const Shape& shape) {
@@ -39,69 +52,101 @@ void Svm::resize(const Shape& shape) {
 	_label_index.clear();
 }
 
+/**
+ * @brief The first pass only registers the labels, the non-zero features are extracted once, in process_train().
+ */
 void Svm::compute(const std::string& label, const Tensor<float>& sample) {
-	if(_label_index.find(label) == std::end(_label_index)) {
-		_label_index.emplace(label, _label_index.size());
-	}
-
-	for(size_t j=0; j<_size; j++) {
-		if(sample.at_index(j) != 0.0) {
-			_node_count++;
-		}
-	}
-	_node_count++;
-	_sample_count++;
-
-	//draw_progress(_sample_count, get_train_count());
+	_register_sample(label);
 
 	if (_draw == 1)
-	{
-		std::string _file_path = std::filesystem::current_path();
-		std::string _expName = experiment().name();
-		//TODO: find layer index.
-		std::string _LayerIndex = std::to_string(0);
-		std::filesystem::create_directories(_file_path + "/ExtractedFeatures/SVM/" + _expName + "_" + _LayerIndex + "/");
-		SaveWeights(_file_path + "/ExtractedFeatures/SVM/" + _expName + "_" + _LayerIndex + "/" + _expName + "_" + _LayerIndex + ".json", label, sample);
-		// Tensor<float>::draw_feature_tensor(_file_path + "/ExtractedFeatures/SVM/" + _expName + "_" + _LayerIndex + "/" + _expName + "_" + _LayerIndex + "_" + std::to_string(_sample_count) + "_", sample);
-		Tensor<float>::draw_tensor(_file_path + "/ExtractedFeatures/SVM/" + _expName + "_" + _LayerIndex + "/" + _expName + "_" + _LayerIndex + "_" + std::to_string(_sample_count) + "_", sample);
-	}
+		_draw_sample(label, sample);
 }
 
 void Svm::before_train() {
-	_train_nodes = new struct svm_node[_node_count];
-	_test_nodes = new struct svm_node[_size];
-
-	_problem.l = _sample_count;
-	_problem.y = new double[_sample_count];
-	_problem.x = new struct svm_node*[_sample_count];
+	_train_problem.clear();
+	_train_nodes.clear();
+	_train_offsets.clear();
+	_train_labels.clear();
+
+	// _node_count is only known when the samples were given in sparse form, otherwise the buffers grow as needed
+	if(_solver == SolverLinear) {
+		_train_problem.reserve(_sample_count, _node_count);
+	}
+	else {
+		_train_nodes.reserve(_node_count+_sample_count);
+		_train_offsets.reserve(_sample_count);
+		_train_labels.reserve(_sample_count);
+	}
 
 	_sample_count = 0;
 	_node_count = 0;
-
 }
 
 void Svm::process_train(const std::string& label, const Tensor<float>& sample) {
-	_problem.y[_sample_count] = _label_index[label];
-	_problem.x[_sample_count] = _train_nodes+_node_count;
-
 	for(size_t j=0; j<_size; j++) {
 		float v = sample.at_index(j);
 
 		if(v != 0.0) {
-			_train_nodes[_node_count].index = j+1;
-			_train_nodes[_node_count].value = v;
-			_node_count++;
+			_add_train_value(j, v);
 		}
+	}
+	_end_train_sample(label);
+}
+
+/**
+ * @brief Builds the training set straight from the (index, value) pairs of the sparse samples, without rebuilding the dense
+ * tensors, so the memory of the training set scales with the number of non-zero features.
+ * Samples whose default value is not 0 are densified, their non-default entries are not the non-zero features.
+ */
+void Svm::process_train_sparse_sample(const std::string& label, const SparseTensor<float>& sample, size_t current_pass) {
+	if(sample.default_value() != 0.0) {
+		Analysis::process_train_sparse_sample(label, sample, current_pass);
+		return;
+	}
 
+	if(sample.shape().product() != _size)
+		throw std::runtime_error("Svm: unexpected sample shape " + sample.shape().to_string());
 
+	if(current_pass == 0) {
+		_register_sample(label);
+		_node_count += sample.values().size();
+
+		if (_draw == 1)
+			_draw_sample(label, from_sparse_tensor(sample));
+		return;
 	}
-	_train_nodes[_node_count].index = -1;
-	_node_count++;
 
-	_sample_count++;
+	for(const std::pair<uint32_t, float>& value : sample.values()) {
+		if(value.second != 0.0) {
+			_add_train_value(value.first, value.second);
+		}
+	}
+	_end_train_sample(label);
 }
 
 void Svm::after_train() {
+	if(_solver == SolverLinear) {
+		if(_c_path.empty()) {
+			experiment().print() << "Train linear svm" << std::endl;
+			_linear.train(_train_problem, _size, _label_index.size(), _c);
+		}
+		else {
+			_search_c();
+		}
+		_train_problem.clear();
+		return;
+	}
+
+	// The nodes are not moved anymore, the sample pointers can be taken
+	_train_samples.resize(_train_offsets.size());
+	for(size_t i=0; i<_train_offsets.size(); i++) {
+		_train_samples[i] = _train_nodes.data()+_train_offsets[i];
+	}
+
+	_problem.l = _train_samples.size();
+	_problem.y = _train_labels.data();
+	_problem.x = _train_samples.data();
+
 	struct svm_parameter parameters;
 
 	parameters.svm_type = C_SVC;
@@ -127,48 +172,303 @@ void Svm::after_train() {
 void Svm::before_test() {
 	_correct_sample = 0;
 	_total_sample = 0;
-
+	_test_problem.clear();
 }
 
+/**
+ * @brief The test samples are only collected here, they are predicted together in after_test().
+ */
 void Svm::process_test(const std::string& label, const Tensor<float>& sample) {
-	size_t node_cursor = 0;
 	for(size_t j=0; j<_size; j++) {
 		float v = sample.at_index(j);
 
 		if(v != 0.0) {
-			_test_nodes[node_cursor].index = j+1;
-			_test_nodes[node_cursor].value = v;
-			node_cursor++;
+			_test_problem.add_value(j, v);
 		}
 	}
-	_test_nodes[node_cursor].index = -1;
 
-	double y_pred = ::svm_predict(_model, _test_nodes);
+	_test_problem.end_sample(_test_label(label));
+}
+
+void Svm::process_test_sparse_sample(const std::string& label, const SparseTensor<float>& sample) {
+	if(sample.default_value() != 0.0) {
+		Analysis::process_test_sparse_sample(label, sample);
+		return;
+	}
+
+	if(sample.shape().product() != _size)
+		throw std::runtime_error("Svm: unexpected sample shape " + sample.shape().to_string());
 
+	for(const std::pair<uint32_t, float>& value : sample.values()) {
+		if(value.second != 0.0) {
+			_test_problem.add_value(value.first, value.second);
+		}
+	}
+
+	_test_problem.end_sample(_test_label(label));
+}
+
+void Svm::_register_sample(const std::string& label) {
+	if(_label_index.find(label) == std::end(_label_index)) {
+		_label_index.emplace(label, _label_index.size());
+	}
+
+	_sample_count++;
+
+	//draw_progress(_sample_count, get_train_count());
+}
+
+void Svm::_draw_sample(const std::string& label, const Tensor<float>& sample) {
+	std::string _file_path = std::filesystem::current_path();
+	std::string _expName = experiment().name();
+	//TODO: find layer index.
+	std::string _LayerIndex = std::to_string(0);
+	std::filesystem::create_directories(_file_path + "/ExtractedFeatures/SVM/" + _expName + "_" + _LayerIndex + "/");
+	SaveWeights(_file_path + "/ExtractedFeatures/SVM/" + _expName + "_" + _LayerIndex + "/" + _expName + "_" + _LayerIndex + ".json", label, sample);
+	// Tensor<float>::draw_feature_tensor(_file_path + "/ExtractedFeatures/SVM/" + _expName + "_" + _LayerIndex + "/" + _expName + "_" + _LayerIndex + "_" + std::to_string(_sample_count) + "_", sample);
+	Tensor<float>::draw_tensor(_file_path + "/ExtractedFeatures/SVM/" + _expName + "_" + _LayerIndex + "/" + _expName + "_" + _LayerIndex + "_" + std::to_string(_sample_count) + "_", sample);
+}
+
+/**
+ * @brief Appends a non-zero feature to the current training sample, in the format of the selected solver:
+ * a CSR row for the linear solver, a 1-based svm_node for libsvm.
+ */
+void Svm::_add_train_value(uint32_t index, float value) {
+	if(_solver == SolverLinear) {
+		_train_problem.add_value(index, value);
+		return;
+	}
+
+	if(_train_offsets.size() == _train_labels.size()) {
+		_train_offsets.push_back(_train_nodes.size());
+	}
+
+	svm_node node;
+	node.index = index+1;
+	node.value = value;
+	_train_nodes.push_back(node);
+}
+
+void Svm::_end_train_sample(const std::string& label) {
+	if(_solver == SolverLinear) {
+		_train_problem.end_sample(static_cast<size_t>(_label_index[label]));
+		_sample_count++;
+		return;
+	}
+
+	if(_train_offsets.size() == _train_labels.size()) {
+		_train_offsets.push_back(_train_nodes.size());
+	}
+
+	svm_node end;
+	end.index = -1;
+	end.value = 0;
+	_train_nodes.push_back(end);
+	_train_labels.push_back(_label_index[label]);
+
+	_sample_count++;
+}
+
+size_t Svm::_test_label(const std::string& label) const {
 	auto it = _label_index.find(label);
+	return it != std::end(_label_index) ? static_cast<size_t>(it->second) : std::numeric_limits<size_t>::max();
+}
+
+/**
+ * @brief Predicts the collected test set. The linear solver evaluates it as a sparse matrix product, the libsvm model is
+ * evaluated sample by sample over blocks processed in parallel.
+ */
+void Svm::_predict(std::vector<size_t>& predictions) const {
+	if(_solver == SolverLinear) {
+		_linear.predict(_test_problem, predictions);
+		return;
+	}
+
+	constexpr size_t BlockSize = 64;
+
+	size_t l = _test_problem.sample_number();
+	predictions.resize(l);
+
+	std::vector<size_t> blocks((l+BlockSize-1)/BlockSize);
+	std::iota(std::begin(blocks), std::end(blocks), 0);
+	std::for_each(std::execution::par, std::begin(blocks), std::end(blocks), [&](size_t block) {
+		std::vector<svm_node> nodes;
+		for(size_t i=block*BlockSize; i<std::min(l, (block+1)*BlockSize); i++) {
+			nodes.clear();
+			for(size_t j=_test_problem.offsets[i]; j<_test_problem.offsets[i+1]; j++) {
+				svm_node node;
+				node.index = _test_problem.indexes[j]+1;
+				node.value = _test_problem.values[j];
+				nodes.push_back(node);
+			}
+			svm_node end;
+			end.index = -1;
+			end.value = 0;
+			nodes.push_back(end);
+
+			predictions[i] = static_cast<size_t>(::svm_predict(_model, nodes.data()));
+		}
+	});
+}
+
+/**
+ * @brief Evaluates the C values of the path on data held out of the training set: k-fold cross-validation with 2 or more folds,
+ * otherwise a single validation fold of 1/HoldoutFoldNumber of the samples. The best C is then trained on the whole training set.
+ * Without cross-validation the whole path is kept, so that after_test() can log the test rate of each C, for information only.
+ */
+void Svm::_search_c() {
+	_path_models.clear();
+
+	bool holdout = _fold_number < 2;
+	size_t fold_number = holdout ? HoldoutFoldNumber : _fold_number;
+
+	experiment().print() << (holdout ? "Validate" : "Cross-validate") << " linear svm path" << std::endl;
+
+	std::vector<size_t> correct_samples;
+	size_t validation_sample_number = 0;
+	_cross_validate(fold_number, holdout ? 1 : fold_number, correct_samples, validation_sample_number);
+
+	if(holdout) {
+		experiment().log() << "===SVM C path (validation on 1/" << fold_number << " of the training set)===" << std::endl;
+	}
+	else {
+		experiment().log() << "===SVM C path (" << fold_number << "-fold cross-validation)===" << std::endl;
+	}
+	size_t best = 0;
+	for(size_t i=0; i<_c_path.size(); i++) {
+		experiment().log() << "c=" << _c_path[i] << ": " <<
+							 (static_cast<float>(correct_samples[i])/static_cast<float>(std::max<size_t>(validation_sample_number, 1))*100.0) << "% (" <<
+							 correct_samples[i] << "/" << validation_sample_number << ")" << std::endl;
+		if(correct_samples[i] > correct_samples[best]) {
+			best = i;
+		}
+	}
+	_c = _c_path[best];
+	experiment().log() << "best c: " << _c << std::endl;
+	experiment().log() << std::endl;
+
+	if(!holdout) {
+		experiment().print() << "Train linear svm" << std::endl;
+		_linear.train(_train_problem, _size, _label_index.size(), _c);
+		return;
+	}
+
+	experiment().print() << "Train linear svm path" << std::endl;
+
+	tool::LinearSvm model;
+	for(float c : _c_path) {
+		model.train(_train_problem, _size, _label_index.size(), c, true);
+		_path_models.push_back(model);
+	}
+	_linear = _path_models[best];
+}
+
+/**
+ * @brief Counts, for each C of the path, the validation samples correctly classified over the first evaluated_fold_number
+ * of fold_number folds. The samples of each class are dealt to the folds in turn, which keeps the classes balanced whatever
+ * the order of the dataset. Each fold is trained along the whole path with warm starts, the folds are processed in parallel.
+ */
+void Svm::_cross_validate(size_t fold_number, size_t evaluated_fold_number, std::vector<size_t>& correct_samples, size_t& validation_sample_number) const {
+	size_t l = _train_problem.sample_number();
+
+	std::vector<size_t> sample_folds(l);
+	std::vector<size_t> class_counts(_label_index.size(), 0);
+	for(size_t i=0; i<l; i++) {
+		sample_folds[i] = class_counts[_train_problem.labels[i]]++ % fold_number;
+	}
+
+	std::vector<std::vector<size_t>> fold_correct_samples(evaluated_fold_number, std::vector<size_t>(_c_path.size(), 0));
+
+	std::vector<size_t> folds(evaluated_fold_number);
+	std::iota(std::begin(folds), std::end(folds), 0);
+	std::for_each(std::execution::par, std::begin(folds), std::end(folds), [&](size_t fold) {
+		tool::LinearSvm::Problem train;
+		tool::LinearSvm::Problem validation;
+		for(size_t i=0; i<l; i++) {
+			(sample_folds[i] == fold ? validation : train).add_sample(_train_problem, i);
+		}
+
+		tool::LinearSvm model;
+		std::vector<size_t> predictions;
+		for(size_t i=0; i<_c_path.size(); i++) {
+			model.train(train, _size, _label_index.size(), _c_path[i], true);
+			model.predict(validation, predictions);
+			for(size_t j=0; j<predictions.size(); j++) {
+				if(predictions[j] == validation.labels[j]) {
+					fold_correct_samples[fold][i]++;
+				}
+			}
+		}
+	});
+
+	correct_samples.assign(_c_path.size(), 0);
+	for(const std::vector<size_t>& fold_correct : fold_correct_samples) {
+		for(size_t i=0; i<_c_path.size(); i++) {
+			correct_samples[i] += fold_correct[i];
+		}
+	}
 
-	if(it != std::end(_label_index) && y_pred == it->second) {
-		_correct_sample++;
+	validation_sample_number = 0;
+	for(size_t i=0; i<l; i++) {
+		if(sample_folds[i] < evaluated_fold_number) {
+			validation_sample_number++;
+		}
 	}
-	_total_sample++;
+}
+
+size_t Svm::_count_correct(const std::vector<size_t>& predictions) const {
+	size_t correct = 0;
+	for(size_t i=0; i<predictions.size(); i++) {
+		if(predictions[i] == _test_problem.labels[i]) {
+			correct++;
+		}
+	}
+	return correct;
+}
+
+float Svm::classification_rate() const {
+	return _total_sample > 0 ? static_cast<float>(_correct_sample)/static_cast<float>(_total_sample) : 0.0f;
 }
 
 void Svm::after_test() {
+	std::vector<size_t> predictions;
+
+	// The C was chosen on the training set, the test rates of the path are only logged
+	if(!_path_models.empty()) {
+		experiment().log() << "===SVM C path (test set, not used to choose c)===" << std::endl;
+		for(size_t i=0; i<_path_models.size(); i++) {
+			_path_models[i].predict(_test_problem, predictions);
+			size_t correct = _count_correct(predictions);
+			experiment().log() << "c=" << _c_path[i] << ": " <<
+								 (static_cast<float>(correct)/static_cast<float>(predictions.size())*100.0) << "% (" <<
+								 correct << "/" << predictions.size() << ")" << std::endl;
+		}
+		_path_models.clear();
+		experiment().log() << std::endl;
+	}
+
+	_predict(predictions);
+
+	_correct_sample += _count_correct(predictions);
+	_total_sample += predictions.size();
+
 	experiment().log() << "===SVM===" << std::endl;
 	experiment().log() << "classification rate: " <<
 						 (static_cast<float>(_correct_sample)/static_cast<float>(_total_sample)*100.0) << "% (" <<
 						 _correct_sample << "/" << _total_sample << ")" << std::endl;
 	experiment().log() << std::endl;
 
-	delete[] _problem.y;
-	_problem.y = nullptr;
-	delete[] _problem.x;
-	_problem.x = nullptr;
-	delete[] _train_nodes;
-	_train_nodes = nullptr;
-	delete[] _test_nodes;
-	_test_nodes = nullptr;
-
+	// The libsvm model points to the training nodes, they are released after it
 	svm_free_and_destroy_model(&_model);
 	_model = nullptr;
+
+	_problem.l = 0;
+	_problem.y = nullptr;
+	_problem.x = nullptr;
+	std::vector<svm_node>().swap(_train_nodes);
+	std::vector<size_t>().swap(_train_offsets);
+	std::vector<double>().swap(_train_labels);
+	std::vector<svm_node*>().swap(_train_samples);
+	_train_problem.clear();
+	_test_problem.clear();
 }
@@ -0,0 +1,273 @@
+#include "dataset/Synthetic.h"
+#include "Spike.h"
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+using namespace dataset;
+
+// Streams of the seeds, so that a class template and a sample never share their random sequence
+static constexpr uint32_t ClassStream = 0;
+static constexpr uint32_t SampleStream = 1;
+
+static std::default_random_engine random_engine(uint32_t seed, uint32_t stream, size_t index) {
+	std::seed_seq seed_seq{seed, stream, static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32)};
+	return std::default_random_engine(seed_seq);
+}
+
+static void check_parameters(size_t class_number, float sparsity) {
+	if(class_number == 0) {
+		throw std::runtime_error("Synthetic dataset: class_number should be > 0");
+	}
+	if(sparsity < 0.0f || sparsity > 1.0f) {
+		throw std::runtime_error("Synthetic dataset: sparsity should be in [0, 1]");
+	}
+}
+
+//
+//	SyntheticImage
+//
+
+SyntheticImage::SyntheticImage(size_t width, size_t height, size_t depth, size_t class_number, size_t sample_number,
+							   float sparsity, uint32_t sample_seed, uint32_t class_seed, float noise) :
+	_shape({width, height, depth, 1}), _class_number(class_number), _sample_number(sample_number), _sparsity(sparsity),
+	_sample_seed(sample_seed), _class_seed(class_seed), _noise(noise), _cursor(0), _templates() {
+
+	check_parameters(class_number, sparsity);
+
+	std::bernoulli_distribution on(1.0f-_sparsity);
+	std::uniform_real_distribution<InputType> intensity(0.5f, 1.0f);
+
+	for(size_t c=0; c<_class_number; c++) {
+		std::default_random_engine random = random_engine(_class_seed, ClassStream, c);
+		_templates.emplace_back(_shape);
+		for(size_t i=0; i<_shape.product(); i++) {
+			_templates.back().at_index(i) = on(random) ? intensity(random) : 0.0f;
+		}
+	}
+}
+
+bool SyntheticImage::has_next() const {
+	return _cursor < _sample_number;
+}
+
+std::pair<std::string, Tensor<InputType>> SyntheticImage::next() {
+	size_t label = _cursor % _class_number;
+	std::pair<std::string, Tensor<InputType>> out(std::to_string(label), _shape);
+
+	std::default_random_engine random = random_engine(_sample_seed, SampleStream, _cursor);
+	std::bernoulli_distribution redraw(_noise);
+	std::bernoulli_distribution on(1.0f-_sparsity);
+	std::uniform_real_distribution<InputType> intensity(0.5f, 1.0f);
+
+	const Tensor<InputType>& pattern = _templates[label];
+	for(size_t i=0; i<_shape.product(); i++) {
+		out.second.at_index(i) = redraw(random) ? (on(random) ? intensity(random) : 0.0f) : pattern.at_index(i);
+	}
+
+	_cursor++;
+
+	return out;
+}
+
+void SyntheticImage::reset() {
+	_cursor = 0;
+}
+
+void SyntheticImage::close() {
+
+}
+
+size_t SyntheticImage::size() const {
+	return _sample_number;
+}
+
+std::string SyntheticImage::to_string() const {
+	return "SyntheticImage(" + _shape.to_string() + ", " + std::to_string(_class_number) + " classes, seed " + std::to_string(_sample_seed) + ")[" + std::to_string(size()) + "]";
+}
+
+const Shape& SyntheticImage::shape() const {
+	return _shape;
+}
+
+//
+//	SyntheticVideo
+//
+
+SyntheticVideo::SyntheticVideo(size_t width, size_t height, size_t depth, size_t frame_number, size_t class_number, size_t sample_number,
+							   float sparsity, uint32_t sample_seed, size_t blob_number) :
+	_shape({width, height, depth, frame_number}), _class_number(class_number), _sample_number(sample_number), _sparsity(sparsity),
+	_sample_seed(sample_seed), _blob_number(blob_number), _radius(0), _cursor(0) {
+
+	check_parameters(class_number, sparsity);
+
+	if(width == 0 || height == 0) {
+		throw std::runtime_error("SyntheticVideo: width and height should be > 0");
+	}
+
+	if(_blob_number == 0) {
+		throw std::runtime_error("SyntheticVideo: blob_number should be > 0");
+	}
+
+	// Area of the blobs = (1-sparsity) of the frame, overlaps aside
+	_radius = std::max(1.0f, std::sqrt((1.0f-_sparsity)*static_cast<float>(width*height)/(static_cast<float>(_blob_number)*static_cast<float>(M_PI))));
+}
+
+bool SyntheticVideo::has_next() const {
+	return _cursor < _sample_number;
+}
+
+std::pair<std::string, Tensor<InputType>> SyntheticVideo::next() {
+	size_t label = _cursor % _class_number;
+	std::pair<std::string, Tensor<InputType>> out(std::to_string(label), _shape);
+	out.second.fill(0.0f);
+
+	size_t width = _shape.dim(0);
+	size_t height = _shape.dim(1);
+	size_t depth = _shape.dim(2);
+	size_t frame_number = _shape.dim(3);
+
+	float angle = 2.0f*static_cast<float>(M_PI)*static_cast<float>(label)/static_cast<float>(_class_number);
+	float dx = std::cos(angle);
+	float dy = std::sin(angle);
+
+	std::default_random_engine random = random_engine(_sample_seed, SampleStream, _cursor);
+	std::uniform_real_distribution<float> x_position(0.0f, static_cast<float>(width));
+	std::uniform_real_distribution<float> y_position(0.0f, static_cast<float>(height));
+	std::uniform_real_distribution<InputType> intensity(0.5f, 1.0f);
+
+	for(size_t b=0; b<_blob_number; b++) {
+		float x0 = x_position(random);
+		float y0 = y_position(random);
+		std::vector<InputType> value(depth);
+		for(size_t z=0; z<depth; z++) {
+			value[z] = intensity(random);
+		}
+
+		for(size_t k=0; k<frame_number; k++) {
+			float cx = x0+dx*static_cast<float>(k);
+			float cy = y0+dy*static_cast<float>(k);
+
+			// Bounding box of the disc, wrapped around the borders
+			for(int64_t ox=static_cast<int64_t>(std::floor(cx-_radius)); ox<=static_cast<int64_t>(std::ceil(cx+_radius)); ox++) {
+				for(int64_t oy=static_cast<int64_t>(std::floor(cy-_radius)); oy<=static_cast<int64_t>(std::ceil(cy+_radius)); oy++) {
+					float distance_x = static_cast<float>(ox)-cx;
+					float distance_y = static_cast<float>(oy)-cy;
+					if(distance_x*distance_x+distance_y*distance_y > _radius*_radius) {
+						continue;
+					}
+
+					size_t x = static_cast<size_t>(((ox%static_cast<int64_t>(width))+static_cast<int64_t>(width))%static_cast<int64_t>(width));
+					size_t y = static_cast<size_t>(((oy%static_cast<int64_t>(height))+static_cast<int64_t>(height))%static_cast<int64_t>(height));
+					for(size_t z=0; z<depth; z++) {
+						out.second.at(x, y, z, k) = std::max(out.second.at(x, y, z, k), value[z]);
+					}
+				}
+			}
+		}
+	}
+
+	_cursor++;
+
+	return out;
+}
+
+void SyntheticVideo::reset() {
+	_cursor = 0;
+}
+
+void SyntheticVideo::close() {
+
+}
+
+size_t SyntheticVideo::size() const {
+	return _sample_number;
+}
+
+std::string SyntheticVideo::to_string() const {
+	return "SyntheticVideo(" + _shape.to_string() + ", " + std::to_string(_class_number) + " classes, seed " + std::to_string(_sample_seed) + ")[" + std::to_string(size()) + "]";
+}
+
+const Shape& SyntheticVideo::shape() const {
+	return _shape;
+}
+
+//
+//	SyntheticSpikes
+//
+
+SyntheticSpikes::SyntheticSpikes(size_t width, size_t height, size_t depth, size_t class_number, size_t sample_number,
+								 float sparsity, uint32_t sample_seed, uint32_t class_seed, float noise, float jitter) :
+	_shape({width, height, depth, 1}), _class_number(class_number), _sample_number(sample_number), _sparsity(sparsity),
+	_sample_seed(sample_seed), _class_seed(class_seed), _noise(noise), _jitter(jitter), _cursor(0), _templates() {
+
+	check_parameters(class_number, sparsity);
+
+	if(_jitter < 0.0f) {
+		throw std::runtime_error("SyntheticSpikes: jitter should be >= 0");
+	}
+
+	std::bernoulli_distribution fire(1.0f-_sparsity);
+	std::uniform_real_distribution<InputType> time(0.0f, 1.0f);
+
+	for(size_t c=0; c<_class_number; c++) {
+		std::default_random_engine random = random_engine(_class_seed, ClassStream, c);
+		_templates.emplace_back(_shape);
+		for(size_t i=0; i<_shape.product(); i++) {
+			_templates.back().at_index(i) = fire(random) ? time(random) : INFINITE_TIME;
+		}
+	}
+}
+
+bool SyntheticSpikes::has_next() const {
+	return _cursor < _sample_number;
+}
+
+std::pair<std::string, Tensor<InputType>> SyntheticSpikes::next() {
+	size_t label = _cursor % _class_number;
+	std::pair<std::string, Tensor<InputType>> out(std::to_string(label), _shape);
+
+	std::default_random_engine random = random_engine(_sample_seed, SampleStream, _cursor);
+	std::bernoulli_distribution redraw(_noise);
+	std::bernoulli_distribution fire(1.0f-_sparsity);
+	std::uniform_real_distribution<InputType> time(0.0f, 1.0f);
+	// A normal distribution needs a positive deviation, it is only drawn from when there is a jitter
+	std::normal_distribution<InputType> shift(0.0f, _jitter > 0.0f ? _jitter : 1.0f);
+
+	const Tensor<InputType>& pattern = _templates[label];
+	for(size_t i=0; i<_shape.product(); i++) {
+		InputType t = pattern.at_index(i);
+		if(redraw(random)) {
+			t = fire(random) ? time(random) : INFINITE_TIME;
+		}
+		else if(t != INFINITE_TIME && _jitter > 0.0f) {
+			t = std::min(std::max(t+shift(random), 0.0f), std::nextafter(1.0f, 0.0f));
+		}
+		out.second.at_index(i) = t;
+	}
+
+	_cursor++;
+
+	return out;
+}
+
+void SyntheticSpikes::reset() {
+	_cursor = 0;
+}
+
+void SyntheticSpikes::close() {
+
+}
+
+size_t SyntheticSpikes::size() const {
+	return _sample_number;
+}
+
+std::string SyntheticSpikes::to_string() const {
+	return "SyntheticSpikes(" + _shape.to_string() + ", " + std::to_string(_class_number) + " classes, seed " + std::to_string(_sample_seed) + ")[" + std::to_string(size()) + "]";
+}
+
+const Shape& SyntheticSpikes::shape() const {
+	return _shape;
+}
@@ -1,5 +1,6 @@
 #include "dataset/Video.h"
 #include <iostream>
+#include "tool/Tracer.h"
 
 using namespace dataset;
 
@@ -71,6 +72,7 @@ bool Video::has_next() const
 std::pair<std::string, Tensor<InputType>> Video::next()
 {
 	_current_video_name = _video_list[_cursor];
+	tool::TraceSpan span("decode", _current_video_name);
 	cv::VideoCapture capture(_current_video_name);
 
 	if (!capture.isOpened())
@@ -7,7 +7,11 @@ DenseIntermediateExecution::DenseIntermediateExecution(ExperimentType& experimen
 }
 
 void DenseIntermediateExecution::process(size_t refresh_interval) {
-	_load_data();
+	// The first processes can be read from the stage cache, the data is then only loaded from their entries
+	size_t cached = _experiment.cached_process_number();
+	if(cached == 0) {
+		_load_data();
+	}
 
 	std::vector<size_t> train_index;
 	for(size_t i=0; i<_train_set.size(); i++) {
@@ -21,8 +25,14 @@ void DenseIntermediateExecution::process(size_t refresh_interval) {
 		}
 		_experiment.print() << std::endl;
 
-		_process_train_data(_experiment.process_at(i), _train_set, refresh_interval);
-		_process_test_data(_experiment.process_at(i), _test_set);
+		if(i < cached) {
+			_experiment.restore_cached_process(i, _train_set, _test_set);
+		}
+		else {
+			_process_train_data(_experiment.process_at(i), _train_set, refresh_interval);
+			_process_test_data(_experiment.process_at(i), _test_set);
+			_experiment.cache_process(i, _train_set, _test_set);
+		}
 		_process_output(i);
 		//_update_data(i, refresh_interval);
 	}
@@ -37,6 +47,7 @@ Tensor<Time> DenseIntermediateExecution::compute_time_at(size_t i) const {
 
 void DenseIntermediateExecution::_load_data() {
 	for(Input* input : _experiment.train_data()) {
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while(input->has_next()) {
 			_train_set.push_back(input->next());
@@ -47,6 +58,7 @@ void DenseIntermediateExecution::_load_data() {
 	}
 
 	for(Input* input : _experiment.test_data()) {
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while(input->has_next()) {
 			_test_set.push_back(input->next());
@@ -65,7 +77,13 @@ void DenseIntermediateExecution::_process_train_data(AbstractProcess& process, s
 	}
 
 	for(size_t i=0; i<n; i++) {
+		if(_experiment.skip_train_pass(process, i)) {
+			continue;
+		}
+
+		tool::TraceSpan span("train", process.class_name() + " " + process.name() + " pass " + std::to_string(i));
 		for(size_t j=0; j<data.size(); j++) {
+			tool::ScopedLatency latency(process.index());
 			process.process_train_sample(data[j].first, data[j].second, i, j, data.size());
 
 			if(i == n-1 && data[j].second.shape() != process.shape()) {
@@ -79,16 +97,24 @@ void DenseIntermediateExecution::_process_train_data(AbstractProcess& process, s
 			}
 
 		}
+
+		_experiment.epoch(process, i);
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void DenseIntermediateExecution::_process_test_data(AbstractProcess& process, std::vector<std::pair<std::string, Tensor<float>>>& data) {
+	tool::TraceSpan span("test", process.class_name() + " " + process.name());
 	for(size_t j=0; j<_test_set.size(); j++) {
+		tool::ScopedLatency latency(process.index());
 		process.process_test_sample(data[j].first, data[j].second, j, data.size());
 		if(data[j].second.shape() != process.shape()) {
 			throw std::runtime_error("Unexpected shape (actual: "+data[j].second.shape().to_string()+", expected: "+process.shape().to_string()+")");
 		}
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void DenseIntermediateExecution::_process_output(size_t index) {
@@ -99,6 +125,7 @@ void DenseIntermediateExecution::_process_output(size_t index) {
 			std::vector<std::pair<std::string, Tensor<float>>> output_train_set;
 			std::vector<std::pair<std::string, Tensor<float>>> output_test_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for(std::pair<std::string, Tensor<float>>& entry : _train_set) {
 				output_train_set.emplace_back(entry.first, output.converter().process(entry.second));
 			}
@@ -107,6 +134,7 @@ void DenseIntermediateExecution::_process_output(size_t index) {
 				output_test_set.emplace_back(entry.first, output.converter().process(entry.second));
 			}
 
+			conversion_span.end();
 
 			for(Process* process : output.postprocessing()) {
 				_experiment.print() << "Process " << process->class_name() << std::endl;
@@ -115,6 +143,7 @@ void DenseIntermediateExecution::_process_output(size_t index) {
 			}
 
 			for(Analysis* analysis : output.analysis()) {
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
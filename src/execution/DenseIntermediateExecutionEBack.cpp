@@ -37,6 +37,7 @@ Tensor<Time> DenseIntermediateExecutionEBack::compute_time_at(size_t i) const {
 
 void DenseIntermediateExecutionEBack::_load_data() {
 	for(Input* input : _experiment.train_data()) {
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while(input->has_next()) {
 			auto entry = input->next();
@@ -48,6 +49,7 @@ void DenseIntermediateExecutionEBack::_load_data() {
 	}
 
 	for(Input* input : _experiment.test_data()) {
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while(input->has_next()) {
 			auto entry = input->next();
@@ -67,7 +69,13 @@ void DenseIntermediateExecutionEBack::_process_train_data(AbstractProcess& proce
 	}
 
 	for(size_t i=0; i<n; i++) {
+		if(_experiment.skip_train_pass(process, i)) {
+			continue;
+		}
+
+		tool::TraceSpan span("train", process.class_name() + " " + process.name() + " pass " + std::to_string(i));
 		for(size_t j=0; j<data.size(); j++) {
+			tool::ScopedLatency latency(process.index());
 			process.process_train_sample(data[j].first, data[j].second, i, j, data.size());
 
 			if(i == n-1 && data[j].second.shape() != process.shape()) {
@@ -81,16 +89,24 @@ void DenseIntermediateExecutionEBack::_process_train_data(AbstractProcess& proce
 			}
 
 		}
+
+		_experiment.epoch(process, i);
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void DenseIntermediateExecutionEBack::_process_test_data(AbstractProcess& process, std::vector<std::pair<std::string, Tensor<float>>>& data) {
+	tool::TraceSpan span("test", process.class_name() + " " + process.name());
 	for(size_t j=0; j<_test_set.size(); j++) {
+		tool::ScopedLatency latency(process.index());
 		process.process_test_sample(data[j].first, data[j].second, j, data.size());
 		if(data[j].second.shape() != process.shape()) {
 			throw std::runtime_error("Unexpected shape (actual: "+data[j].second.shape().to_string()+", expected: "+process.shape().to_string()+")");
 		}
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void DenseIntermediateExecutionEBack::_process_output(size_t index) {
@@ -101,6 +117,7 @@ void DenseIntermediateExecutionEBack::_process_output(size_t index) {
 			std::vector<std::pair<std::string, Tensor<float>>> output_train_set;
 			std::vector<std::pair<std::string, Tensor<float>>> output_test_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for(std::pair<std::string, Tensor<float>>& entry : _train_set) {
 				output_train_set.emplace_back(entry.first, output.converter().process(entry.second));
 			}
@@ -109,6 +126,7 @@ void DenseIntermediateExecutionEBack::_process_output(size_t index) {
 				output_test_set.emplace_back(entry.first, output.converter().process(entry.second));
 			}
 
+			conversion_span.end();
 
 			for(Process* process : output.postprocessing()) {
 				_experiment.print() << "Process " << process->class_name() << std::endl;
@@ -117,6 +135,7 @@ void DenseIntermediateExecutionEBack::_process_output(size_t index) {
 			}
 
 			for(Analysis* analysis : output.analysis()) {
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
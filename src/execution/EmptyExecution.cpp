@@ -52,6 +52,7 @@ void EmptyExecution::_load_data()
 {
 	for (Input *input : _experiment.train_data())
 	{
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while (input->has_next())
 		{
@@ -65,6 +66,7 @@ void EmptyExecution::_load_data()
 
 	for (Input *input : _experiment.test_data())
 	{
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while (input->has_next())
 		{
@@ -90,6 +92,7 @@ void EmptyExecution::_process_output(size_t index)
 			std::vector<std::pair<std::string, SparseTensor<float>>> output_train_set;
 			std::vector<std::pair<std::string, SparseTensor<float>>> output_test_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for (std::pair<std::string, SparseTensor<float>> &entry : _train_set)
 			{
 				Tensor<float> current = from_sparse_tensor(entry.second);
@@ -101,6 +104,7 @@ void EmptyExecution::_process_output(size_t index)
 				Tensor<float> current = from_sparse_tensor(entry.second);
 				output_test_set.emplace_back(entry.first, to_sparse_tensor(output.converter().process(current)));
 			}
+			conversion_span.end();
 
 			for (Process *process : output.postprocessing())
 			{
@@ -125,6 +129,7 @@ void EmptyExecution::_process_output(size_t index)
 
 			for (Analysis *analysis : output.analysis())
 			{
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
 				size_t n = analysis->train_pass_number();
@@ -134,8 +139,7 @@ void EmptyExecution::_process_output(size_t index)
 					analysis->before_train_pass(i);
 					for (std::pair<std::string, SparseTensor<float>> &entry : output_train_set)
 					{
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_train_sample(entry.first, current, i);
+						analysis->process_train_sparse_sample(entry.first, entry.second, i);
 					}
 					analysis->after_train_pass(i);
 				}
@@ -150,8 +154,7 @@ void EmptyExecution::_process_output(size_t index)
 					// In the old simulator version, late fusion happens here.
 					for (std::pair<std::string, SparseTensor<float>> &entry : output_test_set)
 					{
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_test_sample(entry.first, current);
+						analysis->process_test_sparse_sample(entry.first, entry.second);
 					}
 					analysis->after_test();
 				}
@@ -0,0 +1,205 @@
+#include "execution/PipelinedExecution.h"
+#include <thread>
+
+PipelinedExecution::PipelinedExecution(ExperimentType& experiment, size_t queue_capacity) :
+	_experiment(experiment), _queue_capacity(queue_capacity), _queues(), _log_mutex(), _error_mutex(), _error() {
+
+}
+
+void PipelinedExecution::process(size_t refresh_interval) {
+	(void)refresh_interval; // Suppress unused parameter warning
+	for(size_t i=0; i<_experiment.process_number(); i++) {
+		_experiment.print() << "Process " << _experiment.process_at(i).factory_name() << "." << _experiment.process_at(i).class_name();
+		if(!_experiment.process_at(i).name().empty()) {
+			_experiment.print() << " (" << _experiment.process_at(i).name() << ")";
+		}
+		_experiment.print() << std::endl;
+
+		_load_params(_experiment.process_at(i));
+	}
+
+	size_t process_number = _experiment.process_number();
+	if(process_number == 0) {
+		return;
+	}
+
+	// Queue i feeds process i, then one queue per output
+	_queues.clear();
+	for(size_t i=0; i<process_number+_experiment.output_count(); i++) {
+		_queues.emplace_back(new Queue(_queue_capacity));
+	}
+	_error = nullptr;
+
+	std::vector<std::vector<Queue*>> process_out(process_number);
+	for(size_t i=0; i+1<process_number; i++) {
+		process_out[i].push_back(_queues[i+1].get());
+	}
+	for(size_t i=0; i<_experiment.output_count(); i++) {
+		process_out[_experiment.output_at(i).index()].push_back(_queues[process_number+i].get());
+	}
+
+	std::vector<std::thread> threads;
+	threads.emplace_back(&PipelinedExecution::_read_inputs, this, std::ref(*_queues[0]));
+	for(size_t i=0; i<process_number; i++) {
+		threads.emplace_back(&PipelinedExecution::_run_process, this, std::ref(_experiment.process_at(i)), std::ref(*_queues[i]), std::cref(process_out[i]));
+	}
+	for(size_t i=0; i<_experiment.output_count(); i++) {
+		threads.emplace_back(&PipelinedExecution::_run_output, this, std::ref(_experiment.output_at(i)), std::ref(*_queues[process_number+i]));
+	}
+
+	for(std::thread& thread : threads) {
+		thread.join();
+	}
+	_queues.clear();
+
+	if(_error) {
+		std::rethrow_exception(_error);
+	}
+}
+
+Tensor<Time> PipelinedExecution::compute_time_at(size_t i) const {
+	(void)i; // Suppress unused parameter warning
+	throw std::runtime_error("Unimplemented");
+}
+
+void PipelinedExecution::_load_params(AbstractProcess& process) {
+	std::string process_load_path = _experiment.model_path() + "/" + process.factory_name() + "." + process.class_name();
+	if (!process.name().empty()) {
+		process_load_path += "." + process.name();
+	}
+	process_load_path += "/";
+	bool loaded = process.load_params(process_load_path);
+	if (loaded) {
+		_experiment.log() << "Load trained parameters at " << process_load_path << std::endl;
+	}
+}
+
+void PipelinedExecution::_read_inputs(Queue& out) {
+	try {
+		// The previous sample is queued once the next one is read, to know which one is the last
+		Sample pending;
+		bool has_pending = false;
+		size_t index = 0;
+
+		for(Input* input : _experiment.test_data()) {
+			tool::TraceSpan span("load", input->to_string());
+			size_t count = 0;
+			while(input->has_next()) {
+				std::pair<std::string, Tensor<float>> entry = input->next();
+				if(has_pending && !out.push(std::move(pending))) {
+					return;
+				}
+				pending.label = std::move(entry.first);
+				pending.value = std::move(entry.second);
+				pending.index = index++;
+				pending.last = false;
+				has_pending = true;
+				count++;
+			}
+			std::lock_guard<std::mutex> lock(_log_mutex);
+			_experiment.log() << "Load " << count << " test samples from " << input->to_string() << std::endl;
+			input->close();
+		}
+
+		if(has_pending) {
+			pending.last = true;
+			out.push(std::move(pending));
+		}
+		out.close();
+	}
+	catch(...) {
+		_fail(std::current_exception());
+	}
+}
+
+void PipelinedExecution::_run_process(AbstractProcess& process, Queue& in, const std::vector<Queue*>& out) {
+	try {
+		tool::TraceSpan span("test", process.class_name() + " " + process.name());
+		Sample sample;
+		while(in.pop(sample)) {
+			{
+				tool::ScopedLatency latency(process.index());
+				process.process_test_sample(sample.label, sample.value, sample.index, sample.last ? sample.index+1 : 0);
+			}
+			if(sample.value.shape() != process.shape()) {
+				throw std::runtime_error("Unexpected shape (actual: "+sample.value.shape().to_string()+", expected: "+process.shape().to_string()+")");
+			}
+
+			// The outputs get copies, the first queue (the next process) the sample itself
+			for(size_t i=1; i<out.size(); i++) {
+				if(!out[i]->push(sample)) {
+					return;
+				}
+			}
+			if(!out.empty() && !out[0]->push(std::move(sample))) {
+				return;
+			}
+		}
+
+		for(Queue* queue : out) {
+			queue->close();
+		}
+	}
+	catch(...) {
+		_fail(std::current_exception());
+	}
+}
+
+void PipelinedExecution::_run_output(Output& output, Queue& in) {
+	try {
+		tool::TraceSpan span("output", output.name());
+		for(Analysis* analysis : output.analysis()) {
+			if(analysis->train_pass_number() > 0) {
+				analysis->before_test();
+			}
+		}
+
+		Sample sample;
+		while(in.pop(sample)) {
+			Tensor<float> value = output.converter().process(sample.value);
+			for(Process* process : output.postprocessing()) {
+				process->process_test_sample(sample.label, value, sample.index, sample.last ? sample.index+1 : 0);
+			}
+			for(Analysis* analysis : output.analysis()) {
+				if(analysis->train_pass_number() > 0) {
+					analysis->process_test_sample(sample.label, value);
+				}
+			}
+		}
+
+		// The stream was cancelled
+		if(_failed()) {
+			return;
+		}
+
+		// The analyses log their results, one output at a time
+		std::lock_guard<std::mutex> lock(_log_mutex);
+		for(Analysis* analysis : output.analysis()) {
+			_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
+			analysis->after_test();
+		}
+	}
+	catch(...) {
+		_fail(std::current_exception());
+	}
+}
+
+/**
+ * @brief Keeps the first error, to rethrow it from process(), and stops all the stages.
+ */
+void PipelinedExecution::_fail(std::exception_ptr error) {
+	{
+		std::lock_guard<std::mutex> lock(_error_mutex);
+		if(!_error) {
+			_error = error;
+		}
+	}
+	for(std::unique_ptr<Queue>& queue : _queues) {
+		queue->cancel();
+	}
+}
+
+bool PipelinedExecution::_failed() {
+	std::lock_guard<std::mutex> lock(_error_mutex);
+	return static_cast<bool>(_error);
+}
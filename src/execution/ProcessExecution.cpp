@@ -54,6 +54,7 @@ void ProcessExecution::_load_data()
 {
 	for (Input *input : _experiment.train_data())
 	{
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while (input->has_next())
 		{
@@ -67,6 +68,7 @@ void ProcessExecution::_load_data()
 
 	for (Input *input : _experiment.test_data())
 	{
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while (input->has_next())
 		{
@@ -87,13 +89,17 @@ void ProcessExecution::_process_train_data(AbstractProcess &process, std::vector
 
 	for (size_t i = 0; i < n; i++)
 	{
+		if (_experiment.skip_train_pass(process, i))
+			continue;
 
+		tool::TraceSpan span("train", process.class_name() + " " + process.name() + " pass " + std::to_string(i));
 		size_t total_size = 0;
 		size_t total_capacity = 0;
 
 		for (size_t j = 0; j < data.size(); j++)
 		{
 			Tensor<float> current = from_sparse_tensor(data[j].second);
+			tool::ScopedLatency latency(process.index());
 			process.process_train_sample(_experiment.name() + ";." + std::to_string(process.index()) + ";." + data[j].first, current, i, j, data.size());
 			data[j].second = to_sparse_tensor(current);
 
@@ -119,14 +125,20 @@ void ProcessExecution::_process_train_data(AbstractProcess &process, std::vector
 				_experiment.refresh(process.index());
 			}
 		}
+
+		_experiment.epoch(process, i);
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void ProcessExecution::_process_test_data(AbstractProcess &process, std::vector<std::pair<std::string, SparseTensor<float>>> &data)
 {
+	tool::TraceSpan span("test", process.class_name() + " " + process.name());
 	for (size_t j = 0; j < data.size(); j++)
 	{
 		Tensor<float> current = from_sparse_tensor(data[j].second);
+		tool::ScopedLatency latency(process.index());
 		process.process_test_sample(data[j].first, current, j, data.size());
 		data[j].second = to_sparse_tensor(current);
 
@@ -135,6 +147,8 @@ void ProcessExecution::_process_test_data(AbstractProcess &process, std::vector<
 			throw std::runtime_error("Unexpected shape (actual: " + data[j].second.shape().to_string() + ", expected: " + process.shape().to_string() + ")");
 		}
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void ProcessExecution::_process_output(size_t index)
@@ -150,6 +164,7 @@ void ProcessExecution::_process_output(size_t index)
 			std::vector<std::pair<std::string, SparseTensor<float>>> output_train_set;
 			std::vector<std::pair<std::string, SparseTensor<float>>> output_test_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for (std::pair<std::string, SparseTensor<float>> &entry : _train_set)
 			{
 				Tensor<float> current = from_sparse_tensor(entry.second);
@@ -161,6 +176,7 @@ void ProcessExecution::_process_output(size_t index)
 				Tensor<float> current = from_sparse_tensor(entry.second);
 				output_test_set.emplace_back(entry.first, to_sparse_tensor(output.converter().process(current)));
 			}
+			conversion_span.end();
 
 			for (Process *process : output.postprocessing())
 			{
@@ -171,6 +187,7 @@ void ProcessExecution::_process_output(size_t index)
 
 			for (Analysis *analysis : output.analysis())
 			{
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
 				size_t n = analysis->train_pass_number();
@@ -180,8 +197,7 @@ void ProcessExecution::_process_output(size_t index)
 					analysis->before_train_pass(i);
 					for (std::pair<std::string, SparseTensor<float>> &entry : output_train_set)
 					{
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_train_sample(entry.first, current, i);
+						analysis->process_train_sparse_sample(entry.first, entry.second, i);
 					}
 					analysis->after_train_pass(i);
 				}
@@ -196,8 +212,7 @@ void ProcessExecution::_process_output(size_t index)
 					// In the old simulator version, late fusion happens here.
 					for (std::pair<std::string, SparseTensor<float>> &entry : output_test_set)
 					{
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_test_sample(entry.first, current);
+						analysis->process_test_sparse_sample(entry.first, entry.second);
 					}
 					analysis->after_test();
 				}
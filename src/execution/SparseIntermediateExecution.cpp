@@ -7,7 +7,11 @@ SparseIntermediateExecution::SparseIntermediateExecution(ExperimentType& experim
 }
 
 void SparseIntermediateExecution::process(size_t refresh_interval) {
-	_load_data();
+	// The first processes can be read from the stage cache, the data is then only loaded from their entries
+	size_t cached = _experiment.cached_process_number();
+	if(cached == 0) {
+		_load_data();
+	}
 	std::vector<size_t> train_index;
 	for(size_t i=0; i<_train_set.size(); i++) {
 		train_index.push_back(i);
@@ -21,10 +25,15 @@ void SparseIntermediateExecution::process(size_t refresh_interval) {
 		}
 		_experiment.print() << std::endl;
 
-		_process_train_data(_experiment.process_at(i), _train_set, refresh_interval);
-		
-		_process_test_data(_experiment.process_at(i), _test_set);
-		
+		if(i < cached) {
+			_experiment.restore_cached_process(i, _train_set, _test_set);
+		}
+		else {
+			_process_train_data(_experiment.process_at(i), _train_set, refresh_interval);
+			_process_test_data(_experiment.process_at(i), _test_set);
+			_experiment.cache_process(i, _train_set, _test_set);
+		}
+
 		_process_output(i);
 
 		auto end = std::chrono::system_clock::now();
@@ -54,6 +63,7 @@ void SparseIntermediateExecution::_load_data() {
     int failed_data = 0;
     
     for(Input* input : _experiment.train_data()) {
+        tool::TraceSpan span("load", input->to_string());
         ct++;
         
         // Check if input is valid before trying to use it
@@ -96,6 +106,7 @@ void SparseIntermediateExecution::_load_data() {
 
     // Load testing data
     for(Input* input : _experiment.test_data()) {
+        tool::TraceSpan span("load", input->to_string());
         size_t count = 0;
         
         while(input->has_next()) {
@@ -122,11 +133,17 @@ void SparseIntermediateExecution::_process_train_data(AbstractProcess& process,
 	}
 
 	for(size_t i=0; i<n; i++) {
+		if(_experiment.skip_train_pass(process, i)) {
+			continue;
+		}
+
+		tool::TraceSpan span("train", process.class_name() + " " + process.name() + " pass " + std::to_string(i));
 		size_t total_size = 0;
 		size_t total_capacity = 0;
 
 		for(size_t j=0; j<data.size(); j++) {
 			Tensor<float> current = from_sparse_tensor(data[j].second);
+			tool::ScopedLatency latency(process.index());
 			process.process_train_sample(data[j].first, current, i, j, data.size());
 			data[j].second = to_sparse_tensor(current);
 
@@ -152,12 +169,18 @@ void SparseIntermediateExecution::_process_train_data(AbstractProcess& process,
 				_experiment.refresh(process.index());
 			}
 		}
+
+		_experiment.epoch(process, i);
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void SparseIntermediateExecution::_process_test_data(AbstractProcess& process, std::vector<std::pair<std::string, SparseTensor<float>>>& data) {
+	tool::TraceSpan span("test", process.class_name() + " " + process.name());
 	for(size_t j=0; j<_test_set.size(); j++) {
 		Tensor<float> current = from_sparse_tensor(data[j].second);
+		tool::ScopedLatency latency(process.index());
 		process.process_test_sample(data[j].first, current, j, data.size());
 		data[j].second = to_sparse_tensor(current);
 
@@ -165,6 +188,8 @@ void SparseIntermediateExecution::_process_test_data(AbstractProcess& process, s
 			throw std::runtime_error("Unexpected shape (actual: "+data[j].second.shape().to_string()+", expected: "+process.shape().to_string()+")");
 		}
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void SparseIntermediateExecution::_process_output(size_t index) {
@@ -178,6 +203,7 @@ void SparseIntermediateExecution::_process_output(size_t index) {
 			std::vector<std::pair<std::string, SparseTensor<float>>> output_train_set;
 			std::vector<std::pair<std::string, SparseTensor<float>>> output_test_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for(std::pair<std::string, SparseTensor<float>>& entry : _train_set) {
 				Tensor<float> current = from_sparse_tensor(entry.second);
 				output_train_set.emplace_back(entry.first, to_sparse_tensor(output.converter().process(current)));
@@ -187,6 +213,7 @@ void SparseIntermediateExecution::_process_output(size_t index) {
 				Tensor<float> current = from_sparse_tensor(entry.second);
 				output_test_set.emplace_back(entry.first, to_sparse_tensor(output.converter().process(current)));
 			}
+			conversion_span.end();
 
 			for(Process* process : output.postprocessing()) {
 				_experiment.print() << "Process " << process->class_name() << std::endl;
@@ -195,6 +222,7 @@ void SparseIntermediateExecution::_process_output(size_t index) {
 			}
 
 			for(Analysis* analysis : output.analysis()) {
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
@@ -203,8 +231,7 @@ void SparseIntermediateExecution::_process_output(size_t index) {
 				for(size_t j=0; j<n; j++) {
 					analysis->before_train_pass(j);
 					for(std::pair<std::string, SparseTensor<float>>& entry : output_train_set) {
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_train_sample(entry.first, current, j);
+						analysis->process_train_sparse_sample(entry.first, entry.second, j);
 					}
 					analysis->after_train_pass(j);
 				}
@@ -215,8 +242,7 @@ void SparseIntermediateExecution::_process_output(size_t index) {
 				else {
 					analysis->before_test();
 					for(std::pair<std::string, SparseTensor<float>>& entry : output_test_set) {
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_test_sample(entry.first, current);
+						analysis->process_test_sparse_sample(entry.first, entry.second);
 					}
 					analysis->after_test();
 				}
@@ -13,7 +13,13 @@ SparseIntermediateExecutionNew::SparseIntermediateExecutionNew(ExperimentType &e
 
 void SparseIntermediateExecutionNew::process(size_t refresh_interval)
 {
-	_load_data();
+	// The first processes can be read from the stage cache, the data is then only loaded from their entries.
+	// The residual connections need the input set, so nothing is skipped with them.
+	size_t cached = _allow_residual_connections ? 0 : _experiment.cached_process_number();
+	if (cached == 0)
+	{
+		_load_data();
+	}
 	if (_allow_residual_connections == true)
 	{
 		std::filesystem::create_directories(_file_path + "/ResInput/");
@@ -37,8 +43,16 @@ void SparseIntermediateExecutionNew::process(size_t refresh_interval)
 		}
 		_experiment.print() << std::endl;
 
-		_process_train_data(_experiment.process_at(i), _train_set, refresh_interval);
-		_process_test_data(_experiment.process_at(i), _test_set);
+		if (i < cached)
+		{
+			_experiment.restore_cached_process(i, _train_set, _test_set);
+		}
+		else
+		{
+			_process_train_data(_experiment.process_at(i), _train_set, refresh_interval);
+			_process_test_data(_experiment.process_at(i), _test_set);
+			_experiment.cache_process(i, _train_set, _test_set);
+		}
 		_process_output(i);
 
 		auto end = std::chrono::system_clock::now();
@@ -67,6 +81,7 @@ void SparseIntermediateExecutionNew::_load_data()
 {
 	for (Input *input : _experiment.train_data())
 	{
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while (input->has_next())
 		{
@@ -80,6 +95,7 @@ void SparseIntermediateExecutionNew::_load_data()
 
 	for (Input *input : _experiment.test_data())
 	{
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while (input->has_next())
 		{
@@ -111,25 +127,21 @@ void SparseIntermediateExecutionNew::_set_temporal_depth(AbstractProcess const &
 
 		if (_temporal_depth > 1 && entry.second.shape().number() > 3) // 3D convolution
 		{
-			for (int i = 0; i < _height; i++)
-				for (int j = 0; j < _width; j++)
-					for (int z = 0; z < _depth; z++)
-						for (int k = 0; k < _conv_depth; k++)
-						{
-							_sample_buffer.at(i, j, z, sample_join_buffer) = current.at(i, j, z, k);
-						}
+			// each frame of the sample overwrites the previous one in the slot, so only the last one is kept
+			if (_conv_depth > 0)
+				_sample_buffer.view().slice(3, sample_join_buffer).assign(current.view().slice(3, _conv_depth - 1));
 			sample_join_buffer++;
 
+			// every slot is written again before the next join, so the buffer is reused
 			if (sample_join_buffer == _temporal_depth)
 			{
 				joined_train_set.emplace_back(entry.first, to_sparse_tensor(_sample_buffer));
-				_sample_buffer = Tensor<float>(Shape({_height, _width, _depth, _temporal_depth}));
 				sample_join_buffer = 0;
 			}
 		}
 	}
 
-	data = joined_train_set;
+	data = std::move(joined_train_set);
 }
 
 void SparseIntermediateExecutionNew::_process_train_data(AbstractProcess &process, std::vector<std::pair<std::string, SparseTensor<float>>> &data, size_t refresh_interval)
@@ -143,6 +155,10 @@ void SparseIntermediateExecutionNew::_process_train_data(AbstractProcess &proces
 	// during training, n = epochs
 	for (size_t i = 0; i < n; i++)
 	{
+		if (_experiment.skip_train_pass(process, i))
+			continue;
+
+		tool::TraceSpan span("train", process.class_name() + " " + process.name() + " pass " + std::to_string(i));
 		size_t total_size = 0;
 		size_t total_capacity = 0;
 		if (process.class_name() == "SetTemporalDepth")
@@ -151,6 +167,7 @@ void SparseIntermediateExecutionNew::_process_train_data(AbstractProcess &proces
 		for (size_t j = 0; j < data.size(); j++)
 		{
 			Tensor<float> current = from_sparse_tensor(data[j].second);
+			tool::ScopedLatency latency(process.index());
 			process.process_train_sample(_experiment.name() + ";." + std::to_string(process.index()) + ";." + data[j].first, current, i, j, data.size());
 			data[j].second = to_sparse_tensor(current);
 
@@ -182,17 +199,23 @@ void SparseIntermediateExecutionNew::_process_train_data(AbstractProcess &proces
 			std::filesystem::create_directories(_file_path + "/ExtractedTimestamps/" + _experiment.name() + "/train/");
 			SavePairVector(_file_path + "/ExtractedTimestamps/" + _experiment.name() + "/train/" + _experiment.name() + "_input_spikes.json", data);
 		}
+
+		_experiment.epoch(process, i);
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void SparseIntermediateExecutionNew::_process_test_data(AbstractProcess &process, std::vector<std::pair<std::string, SparseTensor<float>>> &data)
 {
+	tool::TraceSpan span("test", process.class_name() + " " + process.name());
 	if (process.class_name() == "SetTemporalDepth")
 		_set_temporal_depth(process, data);
 
 	for (size_t j = 0; j < data.size(); j++)
 	{
 		Tensor<float> current = from_sparse_tensor(data[j].second);
+		tool::ScopedLatency latency(process.index());
 		process.process_test_sample(data[j].first, current, j, data.size());
 		data[j].second = to_sparse_tensor(current);
 
@@ -207,6 +230,8 @@ void SparseIntermediateExecutionNew::_process_test_data(AbstractProcess &process
 		std::filesystem::create_directories(_file_path + "/ExtractedTimestamps/" + _experiment.name() + "/test/");
 		SavePairVector(_file_path + "/ExtractedTimestamps/" + _experiment.name() + "/test/" + _experiment.name() + "_input_spikes.json", data);
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void SparseIntermediateExecutionNew::_process_output(size_t index)
@@ -231,6 +256,7 @@ void SparseIntermediateExecutionNew::_process_output(size_t index)
 				SavePairVector(_file_path + "/ExtractedTimestamps/" + _mainExpName + "/test/" + _experiment.name() + "_timestamps.json", _test_set);
 			}
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for (std::pair<std::string, SparseTensor<float>> &entry : _train_set)
 			{
 				Tensor<float> current = from_sparse_tensor(entry.second);
@@ -242,6 +268,7 @@ void SparseIntermediateExecutionNew::_process_output(size_t index)
 				Tensor<float> current = from_sparse_tensor(entry.second);
 				output_test_set.emplace_back(entry.first, to_sparse_tensor(output.converter().process(current)));
 			}
+			conversion_span.end();
 
 			for (Process *process : output.postprocessing())
 			{
@@ -283,6 +310,7 @@ void SparseIntermediateExecutionNew::_process_output(size_t index)
 
 			for (Analysis *analysis : output.analysis())
 			{
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
 				size_t n = analysis->train_pass_number();
@@ -292,8 +320,7 @@ void SparseIntermediateExecutionNew::_process_output(size_t index)
 					analysis->before_train_pass(i);
 					for (std::pair<std::string, SparseTensor<float>> &entry : output_train_set)
 					{
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_train_sample(entry.first, current, i);
+						analysis->process_train_sparse_sample(entry.first, entry.second, i);
 					}
 					analysis->after_train_pass(i);
 				}
@@ -308,8 +335,7 @@ void SparseIntermediateExecutionNew::_process_output(size_t index)
 					// In the old simulator version, late fusion happens here.
 					for (std::pair<std::string, SparseTensor<float>> &entry : output_test_set)
 					{
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_test_sample(entry.first, current);
+						analysis->process_test_sparse_sample(entry.first, entry.second);
 					}
 					analysis->after_test();
 				}
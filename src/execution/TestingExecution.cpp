@@ -40,6 +40,7 @@ Tensor<Time> TestingExecution::compute_time_at(size_t i) const {
 
 void TestingExecution::_load_data() {
 	for(Input* input : _experiment.test_data()) {
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while(input->has_next()) {
 			_test_set.push_back(input->next());
@@ -51,12 +52,16 @@ void TestingExecution::_load_data() {
 }
 
 void TestingExecution::_process_test_data(AbstractProcess& process, std::vector<std::pair<std::string, Tensor<float>>>& data) {
+	tool::TraceSpan span("test", process.class_name() + " " + process.name());
 	for(size_t j=0; j<_test_set.size(); j++) {
+		tool::ScopedLatency latency(process.index());
 		process.process_test_sample(data[j].first, data[j].second, j, data.size());
 		if(data[j].second.shape() != process.shape()) {
 			throw std::runtime_error("Unexpected shape (actual: "+data[j].second.shape().to_string()+", expected: "+process.shape().to_string()+")");
 		}
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void TestingExecution::_process_output(size_t index) {
@@ -66,9 +71,11 @@ void TestingExecution::_process_output(size_t index) {
 
 			std::vector<std::pair<std::string, Tensor<float>>> output_test_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for(std::pair<std::string, Tensor<float>>& entry : _test_set) {
 				output_test_set.emplace_back(entry.first, output.converter().process(entry.second));
 			}
+			conversion_span.end();
 
 			for(Process* process : output.postprocessing()) {
 				_experiment.print() << "Process " << process->class_name() << std::endl;
@@ -76,6 +83,7 @@ void TestingExecution::_process_output(size_t index) {
 			}
 
 			for(Analysis* analysis : output.analysis()) {
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
@@ -40,6 +40,7 @@ Tensor<Time> TestingSparseExecution::compute_time_at(size_t i) const {
 
 void TestingSparseExecution::_load_data() {
 	for(Input* input : _experiment.test_data()) {
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while(input->has_next()) {
 			auto entry = input->next();
@@ -52,8 +53,10 @@ void TestingSparseExecution::_load_data() {
 }
 
 void TestingSparseExecution::_process_test_data(AbstractProcess& process, std::vector<std::pair<std::string, SparseTensor<float>>>& data) {
+	tool::TraceSpan span("test", process.class_name() + " " + process.name());
 	for(size_t j=0; j<_test_set.size(); j++) {
 		Tensor<float> current = from_sparse_tensor(data[j].second);
+		tool::ScopedLatency latency(process.index());
 		process.process_test_sample(data[j].first, current, j, data.size());
 		data[j].second = to_sparse_tensor(current);
 
@@ -61,6 +64,8 @@ void TestingSparseExecution::_process_test_data(AbstractProcess& process, std::v
 			throw std::runtime_error("Unexpected shape (actual: "+data[j].second.shape().to_string()+", expected: "+process.shape().to_string()+")");
 		}
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void TestingSparseExecution::_process_output(size_t index) {
@@ -73,10 +78,12 @@ void TestingSparseExecution::_process_output(size_t index) {
 
 			std::vector<std::pair<std::string, SparseTensor<float>>> output_test_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for(std::pair<std::string, SparseTensor<float>>& entry : _test_set) {
 				Tensor<float> current = from_sparse_tensor(entry.second);
 				output_test_set.emplace_back(entry.first, to_sparse_tensor(output.converter().process(current)));
 			}
+			conversion_span.end();
 
 			for(Process* process : output.postprocessing()) {
 				_experiment.print() << "Process " << process->class_name() << std::endl;
@@ -84,6 +91,7 @@ void TestingSparseExecution::_process_output(size_t index) {
 			}
 
 			for(Analysis* analysis : output.analysis()) {
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
@@ -95,8 +103,7 @@ void TestingSparseExecution::_process_output(size_t index) {
 				else {
 					analysis->before_test();
 					for(std::pair<std::string, SparseTensor<float>>& entry : output_test_set) {
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_test_sample(entry.first, current);
+						analysis->process_test_sparse_sample(entry.first, entry.second);
 					}
 					analysis->after_test();
 				}
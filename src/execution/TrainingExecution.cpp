@@ -56,6 +56,7 @@ void TrainingExecution::_load_data()
 {
 	for (Input *input : _experiment.train_data())
 	{
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while (input->has_next())
 		{
@@ -79,10 +80,15 @@ void TrainingExecution::_process_train_data(AbstractProcess &process, std::vecto
 	refresh_interval = 10;
 	for (size_t i = 0; i < n; i++)
 	{
+		if (_experiment.skip_train_pass(process, i))
+			continue;
+
+		tool::TraceSpan span("train", process.class_name() + " " + process.name() + " pass " + std::to_string(i));
 		for (size_t j = 0; j < data.size(); j++)
 		{
 			// if ((j+1)%100==0)
 			//	_experiment.log() << "processing sample " <<j<< " out of "<<data.size()<<"\n";
+			tool::ScopedLatency latency(process.index());
 			process.process_train_sample(data[j].first, data[j].second, i, j, data.size());
 
 			if (i == n - 1 && data[j].second.shape() != process.shape())
@@ -97,7 +103,11 @@ void TrainingExecution::_process_train_data(AbstractProcess &process, std::vecto
 				_experiment.refresh(process.index());
 			}
 		}
+
+		_experiment.epoch(process, i);
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void TrainingExecution::_process_output(size_t index)
@@ -110,10 +120,12 @@ void TrainingExecution::_process_output(size_t index)
 
 			std::vector<std::pair<std::string, Tensor<float>>> output_train_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for (std::pair<std::string, Tensor<float>> &entry : _train_set)
 			{
 				output_train_set.emplace_back(entry.first, output.converter().process(entry.second));
 			}
+			conversion_span.end();
 
 			for (Process *process : output.postprocessing())
 			{
@@ -123,6 +135,7 @@ void TrainingExecution::_process_output(size_t index)
 
 			for (Analysis *analysis : output.analysis())
 			{
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
@@ -52,6 +52,7 @@ Tensor<Time> TrainingSparseExecution::compute_time_at(size_t i) const {
 
 void TrainingSparseExecution::_load_data() {
 	for(Input* input : _experiment.train_data()) {
+		tool::TraceSpan span("load", input->to_string());
 		size_t count = 0;
 		while(input->has_next()) {
 			auto entry = input->next();
@@ -71,9 +72,14 @@ void TrainingSparseExecution::_process_train_data(AbstractProcess& process, std:
 	}
 
 	for(size_t i=0; i<n; i++) {
+		if(_experiment.skip_train_pass(process, i)) {
+			continue;
+		}
 
+		tool::TraceSpan span("train", process.class_name() + " " + process.name() + " pass " + std::to_string(i));
 		for(size_t j=0; j<data.size(); j++) {
 			Tensor<float> current = from_sparse_tensor(data[j].second);
+			tool::ScopedLatency latency(process.index());
 			process.process_train_sample(data[j].first, current, i, j, data.size());
 			data[j].second = to_sparse_tensor(current);
 
@@ -88,7 +94,11 @@ void TrainingSparseExecution::_process_train_data(AbstractProcess& process, std:
 			}
 
 		}
+
+		_experiment.epoch(process, i);
 	}
+
+	tool::Counters::add_storage(process.index(), data);
 }
 
 void TrainingSparseExecution::_process_output(size_t index) {
@@ -101,10 +111,12 @@ void TrainingSparseExecution::_process_output(size_t index) {
 
 			std::vector<std::pair<std::string, SparseTensor<float>>> output_train_set;
 
+			tool::TraceSpan conversion_span("output", output.name() + " conversion");
 			for(std::pair<std::string, SparseTensor<float>>& entry : _train_set) {
 				Tensor<float> current = from_sparse_tensor(entry.second);
 				output_train_set.emplace_back(entry.first, to_sparse_tensor(output.converter().process(current)));
 			}
+			conversion_span.end();
 
 			for(Process* process : output.postprocessing()) {
 				_experiment.print() << "Process " << process->class_name() << std::endl;
@@ -112,6 +124,7 @@ void TrainingSparseExecution::_process_output(size_t index) {
 			}
 
 			for(Analysis* analysis : output.analysis()) {
+				tool::TraceSpan span("analysis", output.name() + " " + analysis->class_name());
 
 				_experiment.log() << output.name() << ", analysis " << analysis->class_name() << ":" << std::endl;
 
@@ -120,8 +133,7 @@ void TrainingSparseExecution::_process_output(size_t index) {
 				for(size_t j=0; j<n; j++) {
 					analysis->before_train_pass(j);
 					for(std::pair<std::string, SparseTensor<float>>& entry : output_train_set) {
-						Tensor<float> current = from_sparse_tensor(entry.second);
-						analysis->process_train_sample(entry.first, current, j);
+						analysis->process_train_sparse_sample(entry.first, entry.second, j);
 					}
 					analysis->after_train_pass(j);
 				}
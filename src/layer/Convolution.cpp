@@ -3,17 +3,24 @@
 #include <execution>
 #include <mutex>
 #include "dep/npy.hpp"
+#include "tool/Counters.h"
+#include <numeric>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace layer;
 
 static RegisterClassParameter<Convolution, LayerFactory> _register("Convolution");
 
 Convolution::Convolution() : Layer3D(_register),
-							 _inhibition(true), _draw(false), _epoch_number(0), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0),
-							 _w(), _th(), _stdp(nullptr), _input_depth(0), _wta_infer(false), _impl(*this)
+							 _epoch_number(0), _saved_weights(0), _snapshot_interval(1), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0), _draw(false), _save_weights(false), _inhibition(true),
+							 _w(), _th(), _stdp(nullptr), _input_depth(0), _wta_infer(false), _dense_bins(0), _quantized_infer(false), _quantization_calibration(0), _binary_infer(false), _binary_cut(0.5f), _impl(*this), _dense(*this), _quantized(*this), _binary(*this)
 {
 	add_parameter("draw", _draw);
 	add_parameter("save_weights", _save_weights);
+	add_parameter("snapshot_interval", _snapshot_interval, static_cast<uint32_t>(1));
 	add_parameter("inhibition", _inhibition);
 	add_parameter("epoch", _epoch_number);
 	add_parameter("annealing", _annealing, 1.0f);
@@ -26,17 +33,23 @@ Convolution::Convolution() : Layer3D(_register),
 	add_parameter("th", _th);
 
 	add_parameter("wta_infer", _wta_infer);
+	add_parameter("dense_bins", _dense_bins, static_cast<uint32_t>(0));
+	add_parameter("quantized_infer", _quantized_infer, false);
+	add_parameter("quantization_calibration", _quantization_calibration, static_cast<uint32_t>(0));
+	add_parameter("binary_infer", _binary_infer, false);
+	add_parameter("binary_cut", _binary_cut, 0.5f);
 
 	add_parameter("stdp", _stdp);
 }
 
 Convolution::Convolution(size_t filter_width, size_t filter_height, size_t filter_number,
 						 size_t stride_x, size_t stride_y, size_t padding_x, size_t padding_y) : Layer3D(_register, filter_width, filter_height, filter_number, stride_x, stride_y, padding_x, padding_y),
-																								 _inhibition(true), _draw(false), _save_weights(false), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0), _sample_number(0), _sample_count(0),
-																								 _w(), _th(), _stdp(nullptr), _input_depth(0), _wta_infer(false), _impl(*this)
+																								 _sample_number(0), _sample_count(0), _saved_weights(0), _snapshot_interval(1), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0), _draw(false), _save_weights(false), _inhibition(true),
+																								 _w(), _th(), _stdp(nullptr), _input_depth(0), _wta_infer(false), _dense_bins(0), _quantized_infer(false), _quantization_calibration(0), _binary_infer(false), _binary_cut(0.5f), _impl(*this), _dense(*this), _quantized(*this), _binary(*this)
 {
 	add_parameter("draw", _draw);
 	add_parameter("save_weights", _save_weights);
+	add_parameter("snapshot_interval", _snapshot_interval, static_cast<uint32_t>(1));
 
 	add_parameter("inhibition", _inhibition);
 	add_parameter("epoch", _epoch_number);
@@ -50,6 +63,11 @@ Convolution::Convolution(size_t filter_width, size_t filter_height, size_t filte
 	add_parameter("th", _th);
 
 	add_parameter("wta_infer", _wta_infer);
+	add_parameter("dense_bins", _dense_bins, static_cast<uint32_t>(0));
+	add_parameter("quantized_infer", _quantized_infer, false);
+	add_parameter("quantization_calibration", _quantization_calibration, static_cast<uint32_t>(0));
+	add_parameter("binary_infer", _binary_infer, false);
+	add_parameter("binary_cut", _binary_cut, 0.5f);
 
 	add_parameter("stdp", _stdp);
 
@@ -67,25 +85,19 @@ Shape Convolution::compute_shape(const Shape& previous_shape) {
 	parameter<Tensor<float>>("th").shape(_filter_number);
 
 	_impl.resize();
+	_dense.resize();
+	_quantized.resize();
+	_binary.resize();
+	// Buffer of the training patches, reused by every sample
+	_input_time = Tensor<Time>(Shape({_filter_width, _filter_height, _input_depth}));
 
 	return Shape({_width, _height, _depth});
 }
 
 bool Convolution::save_params(const std::string& path) {
-	std::vector<float> weights;
-	for(size_t i=0; i<_filter_width; i++) {
-		for(size_t j=0; j<_filter_height; j++) {
-			for(size_t k=0; k<_input_depth; k++) {
-				for(size_t l=0; l<_filter_number; l++) {
-					weights.emplace_back(_w.at(i, j, k, l));
-				}
-			}
-		}
-	}
-	std::vector<float> thresholds;
-	for(size_t i=0; i<_filter_number; i++) {
-		thresholds.emplace_back(_th.at(i));
-	}
+	// The (x, y, z, filter) order of the numpy arrays is the storage order of the tensors, copied in one pass
+	std::vector<float> weights(_w.begin(), _w.end());
+	std::vector<float> thresholds(_th.begin(), _th.end());
 	const bool fortran_order{false};
 	const std::vector<long unsigned> shape_weights{_filter_width, _filter_height, _input_depth, _filter_number};
 	npy::SaveArrayAsNumpy(path + "/weights.npy", fortran_order, shape_weights.size(), shape_weights.data(), weights);    
@@ -94,30 +106,30 @@ bool Convolution::save_params(const std::string& path) {
 	return true;
 }
 
+const tool::QuantizationReport &Convolution::quantization_report() const {
+	return _quantized.report();
+}
+
 bool Convolution::load_params(const std::string& path) {
 	bool fortran_order = false;
 	// Weights
 	std::vector<float> weights;
 	std::vector<long unsigned> shape_weights{_filter_width, _filter_height, _input_depth, _filter_number};	
 	npy::LoadArrayFromNumpy(path + "/weights.npy", shape_weights, fortran_order, weights);
-	int index = 0;
-	for(size_t x=0; x<_filter_width; x++) {
-		for(size_t y=0; y<_filter_height; y++) {
-			for(size_t z=0; z<_input_depth; z++) {
-				for(size_t t=0; t<_filter_number; t++) {
-					_w.at(x, y, z, t) = weights.at(index);
-					index++;
-				}
-			}
-		}
+	if(weights.size() != _w.shape().product()) {
+		throw std::runtime_error("Convolution: unexpected size of "+path+"/weights.npy");
 	}
+	std::copy(std::begin(weights), std::end(weights), _w.begin());
 	// Thresholds
 	std::vector<float> thresholds;
 	std::vector<long unsigned> shape_thresholds{_filter_number};	
 	npy::LoadArrayFromNumpy(path + "/thresholds.npy", shape_thresholds, fortran_order, thresholds);
-	for(size_t index=0; index<thresholds.size(); index++) {
-		_th.at(index) = thresholds.at(index);
+	if(thresholds.size() != _th.shape().product()) {
+		throw std::runtime_error("Convolution: unexpected size of "+path+"/thresholds.npy");
 	}
+	std::copy(std::begin(thresholds), std::end(thresholds), _th.begin());
+	_quantized.invalidate();
+	_binary.invalidate();
 	return true;
 }
 
@@ -128,6 +140,7 @@ size_t Convolution::train_pass_number() const {
 void Convolution::process_train_sample(const std::string& label, Tensor<float>& sample, size_t current_pass, size_t current_index, size_t number) {
 
 	if(current_index == 0) {
+		_current_epoch_number = current_pass;
 		if(current_pass < _epoch_number) {
 			_current_width = 1;
 			_current_height = 1;
@@ -142,8 +155,10 @@ void Convolution::process_train_sample(const std::string& label, Tensor<float>&
 	}
 
 
-	std::vector<Spike> input_spike;
-	std::vector<Spike> output_spike;
+	std::vector<Spike> &input_spike = _input_spike;
+	std::vector<Spike> &output_spike = _output_spike;
+	input_spike.clear();
+	output_spike.clear();
 
 	if(current_pass < _epoch_number) {
 		size_t x = 0;
@@ -159,20 +174,11 @@ void Convolution::process_train_sample(const std::string& label, Tensor<float>&
 			y = rand_y(experiment()->random_generator());
 		}
 
-		Tensor<Time> input_time(Shape({_filter_width, _filter_height, _input_depth}));
-		for (size_t cx = 0; cx < _filter_width; cx++)
-		{
-			for (size_t cy = 0; cy < _filter_height; cy++)
-			{
-				for (size_t cz = 0; cz < _input_depth; cz++)
-				{
-					if (sample.shape().number() > 3)
-						input_time.at(cx, cy, cz) = sample.at(cx + x, cy + y, cz, 0);
-					else
-						input_time.at(cx, cy, cz) = sample.at(cx + x, cy + y, cz);
-				}
-			}
-		}
+		Tensor<Time> &input_time = _input_time;
+		TensorView<const Time> window = sample.view();
+		if (sample.shape().number() > 3)
+			window = window.slice(3, 0);
+		input_time.view().assign(window.narrow(0, x, _filter_width).narrow(1, y, _filter_height));
 		SpikeConverter::to_spike(input_time, input_spike);
 		train(label, input_spike, input_time, output_spike);
 	}
@@ -181,7 +187,7 @@ void Convolution::process_train_sample(const std::string& label, Tensor<float>&
 		SpikeConverter::to_spike(sample, input_spike);
 		_sample_number = number;
 		test(label, input_spike, sample, output_spike);
-		sample = Tensor<float>(shape());
+		sample.resize(shape());
 		SpikeConverter::from_spike(output_spike, sample);
 	}
 
@@ -198,21 +204,35 @@ void Convolution::process_test_sample(const std::string& label, Tensor<float>& s
 	}
 
 	//std::cout << "Process test sample " << number << " " << current_index << " label : " << label << std::endl;
-	std::vector<Spike> input_spike;
+	std::vector<Spike> &input_spike = _input_spike;
+	std::vector<Spike> &output_spike = _output_spike;
+	input_spike.clear();
+	output_spike.clear();
 	SpikeConverter::to_spike(sample, input_spike);
-	std::vector<Spike> output_spike;
 	_sample_number = number;
 	test(label, input_spike, sample, output_spike);
-	sample = Tensor<float>(shape());
+	sample.resize(shape());
 	SpikeConverter::from_spike(output_spike, sample);
 }
 
 void Convolution::train(const std::string&, const std::vector<Spike>& input_spike, const Tensor<Time>& input_time, std::vector<Spike>& output_spike) {
+	tool::Counters::add(index(), tool::Counters::InputSpikes, input_spike.size());
+	_quantized.invalidate();
+	_binary.invalidate();
 	_impl.train(input_spike, input_time, output_spike);
 }
 
 void Convolution::test(const std::string&, const std::vector<Spike>& input_spike, const Tensor<Time>& input_time, std::vector<Spike>& output_spike) {
-	_impl.test(input_spike, input_time, output_spike);
+	tool::Counters::add(index(), tool::Counters::InputSpikes, input_spike.size());
+	if(_binary_infer)
+		_binary.test(input_spike, input_time, output_spike);
+	else if(_quantized_infer)
+		_quantized.test(input_spike, input_time, output_spike);
+	else if(_dense_bins > 0)
+		_dense.test(input_spike, input_time, output_spike);
+	else
+		_impl.test(input_spike, input_time, output_spike);
+	tool::Counters::add(index(), tool::Counters::OutputSpikes, output_spike.size());
 }
 
 void Convolution::on_epoch_end() {
@@ -287,6 +307,424 @@ void Convolution::plot_evolution(bool only_in_train) {
 }
 #endif
 
+//
+//	ConvolutionDenseImpl
+//
+
+static constexpr uint16_t NoBin = std::numeric_limits<uint16_t>::max();
+static constexpr uint32_t NoInput = std::numeric_limits<uint32_t>::max();
+
+/**
+ * @brief Adds the weight rows of the synapses [synapse_begin, synapse_end) to the potentials a of a position, after copying them
+ * to previous, and lists in crossing the neurons that have not fired and are now above their threshold. The potentials of a
+ * vector of filters stay in a register across the synapses.
+ */
+static void _integrate_bin(float *a, float *previous, const float *w, const uint32_t *synapse_begin, const uint32_t *synapse_end, size_t synapse_offset,
+						   const float *th, const uint8_t *fired, size_t depth, std::vector<size_t> &crossing)
+{
+	size_t z = 0;
+	crossing.clear();
+
+#ifdef __AVX2__
+	for (; z + 8 <= depth; z += 8)
+	{
+		__m256 potentials = _mm256_loadu_ps(a + z);
+		_mm256_storeu_ps(previous + z, potentials);
+		for (const uint32_t *e = synapse_begin; e != synapse_end; e++)
+			potentials = _mm256_add_ps(potentials, _mm256_loadu_ps(w + (*e - synapse_offset) * depth + z));
+		_mm256_storeu_ps(a + z, potentials);
+
+		__m256i not_fired = _mm256_cmpeq_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(fired + z))), _mm256_setzero_si256());
+		__m256i above = _mm256_castps_si256(_mm256_cmp_ps(potentials, _mm256_loadu_ps(th + z), _CMP_GE_OQ));
+		for (uint32_t mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(above, not_fired))); mask != 0; mask &= mask - 1)
+			crossing.push_back(z + __builtin_ctz(mask));
+	}
+#endif
+
+	for (; z < depth; z++)
+	{
+		previous[z] = a[z];
+		for (const uint32_t *e = synapse_begin; e != synapse_end; e++)
+			a[z] += w[(*e - synapse_offset) * depth + z];
+		if (!fired[z] && a[z] >= th[z])
+			crossing.push_back(z);
+	}
+}
+
+_priv::ConvolutionDenseImpl::ConvolutionDenseImpl(Convolution &model) :
+	_model(model), _inputs(), _entries(), _bin_offset(), _bin(), _rank(), _order(), _crossing(), _trigger(), _previous(), _a(), _fired(), _won()
+{
+}
+
+void _priv::ConvolutionDenseImpl::resize()
+{
+	_a = Tensor<float>(Shape({_model.width(), _model.height(), _model.depth()}));
+	_previous.resize(_model.width() * _model.height() * _model.depth());
+	_fired.assign(_model.width() * _model.height() * _model.depth(), 0);
+	_won.assign(_model.width() * _model.height(), 0);
+}
+
+void _priv::ConvolutionDenseImpl::test(const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike)
+{
+	size_t bin_number = _model._dense_bins;
+	if (bin_number >= NoBin)
+		throw std::runtime_error("Convolution: dense_bins should be < " + std::to_string(NoBin));
+
+	size_t input_width = input_time.shape().dim(0);
+	size_t input_height = input_time.shape().dim(1);
+	size_t input_depth = input_time.shape().dim(2);
+	size_t filter_width = _model._filter_width;
+	size_t filter_height = _model._filter_height;
+	size_t width = _model._current_width;
+	size_t height = _model._current_height;
+	size_t depth = _model.depth();
+
+	// Rows of the im2col matrix: the output positions in (x, y) order, columns: the (x, y, z) order of the weights,
+	// so that the product with the (patch, filter) view of w gives the potentials in the layout of _a
+	size_t positions = width * height;
+	size_t patch = filter_width * filter_height * input_depth;
+	if (patch * depth != _model._w.shape().product())
+		throw std::runtime_error("Convolution: unexpected input depth " + std::to_string(input_depth));
+
+	// Bin of each input neuron, and rank of its spike in input_spike, the order in which the event-driven engine integrates them
+	_bin.assign(input_time.shape().product(), NoBin);
+	_rank.resize(input_time.shape().product());
+	for (size_t r = 0; r < input_spike.size(); r++)
+	{
+		const Spike &spike = input_spike[r];
+		size_t i = (static_cast<size_t>(spike.x) * input_height + spike.y) * input_depth + spike.z;
+		_bin[i] = static_cast<uint16_t>(std::min(static_cast<size_t>(std::max(spike.time, 0.0f) * bin_number), bin_number - 1));
+		_rank[i] = static_cast<uint32_t>(r);
+	}
+
+	// im2col of the index of the firing inputs (NoInput for the padding and the neurons that don't fire), and its non-zero
+	// entries grouped by bin: the entries of bin b are in _entries[_bin_offset[b], _bin_offset[b + 1]), by increasing position
+	_inputs.assign(positions * patch, NoInput);
+	_bin_offset.assign(bin_number + 1, 0);
+	for (size_t x = 0; x < width; x++)
+	{
+		for (size_t y = 0; y < height; y++)
+		{
+			uint32_t *row = _inputs.data() + (x * height + y) * patch;
+			for (size_t w_x = 0; w_x < filter_width; w_x++)
+			{
+				size_t input_x = x * _model._stride_x + w_x;
+				if (input_x < _model._padding_x || input_x - _model._padding_x >= input_width)
+					continue;
+				input_x -= _model._padding_x;
+				for (size_t w_y = 0; w_y < filter_height; w_y++)
+				{
+					size_t input_y = y * _model._stride_y + w_y;
+					if (input_y < _model._padding_y || input_y - _model._padding_y >= input_height)
+						continue;
+					input_y -= _model._padding_y;
+					for (size_t z = 0; z < input_depth; z++)
+					{
+						size_t i = (input_x * input_height + input_y) * input_depth + z;
+						if (_bin[i] != NoBin)
+						{
+							row[(w_x * filter_height + w_y) * input_depth + z] = static_cast<uint32_t>(i);
+							_bin_offset[_bin[i] + 1]++;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::partial_sum(std::begin(_bin_offset), std::end(_bin_offset), std::begin(_bin_offset));
+	_entries.resize(_bin_offset.back());
+	std::vector<uint32_t> cursor(std::begin(_bin_offset), std::end(_bin_offset) - 1);
+	for (size_t e = 0; e < positions * patch; e++)
+	{
+		if (_inputs[e] != NoInput)
+			_entries[cursor[_bin[_inputs[e]]]++] = static_cast<uint32_t>(e);
+	}
+
+	_a.fill(0);
+	std::fill(std::begin(_fired), std::end(_fired), 0);
+	std::fill(std::begin(_won), std::end(_won), 0);
+
+	const float *th = _model._th.begin();
+	const float *w = _model._w.begin();
+	size_t remaining = positions * depth;
+	uint64_t integrations = 0;
+
+	for (size_t bin = 0; bin < bin_number && remaining > 0; bin++)
+	{
+		const uint32_t *entry_begin = _entries.data() + _bin_offset[bin];
+		const uint32_t *entry_end = _entries.data() + _bin_offset[bin + 1];
+		size_t bin_output = output_spike.size();
+
+		const uint32_t *entry = entry_begin;
+		while (entry != entry_end)
+		{
+			// Entries of the position in this bin
+			size_t p = *entry / patch;
+			const uint32_t *position_begin = entry;
+			while (entry != entry_end && *entry < (p + 1) * patch)
+				entry++;
+
+			if (_won[p])
+				continue;
+
+			// Product of the row of the im2col matrix with the weights, restricted to its synapses firing in the bin: the potentials
+			// accumulate over the bins, the ones before the bin are kept for the replay. With non-negative weights, only the neurons
+			// above their threshold at the end of the bin have crossed it during the bin
+			float *potential = _previous.data() + p * depth;
+			uint8_t *fired = _fired.data() + p * depth;
+			integrations += (entry - position_begin) * depth;
+			_integrate_bin(_a.begin() + p * depth, potential, w, position_begin, entry, p * patch, th, fired, depth, _crossing);
+			if (_crossing.empty())
+				continue;
+
+			// Replays the spikes of the bin in the order of the event-driven engine, from the potentials before the bin, to find
+			// the spike that triggers each of these neurons
+			_order.clear();
+			for (const uint32_t *e = position_begin; e != entry; e++)
+				_order.emplace_back(_rank[_inputs[*e]], static_cast<uint32_t>(*e - p * patch));
+			std::sort(std::begin(_order), std::end(_order));
+
+			// _order.size() when the sums in this order stay below the threshold
+			uint32_t first = _order.size();
+			_trigger.resize(_crossing.size());
+			for (size_t c = 0; c < _crossing.size(); c++)
+			{
+				size_t z = _crossing[c];
+				float value = potential[z];
+				uint32_t i = 0;
+				for (; i < _order.size(); i++)
+				{
+					value += w[_order[i].second * depth + z];
+					if (value >= th[z])
+						break;
+				}
+				_trigger[c] = i;
+				first = std::min(first, i);
+			}
+
+			if (first == _order.size())
+				continue;
+
+			// WTA inhibition : one spike per spatial position, the neurons triggered by the earliest spike fire together
+			for (size_t c = 0; c < _crossing.size(); c++)
+			{
+				if (_trigger[c] == _order.size() || (_model._wta_infer && _trigger[c] != first))
+					continue;
+				output_spike.emplace_back(input_spike[_order[_trigger[c]].first].time, p / height, p % height, _crossing[c]);
+				fired[_crossing[c]] = 1;
+				remaining--;
+			}
+
+			if (_model._wta_infer)
+			{
+				_won[p] = 1;
+				for (size_t z = 0; z < depth; z++)
+				{
+					if (!fired[z])
+					{
+						fired[z] = 1;
+						remaining--;
+					}
+				}
+			}
+		}
+
+		// The event-driven engine emits the spikes in the order of the input spikes
+		std::stable_sort(std::begin(output_spike) + bin_output, std::end(output_spike), TimeComparator());
+	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+
+	draw_progress(_model._sample_count, _model._sample_number);
+
+	if (_model._sample_count == _model._sample_number)
+		_model._sample_count = 0;
+}
+
+_priv::ConvolutionQuantizedImpl::ConvolutionQuantizedImpl(Convolution &model) :
+	_model(model), _weights(), _report(), _a16(), _a32(), _won(), _reference()
+{
+}
+
+void _priv::ConvolutionQuantizedImpl::resize()
+{
+	_won.assign(_model.width() * _model.height(), 0);
+	invalidate();
+}
+
+void _priv::ConvolutionQuantizedImpl::invalidate()
+{
+	_weights.invalidate();
+}
+
+const tool::QuantizationReport &_priv::ConvolutionQuantizedImpl::report() const
+{
+	return _report;
+}
+
+void _priv::ConvolutionQuantizedImpl::test(const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike)
+{
+	size_t depth = _model.depth();
+
+	if (!_weights.ready())
+	{
+		// The rows of w(x, y, z, filter) are already the synapses of the filters
+		_weights.quantize(_model._w, _model._th, _model._w.shape().product() / depth, depth);
+		_report.reset();
+	}
+
+	bool calibration = _report.sample_number() < _model._quantization_calibration;
+	if (calibration)
+	{
+		_reference.clear();
+		_model._impl.test(input_spike, input_time, _reference);
+	}
+
+	if (_weights.narrow())
+	{
+		_a16.resize(_model.width() * _model.height() * depth);
+		_test(input_spike, output_spike, _a16);
+	}
+	else
+	{
+		_a32.resize(_model.width() * _model.height() * depth);
+		_test(input_spike, output_spike, _a32);
+	}
+
+	if (calibration)
+	{
+		_report.add(_reference, output_spike);
+		if (_report.sample_number() == _model._quantization_calibration)
+			std::cout << "Quantization calibration of " << _model.name() << ": " << _report.to_string() << std::endl;
+	}
+
+	draw_progress(_model._sample_count, _model._sample_number);
+
+	if (_model._sample_count == _model._sample_number)
+		_model._sample_count = 0;
+}
+
+template<typename Potential>
+void _priv::ConvolutionQuantizedImpl::_test(const std::vector<Spike> &input_spike, std::vector<Spike> &output_spike, std::vector<Potential> &a)
+{
+	size_t depth = _model.depth();
+	size_t height = _model.height();
+	size_t input_depth = _model._input_depth;
+	const Potential *th = _weights.thresholds<Potential>();
+
+	std::fill(std::begin(a), std::end(a), 0);
+	std::fill(std::begin(_won), std::end(_won), 0);
+
+	uint64_t integrations = 0;
+	std::vector<std::tuple<uint16_t, uint16_t, uint16_t, uint16_t>> output_spikes;
+
+	for (const Spike &spike : input_spike)
+	{
+		output_spikes.clear();
+		_model.forward(spike.x, spike.y, output_spikes);
+
+		for (const auto &entry : output_spikes)
+		{
+			uint16_t x = std::get<0>(entry);
+			uint16_t y = std::get<1>(entry);
+			uint16_t w_x = std::get<2>(entry);
+			uint16_t w_y = std::get<3>(entry);
+
+			// WTA inhibition : one spike per spatial position
+			if (_model._wta_infer && _won[x * height + y])
+				continue;
+
+			// The inhibited neurons sit at the floor of the potentials, they integrate without reaching their threshold
+			Potential *potential = a.data() + (x * height + y) * depth;
+			const uint8_t *weights = _weights.row((w_x * _model._filter_height + w_y) * input_depth + spike.z);
+			integrations += depth;
+			if (!tool::QuantizedWeights::integrate(potential, weights, th, depth))
+				continue;
+
+			for (size_t z = 0; z < depth; z++)
+			{
+				if (potential[z] >= th[z])
+				{
+					output_spike.emplace_back(spike.time, x, y, z);
+					potential[z] = tool::QuantizedWeights::Floor<Potential>();
+				}
+			}
+
+			if (_model._wta_infer)
+				_won[x * height + y] = 1;
+		}
+	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+}
+
+_priv::ConvolutionBinaryImpl::ConvolutionBinaryImpl(Convolution &model) : _model(model), _weights(), _counters(), _won()
+{
+}
+
+void _priv::ConvolutionBinaryImpl::resize()
+{
+	_won.assign(_model.width() * _model.height(), 0);
+	invalidate();
+}
+
+void _priv::ConvolutionBinaryImpl::invalidate()
+{
+	_weights.invalidate();
+}
+
+void _priv::ConvolutionBinaryImpl::test(const std::vector<Spike> &input_spike, const Tensor<Time> &, std::vector<Spike> &output_spike)
+{
+	size_t depth = _model.depth();
+	size_t height = _model.height();
+
+	if (!_weights.ready())
+	{
+		_weights.binarize(_model._w, _model._th, _model._w.shape().product() / depth, depth, _model._binary_cut);
+		std::cout << "Binarization of " << _model.name() << ": " << _weights.to_string() << std::endl;
+	}
+
+	_weights.reset(_counters, _model.width() * height);
+	std::fill(std::begin(_won), std::end(_won), 0);
+
+	uint64_t integrations = 0;
+	std::vector<std::tuple<uint16_t, uint16_t, uint16_t, uint16_t>> output_spikes;
+
+	for (const Spike &spike : input_spike)
+	{
+		output_spikes.clear();
+		_model.forward(spike.x, spike.y, output_spikes);
+
+		for (const auto &entry : output_spikes)
+		{
+			uint16_t x = std::get<0>(entry);
+			uint16_t y = std::get<1>(entry);
+			uint16_t w_x = std::get<2>(entry);
+			uint16_t w_y = std::get<3>(entry);
+
+			// WTA inhibition : one spike per spatial position
+			if (_model._wta_infer && _won[x * height + y])
+				continue;
+
+			size_t synapse = (w_x * _model._filter_height + w_y) * _model._input_depth + spike.z;
+			size_t emitted = _weights.integrate(_counters.data() + (x * height + y) * _weights.counter_size(), synapse, true, [&](size_t z)
+												{ output_spike.emplace_back(spike.time, x, y, z); });
+			integrations += depth;
+
+			if (emitted > 0 && _model._wta_infer)
+				_won[x * height + y] = 1;
+		}
+	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+
+	draw_progress(_model._sample_count, _model._sample_number);
+
+	if (_model._sample_count == _model._sample_number)
+		_model._sample_count = 0;
+}
+
 #ifdef SMID_AVX256
 #include <immintrin.h>
 
@@ -353,8 +791,11 @@ void _priv::ConvolutionImpl::train(const std::vector<Spike>& input_spike, const
 		_mm256_maskstore_ps(_a.ptr_index(n*AVX_256_N), __mask, __c1);
 	}
 
-	for(const Spike& spike : input_spike) {
+	// All the filters integrate each input spike (until the first one fires)
+	uint64_t integrations = 0;
 
+	for(const Spike& spike : input_spike) {
+		integrations += depth;
 
 		for(size_t i=0; i<n; i++) {
 			__m256 __w = _mm256_loadu_ps(w.ptr(spike.x, spike.y, spike.z, i*AVX_256_N));
@@ -394,6 +835,8 @@ void _priv::ConvolutionImpl::train(const std::vector<Spike>& input_spike, const
 							}
 						}
 
+						tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+						tool::Counters::add(_model.index(), tool::Counters::StdpUpdates, _model._filter_width*_model._filter_height*_model._input_depth);
 						return;
 					}
 				}
@@ -433,11 +876,15 @@ void _priv::ConvolutionImpl::train(const std::vector<Spike>& input_spike, const
 							}
 						}
 					}
+					tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+					tool::Counters::add(_model.index(), tool::Counters::StdpUpdates, _model._filter_width*_model._filter_height*_model._input_depth);
 					return;
 				}
 			}
 		}
 	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
 }
 
 void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const Tensor<Time>&, std::vector<Spike>& output_spike) {
@@ -473,6 +920,8 @@ void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const T
 		_wta.fill(false);
 	}
 
+	uint64_t integrations = 0;
+
 	for(const Spike& spike : input_spike) {
 
 		std::vector<std::tuple<uint16_t, uint16_t, uint16_t, uint16_t>> output_spikes;
@@ -488,6 +937,8 @@ void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const T
 				continue;
 			}
 
+			integrations += depth;
+
 			for(size_t i=0; i<n; i++) {
 				__m256 __w = _mm256_loadu_ps(w.ptr(w_x, w_y, spike.z, i*AVX_256_N));
 				__m256 __a = _mm256_loadu_ps(_a.ptr(x, y, i*AVX_256_N));
@@ -534,6 +985,8 @@ void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const T
 			}
 		}
 	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
 }
 
 #else
@@ -545,6 +998,7 @@ void _priv::ConvolutionImpl::resize()
 {
 	_a = Tensor<float>(Shape({_model.width(), _model.height(), _model.depth()}));
 	_inh = Tensor<bool>(Shape({_model.width(), _model.height(), _model.depth()}));
+	_wta = Tensor<bool>(Shape({_model.width(), _model.height()}));
 }
 
 void _priv::ConvolutionImpl::train(const std::string &label, const std::vector<Spike> &input_spike, const Tensor<Time> &input_time,
@@ -567,16 +1021,22 @@ void _priv::ConvolutionImpl::train(const std::vector<Spike> &input_spike, const
 	size_t depth = _model.depth();
 	Tensor<float> &w = _model._w;
 	Tensor<float> &th = _model._th;
+	TensorAccessor<float, 3> a = _a.accessor<3>();
+	TensorAccessor<float, 4> weights = w.accessor<4>();
+	TensorAccessor<const Time, 3> time = input_time.accessor<3>();
 
 	std::fill(std::begin(_a), std::end(_a), 0);
 
+	uint64_t integrations = 0;
+
 	for (const Spike &spike : input_spike)
 	{
 		for (size_t z = 0; z < depth; z++)
 		{
-			_a.at(0, 0, z) += w.at(spike.x, spike.y, spike.z, z);
+			a(0, 0, z) += weights(spike.x, spike.y, spike.z, z);
+			integrations++;
 
-			if (_a.at(0, 0, z) >= th.at(z))
+			if (a(0, 0, z) >= th.at(z))
 			{
 				for (size_t z1 = 0; z1 < depth; z1++)
 				{
@@ -591,37 +1051,44 @@ void _priv::ConvolutionImpl::train(const std::vector<Spike> &input_spike, const
 				for (size_t x = 0; x < _model._filter_width; x++)
 					for (size_t y = 0; y < _model._filter_height; y++)
 						for (size_t zi = 0; zi < _model._input_depth; zi++)
-							w.at(x, y, zi, z) = _model._stdp->process(w.at(x, y, zi, z), input_time.at(x, y, zi), spike.time);
+							weights(x, y, zi, z) = _model._stdp->process(weights(x, y, zi, z), time(x, y, zi), spike.time);
+				tool::Counters::add(_model.index(), tool::Counters::StdpUpdates, _model._filter_width * _model._filter_height * _model._input_depth);
 
 				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._draw)
 				{
-					std::filesystem::create_directories(_model._file_path + "/Weights/" + _expName + "/" + _layerIndex + "/");
-					LogSpikingNeuron(_model._file_path + "/Weights/" + _expName + "/" + _layerIndex + "/" + _expName, _label, z);
+					_model._weight_logger.log_event(_model._file_path + "/Weights/" + _expName + "/" + _layerIndex + "/" + _expName, _label, z);
 					if (_model._drawn_weights == 0)
 					{ //+"_L:" + _label
+						std::filesystem::create_directories(_model._file_path + "/Weights/" + _expName + "/" + _layerIndex + "/");
 						Tensor<float>::draw_weight_tensor(_model._file_path + "/Weights/" + _expName + "/" + _layerIndex + "/" + _expName + "_N:" + std::to_string(z), w);
 						_model._drawn_weights = 1;
 					}
 				}
 
-				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._save_weights)
+				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._save_weights && tool::WeightLogger::is_snapshot(_model._saved_weights++, _model._snapshot_interval))
 				{
-					std::filesystem::create_directories(_model._file_path + "/Weights/" + _expName + "/" + _layerIndex + "/");
-					SaveWeights(_model._file_path + "/Weights/" + _expName + "/" + _layerIndex + "/" + _expName + ".json", _label, w);
+					_model._weight_logger.log_weights(_model._file_path + "/Weights/" + _expName + "/" + _layerIndex + "/" + _expName, _label, w);
 				}
 
 				if (_model._inhibition)
+				{
+					tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
 					return;
+				}
 			}
 		}
 	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
 }
 
 void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const Tensor<Time>&, std::vector<Spike>& output_spike) {
 	size_t depth = _model.depth();
 	Tensor<float>& w = _model._w;
 	Tensor<float>& th = _model._th;
-
+	TensorAccessor<float, 3> a = _a.accessor<3>();
+	TensorAccessor<bool, 3> inh = _inh.accessor<3>();
+	TensorAccessor<float, 4> weights = w.accessor<4>();
 
 	std::fill(std::begin(_a), std::end(_a), 0);
 	std::fill(std::begin(_inh), std::end(_inh), false);
@@ -629,6 +1096,9 @@ void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const T
 	if(_model._wta_infer) {
 		_wta.fill(false);
 	}
+
+	uint64_t integrations = 0;
+
 	for(const Spike& spike : input_spike) {
 
 		// Get the spatial position of output neurons integrating inputs coming from the spatial position of the input spike
@@ -653,7 +1123,7 @@ void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const T
 			for(size_t z=0; z<depth; z++) {
 				
 				// Single spike inhibition : one spike per neuron
-				if(_inh.at(x, y, z)) {
+				if(inh(x, y, z)) {
 					continue;
 				}
 
@@ -666,13 +1136,14 @@ void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const T
 
 				// Update the membrane potential of the output neuron 
 				// with the weight associated to the input neuron 
-				_a.at(x, y, z) += w.at(w_x, w_y, spike.z, z);
+				a(x, y, z) += weights(w_x, w_y, spike.z, z);
+				integrations++;
 				// When the membrane potential reaches the threshold of the channel
-				if(_a.at(x, y, z) >= th.at(z)) {
+				if(a(x, y, z) >= th.at(z)) {
 					// Add a spike to the output vector
 					output_spike.emplace_back(spike.time, x, y, z);
 					// Deactivate the neuron
-					_inh.at(x, y, z) = true;
+					inh(x, y, z) = true;
 					// Add WTA on the spatial position
 					if (_model._wta_infer) {
 						_wta.at(x, y) = true;
@@ -683,6 +1154,8 @@ void _priv::ConvolutionImpl::test(const std::vector<Spike>& input_spike, const T
 	}
 	//   });
 
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+
 	draw_progress(_model._sample_count, _model._sample_number);
 
 	if (_model._sample_count == _model._sample_number)
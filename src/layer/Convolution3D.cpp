@@ -2,6 +2,7 @@
 #include "Experiment.h"
 #include <execution>
 #include <mutex>
+#include "tool/Counters.h"
 
 using namespace layer;
 
@@ -16,11 +17,12 @@ static RegisterClassParameter<Convolution3D, LayerFactory> _register("Convolutio
  * @param stdp learning rule - spike time dependant plasticity
  */
 Convolution3D::Convolution3D() : Layer4D(_register),
-								 _inhibition(true), _model_path(""), _draw(false), _epoch_number(0), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0),
-								 _w(), _th(), _stdp(nullptr), _input_depth(0), _input_conv_depth(0), _impl(*this)
+								 _epoch_number(0), _saved_weights(0), _snapshot_interval(0), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0), _draw(false), _save_weights(false), _inhibition(true), _model_path(""),
+								 _w(), _th(), _stdp(nullptr), _input_depth(0), _input_conv_depth(0), _quantized_infer(false), _quantization_calibration(0), _binary_infer(false), _binary_cut(0.5f), _impl(*this), _quantized(*this), _binary(*this)
 {
 	add_parameter("draw", _draw);
 	add_parameter("save_weights", _save_weights);
+	add_parameter("snapshot_interval", _snapshot_interval, static_cast<uint32_t>(0));
 	add_parameter("save_random_start", _save_random_start);
 	add_parameter("log_spiking_neuron", _log_spiking_neuron);
 	add_parameter("inhibition", _inhibition);
@@ -32,17 +34,22 @@ Convolution3D::Convolution3D() : Layer4D(_register),
 	add_parameter("w", _w);						  // synaptic weights
 	add_parameter("th", _th);					  // internal threashould of neuron
 	add_parameter("stdp", _stdp);				  // learning rule - spike time dependant plasticity
+	add_parameter("quantized_infer", _quantized_infer, false);
+	add_parameter("quantization_calibration", _quantization_calibration, static_cast<uint32_t>(0));
+	add_parameter("binary_infer", _binary_infer, false);
+	add_parameter("binary_cut", _binary_cut, 0.5f);
 }
 
 Convolution3D::Convolution3D(size_t filter_number, size_t filter_width, size_t filter_height, size_t filter_depth, std::string model_path,
 							 size_t stride_x, size_t stride_y, size_t stride_k, size_t padding_x, size_t padding_y, size_t padding_k)
 	: Layer4D(_register, filter_number, filter_width, filter_height, filter_depth, stride_x, stride_y, stride_k, padding_x, padding_y, padding_k),
-	  _inhibition(true), _model_path(model_path), _draw(false), _save_weights(false), _save_random_start(false), _log_spiking_neuron(false), _annealing(1.0),
-	  _min_th(0), _t_obj(0), _lr_th(0), _sample_number(0), _sample_count(0), _spike_count(0), _drawn_weights(0), _saved_weights(0), _logged_spiking_neuron(0), _saved_random_start(0),
-	  _w(), _th(), _stdp(nullptr), _input_depth(0), _impl(*this)
+	  _sample_number(0), _spike_count(0), _sample_count(0), _drawn_weights(0), _saved_weights(0), _snapshot_interval(0), _saved_random_start(0),
+	  _logged_spiking_neuron(0), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0), _draw(false), _log_spiking_neuron(false), _save_weights(false), _save_random_start(false), _inhibition(true), _model_path(model_path),
+	  _w(), _th(), _stdp(nullptr), _input_depth(0), _quantized_infer(false), _quantization_calibration(0), _binary_infer(false), _binary_cut(0.5f), _impl(*this), _quantized(*this), _binary(*this)
 {
 	add_parameter("draw", _draw);
 	add_parameter("save_weights", _save_weights);
+	add_parameter("snapshot_interval", _snapshot_interval, static_cast<uint32_t>(0));
 	add_parameter("save_random_start", _save_random_start);
 	add_parameter("log_spiking_neuron", _log_spiking_neuron);
 	add_parameter("inhibition", _inhibition);
@@ -54,6 +61,10 @@ Convolution3D::Convolution3D(size_t filter_number, size_t filter_width, size_t f
 	add_parameter("w", _w);
 	add_parameter("th", _th);
 	add_parameter("stdp", _stdp);
+	add_parameter("quantized_infer", _quantized_infer, false);
+	add_parameter("quantization_calibration", _quantization_calibration, static_cast<uint32_t>(0));
+	add_parameter("binary_infer", _binary_infer, false);
+	add_parameter("binary_cut", _binary_cut, 0.5f);
 
 	// _patch_coo_collection = false;
 
@@ -82,6 +93,10 @@ Shape Convolution3D::compute_shape(const Shape &previous_shape)
 	parameter<Tensor<float>>("th").shape(_filter_number);
 
 	_impl.resize();
+	_quantized.resize();
+	_binary.resize();
+	// Buffer of the training patches, reused by every sample
+	_input_time = Tensor<Time>(Shape({_filter_width, _filter_height, _input_depth, _filter_conv_depth}));
 	// TODO: _conv_depth or filter_depth here?
 	return Shape({_width, _height, _depth, _conv_depth});
 }
@@ -122,8 +137,10 @@ void Convolution3D::process_train_sample(const std::string &label, Tensor<float>
 		}
 	}
 
-	std::vector<Spike> input_spike;
-	std::vector<Spike> output_spike;
+	std::vector<Spike> &input_spike = _input_spike;
+	std::vector<Spike> &output_spike = _output_spike;
+	input_spike.clear();
+	output_spike.clear();
 
 	if (current_pass < _epoch_number)
 	{
@@ -166,20 +183,8 @@ void Convolution3D::process_train_sample(const std::string &label, Tensor<float>
 		// } while (t == 0.0 || t > 1); //(t > 0.0 && t < 1);
 
 		// even if _filter_conv_depth == 1, we are still taking random patches with a temporal depth.
-		Tensor<Time> input_time(Shape({_filter_width, _filter_height, _input_depth, _filter_conv_depth}));
-		for (size_t cx = 0; cx < _filter_height; cx++)
-		{
-			for (size_t cy = 0; cy < _filter_width; cy++)
-			{
-				for (size_t cz = 0; cz < _input_depth; cz++)
-				{
-					for (size_t ck = 0; ck < _filter_conv_depth; ck++)
-					{
-						input_time.at(cx, cy, cz, ck) = sample.at(cx + x, cy + y, cz, ck + k);
-					}
-				}
-			}
-		}
+		Tensor<Time> &input_time = _input_time;
+		input_time.view().assign(sample.view().narrow(0, x, _filter_width).narrow(1, y, _filter_height).narrow(3, k, _filter_conv_depth));
 
 		SpikeConverter::to_spike(input_time, input_spike);
 		train(label, input_spike, input_time, output_spike);
@@ -189,7 +194,7 @@ void Convolution3D::process_train_sample(const std::string &label, Tensor<float>
 		SpikeConverter::to_spike(sample, input_spike);
 		_sample_number = number;
 		test(label, input_spike, sample, output_spike);
-		sample = Tensor<float>(shape());
+		sample.resize(shape());
 		SpikeConverter::from_spike(output_spike, sample);
 	}
 
@@ -209,23 +214,40 @@ void Convolution3D::process_test_sample(const std::string &label, Tensor<float>
 		_current_conv_depth = _conv_depth;
 	}
 
-	std::vector<Spike> input_spike;
+	std::vector<Spike> &input_spike = _input_spike;
+	std::vector<Spike> &output_spike = _output_spike;
+	input_spike.clear();
+	output_spike.clear();
 	SpikeConverter::to_spike(sample, input_spike);
-	std::vector<Spike> output_spike;
 	_sample_number = number;
 	test(label, input_spike, sample, output_spike);
-	sample = Tensor<float>(shape());
+	sample.resize(shape());
 	SpikeConverter::from_spike(output_spike, sample);
 }
 
 void Convolution3D::train(const std::string &label, const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike)
 {
+	tool::Counters::add(index(), tool::Counters::InputSpikes, input_spike.size());
+	_quantized.invalidate();
+	_binary.invalidate();
 	_impl.train(label, input_spike, input_time, output_spike);
 }
 
 void Convolution3D::test(const std::string &, const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike)
 {
-	_impl.test(input_spike, input_time, output_spike);
+	tool::Counters::add(index(), tool::Counters::InputSpikes, input_spike.size());
+	if (_binary_infer)
+		_binary.test(input_spike, input_time, output_spike);
+	else if (_quantized_infer)
+		_quantized.test(input_spike, input_time, output_spike);
+	else
+		_impl.test(input_spike, input_time, output_spike);
+	tool::Counters::add(index(), tool::Counters::OutputSpikes, output_spike.size());
+}
+
+const tool::QuantizationReport &Convolution3D::quantization_report() const
+{
+	return _quantized.report();
 }
 
 void Convolution3D::on_epoch_end()
@@ -406,8 +428,12 @@ void _priv::Convolution3DImpl::train(const std::vector<Spike> &input_spike, cons
 		_mm256_maskstore_ps(_a.ptr_index(n * AVX_256_N), __mask, __c1);
 	}
 
+	// All the filters integrate each input spike (until the first one fires)
+	uint64_t integrations = 0;
+
 	for (const Spike &spike : input_spike)
 	{
+		integrations += depth;
 
 		for (size_t i = 0; i < n; i++)
 		{
@@ -450,6 +476,8 @@ void _priv::Convolution3DImpl::train(const std::vector<Spike> &input_spike, cons
 							}
 						}
 
+						tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+						tool::Counters::add(_model.index(), tool::Counters::StdpUpdates, _model._filter_width * _model._filter_height * _model._input_depth);
 						return;
 					}
 				}
@@ -491,11 +519,15 @@ void _priv::Convolution3DImpl::train(const std::vector<Spike> &input_spike, cons
 							}
 						}
 					}
+					tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+					tool::Counters::add(_model.index(), tool::Counters::StdpUpdates, _model._filter_width * _model._filter_height * _model._input_depth);
 					return;
 				}
 			}
 		}
 	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
 }
 
 void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const Tensor<Time> &, std::vector<Spike> &output_spike)
@@ -536,6 +568,8 @@ void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const
 		_wta.fill(false);
 	}
 
+	uint64_t integrations = 0;
+
 	for (const Spike &spike : input_spike)
 	{
 
@@ -554,6 +588,8 @@ void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const
 				continue;
 			}
 
+			integrations += depth;
+
 			for (size_t i = 0; i < n; i++)
 			{
 				__m256 __w = _mm256_loadu_ps(w.ptr(w_x, w_y, spike.z, spike.k, i * AVX_256_N));
@@ -602,6 +638,8 @@ void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const
 			}
 		}
 	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
 }
 
 #else
@@ -648,12 +686,10 @@ void _priv::Convolution3DImpl::train(const std::vector<Spike> &input_spike, cons
 	_label.erase(0, _exp_name.length() + delimiter.length());
 	std::string _layerIndex = _label.substr(0, _label.find(delimiter));
 	_label.erase(0, _layerIndex.length() + delimiter.length());
-	if (_model._draw || _model._log_spiking_neuron || _model._save_weights || _model._save_random_start)
-		std::filesystem::create_directories(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/");
 
 	if (_model._current_epoch_number == 0 && _model._save_random_start && _model._saved_random_start == 0)
 	{
-		SaveWeights(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name + "_random_start.json", _label, _model._w);
+		_model._weight_logger.log_weights(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name + "_random_start", _label, _model._w);
 		_model._saved_random_start = 1;
 	}
 
@@ -661,17 +697,23 @@ void _priv::Convolution3DImpl::train(const std::vector<Spike> &input_spike, cons
 	size_t conv_depth = _model.conv_depth();
 	Tensor<float> &w = _model._w;
 	Tensor<float> &th = _model._th;
+	TensorAccessor<float, 4> a = _a.accessor<4>();
+	TensorAccessor<float, 5> weights = w.accessor<5>();
+	TensorAccessor<const Time, 4> time = input_time.accessor<4>();
 
 	std::fill(std::begin(_a), std::end(_a), 0);
 
+	uint64_t integrations = 0;
+
 	for (const Spike &spike : input_spike)
 	{
 		for (size_t z = 0; z < depth; z++) // the number of filters
 		{
-			_a.at(0, 0, z, 0) += w.at(spike.x, spike.y, spike.z, z, spike.k);
+			a(0, 0, z, 0) += weights(spike.x, spike.y, spike.z, z, spike.k);
+			integrations++;
 
 			// integrate the weight value in the neurons activation (multiple spikes are integrated to surpass the internal threshould of the neuron)
-			if (_a.at(0, 0, z, 0) >= th.at(z)) // a spike is fired
+			if (a(0, 0, z, 0) >= th.at(z)) // a spike is fired
 			{
 				for (size_t z1 = 0; z1 < depth; z1++)
 				{
@@ -690,12 +732,14 @@ void _priv::Convolution3DImpl::train(const std::vector<Spike> &input_spike, cons
 						for (size_t zi = 0; zi < _model._input_depth; zi++)
 							for (size_t k = 0; k < _model._filter_conv_depth; k++)
 							{
-								w.at(x, y, zi, z, k) = _model._stdp->process(w.at(x, y, zi, z, k), input_time.at(x, y, zi, k), spike.time);
+								weights(x, y, zi, z, k) = _model._stdp->process(weights(x, y, zi, z, k), time(x, y, zi, k), spike.time);
 							}
+				tool::Counters::add(_model.index(), tool::Counters::StdpUpdates, _model._filter_width * _model._filter_height * _model._input_depth * _model._filter_conv_depth);
 
 				/// @brief for visualization.
 				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._draw && _model._drawn_weights == 0)
 				{
+					std::filesystem::create_directories(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/");
 					Tensor<float>::draw_weight_tensor(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name + "_N:" + std::to_string(z), w);
 					_model._drawn_weights = 1;
 				}
@@ -707,20 +751,24 @@ void _priv::Convolution3DImpl::train(const std::vector<Spike> &input_spike, cons
 						std::filesystem::create_directories(_model._file_path + "/UpdatedFilter/" + _model._exp_name + "/");
 						_model._logged_spiking_neuron = 1;
 					}
-					LogUpdatedFilter(_model._file_path + "/UpdatedFilter/" + _model._exp_name + "/" + _model._exp_name + "_" + _layerIndex, z);
+					_model._weight_logger.log_event(_model._file_path + "/UpdatedFilter/" + _model._exp_name + "/" + _model._exp_name + "_" + _layerIndex, _label, z);
 				}
 
-				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._save_weights && _model._saved_weights == 0)
+				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._save_weights && tool::WeightLogger::is_snapshot(_model._saved_weights++, _model._snapshot_interval))
 				{
-					SaveWeights(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name + ".json", _label, w);
-					_model._saved_weights = 1;
+					_model._weight_logger.log_weights(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name, _label, w);
 				}
 
 				if (_model._inhibition)
+				{
+					tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
 					return;
+				}
 			}
 		}
 	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
 }
 
 void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const Tensor<Time> &, std::vector<Spike> &output_spike)
@@ -730,12 +778,17 @@ void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const
 
 	Tensor<float> &w = _model._w;
 	Tensor<float> &th = _model._th;
+	TensorAccessor<float, 4> a = _a.accessor<4>();
+	TensorAccessor<bool, 4> inh = _inh.accessor<4>();
+	TensorAccessor<float, 5> weights = w.accessor<5>();
 
 	std::fill(std::begin(_a), std::end(_a), 0);
 	std::fill(std::begin(_inh), std::end(_inh), false);
 
 	std::mutex _convolution_test_mutex; // mutex to aviod access violation durring multithreaded section
 
+	uint64_t integrations = 0;
+
 	// std::for_each(std::execution::par, input_spike.begin(), input_spike.end(), [&](const Spike &spike)
 	for (const Spike &spike : input_spike)
 	{
@@ -754,21 +807,22 @@ void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const
 			for (size_t z = 0; z < depth; z++)
 			{
 				// The neurons that have their inhibition flag set to ture are ignored.
-				if (_inh.at(x, y, z, k) && _model._inhibition)
+				if (inh(x, y, z, k) && _model._inhibition)
 				{
 					continue;
 				}
 				// The rest of the neurons that have their inh flag set to false get their activations updated.
 				//_convolution_test_mutex.lock();
-				_a.at(x, y, z, k) += w.at(w_x, w_y, spike.z, z, w_k);
+				a(x, y, z, k) += weights(w_x, w_y, spike.z, z, w_k);
+				integrations++;
 				//_convolution_test_mutex.unlock();
 				// If the activation crossed the threshould, the neuron has fired a spike, and it's _inh flag is set to true so that it doesn't fire again.
-				if (_a.at(x, y, z, k) >= th.at(z))
+				if (a(x, y, z, k) >= th.at(z))
 				{
 					//_convolution_test_mutex.lock();
 					output_spike.emplace_back(spike.time, x, y, z, k);
 					// The neuron that fires once is not allowed to fire again in this sample, so _inh is set to true.
-					_inh.at(x, y, z, k) = true;
+					inh(x, y, z, k) = true;
 					//_convolution_test_mutex.unlock();
 
 					/// @brief counting the spikes.
@@ -780,6 +834,8 @@ void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const
 		}
 	}
 	//});
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+
 	draw_progress(_model._sample_count, _model._sample_number);
 
 	if (_model._sample_count == _model._sample_number)
@@ -794,3 +850,214 @@ void _priv::Convolution3DImpl::test(const std::vector<Spike> &input_spike, const
 }
 
 #endif
+
+/**
+ * @brief The weights w(x, y, z, filter, k) as rows of filters indexed by (x, y, z, k), the layout of the integer and binary engines.
+ */
+static Tensor<float> filter_rows(const Tensor<float> &w)
+{
+	const Shape &shape = w.shape();
+	Tensor<float> rows(Shape({shape.dim(0), shape.dim(1), shape.dim(2), shape.dim(4), shape.dim(3)}));
+	for (size_t x = 0; x < shape.dim(0); x++)
+		for (size_t y = 0; y < shape.dim(1); y++)
+			for (size_t zi = 0; zi < shape.dim(2); zi++)
+				for (size_t k = 0; k < shape.dim(4); k++)
+					for (size_t z = 0; z < shape.dim(3); z++)
+						rows.at(x, y, zi, k, z) = w.at(x, y, zi, z, k);
+	return rows;
+}
+
+_priv::Convolution3DQuantizedImpl::Convolution3DQuantizedImpl(Convolution3D &model) : _model(model), _weights(), _report(), _a16(), _a32(), _reference()
+{
+}
+
+void _priv::Convolution3DQuantizedImpl::resize()
+{
+	invalidate();
+}
+
+void _priv::Convolution3DQuantizedImpl::invalidate()
+{
+	_weights.invalidate();
+}
+
+const tool::QuantizationReport &_priv::Convolution3DQuantizedImpl::report() const
+{
+	return _report;
+}
+
+void _priv::Convolution3DQuantizedImpl::test(const std::vector<Spike> &input_spike, const Tensor<Time> &input_time, std::vector<Spike> &output_spike)
+{
+	size_t depth = _model.depth();
+
+	if (!_weights.ready())
+	{
+		Tensor<float> rows = filter_rows(_model._w);
+		_weights.quantize(rows, _model._th, rows.shape().product() / depth, depth);
+		_report.reset();
+	}
+
+	bool calibration = _report.sample_number() < _model._quantization_calibration;
+	if (calibration)
+	{
+		// The float inference only serves as a reference: it must not count the sample
+		uint32_t sample_count = _model._sample_count;
+		uint32_t spike_count = _model._spike_count;
+		_reference.clear();
+		_model._impl.test(input_spike, input_time, _reference);
+		_model._sample_count = sample_count;
+		_model._spike_count = spike_count;
+	}
+
+	_model._sample_count++;
+
+	size_t size = _model.width() * _model.height() * _model.conv_depth() * depth;
+	if (_weights.narrow())
+	{
+		_a16.resize(size);
+		_test(input_spike, output_spike, _a16);
+	}
+	else
+	{
+		_a32.resize(size);
+		_test(input_spike, output_spike, _a32);
+	}
+
+	if (calibration)
+	{
+		_report.add(_reference, output_spike);
+		if (_report.sample_number() == _model._quantization_calibration)
+			std::cout << "Quantization calibration of " << _model.name() << ": " << _report.to_string() << std::endl;
+	}
+
+	draw_progress(_model._sample_count, _model._sample_number);
+
+	if (_model._sample_count == _model._sample_number)
+	{
+		std::cout << "\r[Spike count: " + std::to_string(_model._spike_count) + "] \n";
+		std::filesystem::create_directories(_model._file_path + "/SpikeNumber/" + _model._exp_name + "/");
+		LogSpikeNumber(_model._file_path + "/SpikeNumber/" + _model._exp_name + "/" + _model._exp_name, _model._spike_count);
+		_model._sample_count = 0;
+		_model._spike_count = 0;
+	}
+}
+
+template <typename Potential>
+void _priv::Convolution3DQuantizedImpl::_test(const std::vector<Spike> &input_spike, std::vector<Spike> &output_spike, std::vector<Potential> &a)
+{
+	size_t depth = _model.depth();
+	size_t height = _model.height();
+	size_t conv_depth = _model.conv_depth();
+	const Potential *th = _weights.thresholds<Potential>();
+
+	std::fill(std::begin(a), std::end(a), 0);
+
+	uint64_t integrations = 0;
+	std::vector<std::tuple<uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t>> output_spikes;
+
+	for (const Spike &spike : input_spike)
+	{
+		output_spikes.clear();
+		_model.forward(spike.x, spike.y, spike.k, output_spikes);
+
+		for (const auto &entry : output_spikes)
+		{
+			uint16_t x = std::get<0>(entry);
+			uint16_t y = std::get<1>(entry);
+			uint16_t k = std::get<2>(entry);
+			uint16_t w_x = std::get<3>(entry);
+			uint16_t w_y = std::get<4>(entry);
+			uint16_t w_k = std::get<5>(entry);
+
+			// With the inhibition, the neurons that fired sit at the floor of the potentials and can't reach their threshold again
+			Potential *potential = a.data() + ((x * height + y) * conv_depth + k) * depth;
+			const uint8_t *weights = _weights.row(((w_x * _model._filter_height + w_y) * _model._input_depth + spike.z) * _model._filter_conv_depth + w_k);
+			integrations += depth;
+			if (!tool::QuantizedWeights::integrate(potential, weights, th, depth))
+				continue;
+
+			for (size_t z = 0; z < depth; z++)
+			{
+				if (potential[z] >= th[z])
+				{
+					output_spike.emplace_back(spike.time, x, y, z, k);
+					_model._spike_count++;
+					if (_model._inhibition)
+						potential[z] = tool::QuantizedWeights::Floor<Potential>();
+				}
+			}
+		}
+	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+}
+
+_priv::Convolution3DBinaryImpl::Convolution3DBinaryImpl(Convolution3D &model) : _model(model), _weights(), _counters()
+{
+}
+
+void _priv::Convolution3DBinaryImpl::resize()
+{
+	invalidate();
+}
+
+void _priv::Convolution3DBinaryImpl::invalidate()
+{
+	_weights.invalidate();
+}
+
+void _priv::Convolution3DBinaryImpl::test(const std::vector<Spike> &input_spike, const Tensor<Time> &, std::vector<Spike> &output_spike)
+{
+	size_t depth = _model.depth();
+	size_t height = _model.height();
+	size_t conv_depth = _model.conv_depth();
+	size_t filter_conv_depth = _model._filter_conv_depth;
+
+	if (!_weights.ready())
+	{
+		Tensor<float> rows = filter_rows(_model._w);
+		_weights.binarize(rows, _model._th, rows.shape().product() / depth, depth, _model._binary_cut);
+		std::cout << "Binarization of " << _model.name() << ": " << _weights.to_string() << std::endl;
+	}
+
+	_model._sample_count++;
+	_weights.reset(_counters, _model.width() * height * conv_depth);
+
+	uint64_t integrations = 0;
+	std::vector<std::tuple<uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t>> output_spikes;
+
+	for (const Spike &spike : input_spike)
+	{
+		output_spikes.clear();
+		_model.forward(spike.x, spike.y, spike.k, output_spikes);
+
+		for (const auto &entry : output_spikes)
+		{
+			uint16_t x = std::get<0>(entry);
+			uint16_t y = std::get<1>(entry);
+			uint16_t k = std::get<2>(entry);
+			uint16_t w_x = std::get<3>(entry);
+			uint16_t w_y = std::get<4>(entry);
+			uint16_t w_k = std::get<5>(entry);
+
+			size_t synapse = ((w_x * _model._filter_height + w_y) * _model._input_depth + spike.z) * filter_conv_depth + w_k;
+			uint64_t *counters = _counters.data() + ((x * height + y) * conv_depth + k) * _weights.counter_size();
+			_model._spike_count += _weights.integrate(counters, synapse, _model._inhibition, [&](size_t z)
+													  { output_spike.emplace_back(spike.time, x, y, z, k); });
+			integrations += depth;
+		}
+	}
+
+	tool::Counters::add(_model.index(), tool::Counters::SynapticIntegrations, integrations);
+
+	draw_progress(_model._sample_count, _model._sample_number);
+
+	if (_model._sample_count == _model._sample_number)
+	{
+		std::cout << "\r[Spike count: " + std::to_string(_model._spike_count) + "] \n";
+		std::filesystem::create_directories(_model._file_path + "/SpikeNumber/" + _model._exp_name + "/");
+		LogSpikeNumber(_model._file_path + "/SpikeNumber/" + _model._exp_name + "/" + _model._exp_name, _model._spike_count);
+		_model._sample_count = 0;
+		_model._spike_count = 0;
+	}
+}
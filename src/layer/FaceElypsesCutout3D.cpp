@@ -17,11 +17,12 @@ static RegisterClassParameter<FaceElypsesCutout3D, LayerFactory> _register("Face
  * @param stdp learning rule - spike time dependant plasticity
  */
 FaceElypsesCutout3D::FaceElypsesCutout3D() : Layer4D(_register),
-								 _inhibition(true), _model_path(""), _draw(false), _epoch_number(0), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0),
+								 _epoch_number(0), _saved_weights(0), _snapshot_interval(0), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0), _draw(false), _save_weights(false), _inhibition(true), _model_path(""),
 								 _w(), _th(), _stdp(nullptr), _input_depth(0), _input_conv_depth(0), _impl(*this)
 {
 	add_parameter("draw", _draw);
 	add_parameter("save_weights", _save_weights);
+	add_parameter("snapshot_interval", _snapshot_interval, static_cast<uint32_t>(0));
 	add_parameter("save_random_start", _save_random_start);
 	add_parameter("log_spiking_neuron", _log_spiking_neuron);
 	add_parameter("inhibition", _inhibition);
@@ -38,12 +39,13 @@ FaceElypsesCutout3D::FaceElypsesCutout3D() : Layer4D(_register),
 FaceElypsesCutout3D::FaceElypsesCutout3D(size_t filter_number, size_t filter_width, size_t filter_height, size_t filter_depth, std::string model_path,
 							 size_t stride_x, size_t stride_y, size_t stride_k, size_t padding_x, size_t padding_y, size_t padding_k)
 	: Layer4D(_register, filter_number, filter_width, filter_height, filter_depth, stride_x, stride_y, stride_k, padding_x, padding_y, padding_k),
-	  _inhibition(true), _model_path(model_path), _draw(false), _save_weights(false), _save_random_start(false), _log_spiking_neuron(false), _annealing(1.0),
-	  _min_th(0), _t_obj(0), _lr_th(0), _sample_number(0), _sample_count(0), _spike_count(0), _drawn_weights(0), _saved_weights(0), _logged_spiking_neuron(0), _saved_random_start(0),
+	  _sample_number(0), _spike_count(0), _sample_count(0), _drawn_weights(0), _saved_weights(0), _snapshot_interval(0), _saved_random_start(0),
+	  _logged_spiking_neuron(0), _annealing(1.0), _min_th(0), _t_obj(0), _lr_th(0), _draw(false), _log_spiking_neuron(false), _save_weights(false), _save_random_start(false), _inhibition(true), _model_path(model_path),
 	  _w(), _th(), _stdp(nullptr), _input_depth(0), _impl(*this)
 {
 	add_parameter("draw", _draw);
 	add_parameter("save_weights", _save_weights);
+	add_parameter("snapshot_interval", _snapshot_interval, static_cast<uint32_t>(0));
 	add_parameter("save_random_start", _save_random_start);
 	add_parameter("log_spiking_neuron", _log_spiking_neuron);
 	add_parameter("inhibition", _inhibition);
@@ -225,19 +227,7 @@ void FaceElypsesCutout3D::process_train_sample(const std::string &label, Tensor<
 
 		// even if _filter_conv_depth == 1, we are still taking random patches with a temporal depth.
 		Tensor<Time> input_time(Shape({_filter_width, _filter_height, _input_depth, _filter_conv_depth}));
-		for (size_t cx = 0; cx < _filter_height; cx++)
-		{
-			for (size_t cy = 0; cy < _filter_width; cy++)
-			{
-				for (size_t cz = 0; cz < _input_depth; cz++)
-				{
-					for (size_t ck = 0; ck < _filter_conv_depth; ck++)
-					{
-						input_time.at(cx, cy, cz, ck) = sample.at(cx + x, cy + y, cz, ck + k);
-					}
-				}
-			}
-		}
+		input_time.view().assign(sample.view().narrow(0, x, _filter_width).narrow(1, y, _filter_height).narrow(3, k, _filter_conv_depth));
 
 		SpikeConverter::to_spike(input_time, input_spike);
 		train(label, input_spike, input_time, output_spike);
@@ -706,12 +696,10 @@ void _priv::FaceElypsesCutout3DImpl::train(const std::vector<Spike> &input_spike
 	_label.erase(0, _exp_name.length() + delimiter.length());
 	std::string _layerIndex = _label.substr(0, _label.find(delimiter));
 	_label.erase(0, _layerIndex.length() + delimiter.length());
-	if (_model._draw || _model._log_spiking_neuron || _model._save_weights || _model._save_random_start)
-		std::filesystem::create_directories(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/");
 
 	if (_model._current_epoch_number == 0 && _model._save_random_start && _model._saved_random_start == 0)
 	{
-		SaveWeights(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name + "_random_start.json", _label, _model._w);
+		_model._weight_logger.log_weights(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name + "_random_start", _label, _model._w);
 		_model._saved_random_start = 1;
 	}
 
@@ -754,6 +742,7 @@ void _priv::FaceElypsesCutout3DImpl::train(const std::vector<Spike> &input_spike
 				/// @brief for visualization.
 				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._draw && _model._drawn_weights == 0)
 				{
+					std::filesystem::create_directories(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/");
 					Tensor<float>::draw_weight_tensor(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name + "_N:" + std::to_string(z), w);
 					_model._drawn_weights = 1;
 				}
@@ -765,13 +754,12 @@ void _priv::FaceElypsesCutout3DImpl::train(const std::vector<Spike> &input_spike
 						std::filesystem::create_directories(_model._file_path + "/UpdatedFilter/" + _model._exp_name + "/");
 						_model._logged_spiking_neuron = 1;
 					}
-					LogUpdatedFilter(_model._file_path + "/UpdatedFilter/" + _model._exp_name + "/" + _model._exp_name + "_" + _layerIndex, z);
+					_model._weight_logger.log_event(_model._file_path + "/UpdatedFilter/" + _model._exp_name + "/" + _model._exp_name + "_" + _layerIndex, _label, z);
 				}
 
-				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._save_weights && _model._saved_weights == 0)
+				if (_model._current_epoch_number == _model._epoch_number - 1 && _model._save_weights && tool::WeightLogger::is_snapshot(_model._saved_weights++, _model._snapshot_interval))
 				{
-					SaveWeights(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name + ".json", _label, w);
-					_model._saved_weights = 1;
+					_model._weight_logger.log_weights(_model._file_path + "/Weights/" + _exp_name + "/" + _layerIndex + "/" + _exp_name, _label, w);
 				}
 
 				if (_model._inhibition)
@@ -38,7 +38,7 @@ void Pooling::process_train_sample(const std::string& label, Tensor<float>& samp
 	SpikeConverter::to_spike(sample, input_spike);
 	std::vector<Spike> output_spike;
 	test(label, input_spike, sample, output_spike);
-	sample = Tensor<float>(shape());
+	sample.resize(shape());
 	SpikeConverter::from_spike(output_spike, sample);
 }
 
@@ -52,7 +52,7 @@ void Pooling::process_test_sample(const std::string& label, Tensor<float>& sampl
 	SpikeConverter::to_spike(sample, input_spike);
 	std::vector<Spike> output_spike;
 	test(label, input_spike, sample, output_spike);
-	sample = Tensor<float>(shape());
+	sample.resize(shape());
 	SpikeConverter::from_spike(output_spike, sample);
 }
 
@@ -149,7 +149,7 @@ void Pooling3D::process_train_sample(const std::string &label, Tensor<float> &sa
 	SpikeConverter::to_spike(sample, input_spike);
 	std::vector<Spike> output_spike;
 	train(label, input_spike, sample, output_spike);
-	sample = Tensor<float>(shape());
+	sample.resize(shape());
 	SpikeConverter::from_spike(output_spike, sample);
 }
 
@@ -167,7 +167,7 @@ void Pooling3D::process_test_sample(const std::string &label, Tensor<float> &sam
 	SpikeConverter::to_spike(sample, input_spike);
 	std::vector<Spike> output_spike;
 	test(label, input_spike, sample, output_spike);
-	sample = Tensor<float>(shape());
+	sample.resize(shape());
 	SpikeConverter::from_spike(output_spike, sample);
 }
 
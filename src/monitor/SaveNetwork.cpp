@@ -16,5 +16,5 @@ void SaveNetwork::on_sample(const AbstractExperiment&, size_t, size_t) {
 }
 
 void SaveNetwork::on_epoch(const AbstractExperiment& experiment, size_t layer_index, size_t epoch_count) {
-	experiment.save(experiment.name()+"-layer-"+std::to_string(layer_index)+"-epoch-"+std::to_string(epoch_count));
+	experiment.save_async(experiment.name()+"-layer-"+std::to_string(layer_index)+"-epoch-"+std::to_string(epoch_count));
 }
@@ -80,5 +80,5 @@ void Acceleration::_process(const std::string &label, Tensor<InputType> &in) con
 	if (_draw == 1)
 		Tensor<float>::draw_colored_tensor(_file_path + "/Input_frames/" + _expName + "/ACC/ACC_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
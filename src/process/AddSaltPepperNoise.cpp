@@ -76,5 +76,5 @@ void AddSaltPepperNoise::_process(const std::string &label, Tensor<InputType> &i
 	if (_draw == 1)
 		Tensor<float>::draw_tensor(_file_path + "/Input_frames/" + _expName + "/S&PNoise/S&PNoise_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
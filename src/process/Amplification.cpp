@@ -64,5 +64,5 @@ void Amplification::_process(const std::string &label, Tensor<InputType> &in) co
 	if (_draw == 1)
 		Tensor<float>::draw_tensor(_file_path + "/Input_frames/" + _expName + "/Amp/Amp_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
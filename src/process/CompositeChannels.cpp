@@ -203,5 +203,5 @@ void CompositeChannels::_process(const std::string &label, Tensor<InputType> &in
 	if (_draw == 1)
 		Tensor<float>::draw_colored_tensor(_file_path + "/Input_frames/" + _expName + "/CC/CC_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
@@ -204,5 +204,5 @@ void CompositeChannels2::_process(const std::string &label, Tensor<InputType> &i
 	if (_draw == 1)
 		Tensor<float>::draw_colored_tensor(_file_path + "/Input_frames/" + _expName + "/CC2/CC2_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
@@ -103,5 +103,5 @@ void DXDY::_process(const std::string &label, Tensor<InputType> &in) const
 	if (_draw == 1)
 		Tensor<float>::draw_scaled_colored_tensor(_file_path + "/Input_frames/" + _expName + "/DXDY/DXDY_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -152,6 +152,6 @@ void EarlyFusion::_process(const std::string &label, Tensor<InputType> &in) cons
 		if (_draw == 1)
 			Tensor<float>::draw_nonscaled_tensor(_file_path + "/Input_frames/" + _expName + "/EF/EF_" + label + "_", out);
 
-		in = out;
+		in = std::move(out);
 	}
 }
\ No newline at end of file
@@ -86,5 +86,5 @@ void EdgeGrid::_process(Tensor<InputType> &in) const
 		//flowSum = std::max(std::abs(flow_parts[0]), std::abs(flow_parts[1]));
 	}
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -38,5 +38,5 @@ void Flatten::_process(const std::string &label, Tensor<InputType> &in) const
 	for (size_t _j = 0; _j < _product; _j++)
 		out.at<float>(_j) = in.at_index(_j);
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
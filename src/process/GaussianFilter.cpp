@@ -121,6 +121,6 @@ void GaussianFilter::_process(const std::string &label, Tensor<InputType> &in) c
 
 		if (_draw == 1)
 			Tensor<float>::draw_nonscaled_tensor(_file_path + "/Input_frames/" + _expName + "/GF/GF_" + label + "_", out);
-		in = out;
+		in = std::move(out);
 	}
 }
\ No newline at end of file
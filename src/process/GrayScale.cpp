@@ -41,5 +41,5 @@ void GrayScale::_process(Tensor<float>& in) const {
 		}
 	}
 
-	in = out;
+	in = std::move(out);
 }
@@ -126,5 +126,5 @@ void ImageGrid::_process(const std::string &label, Tensor<InputType> &in) const
 
 	totalframe = cv::Mat::zeros(_height * VERTICAL_FRAMES, _width * HORIZONTAL_FRAMES, CV_32FC1);
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
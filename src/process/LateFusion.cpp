@@ -70,12 +70,7 @@ void LateFusion::_process(const std::string &label, Tensor<InputType> &in) const
 			std::vector<cv::Mat> _frames;
 			// Take a single filter input
 			Tensor<InputType> in_prime(Shape({_height, _width, 1, _conv_depth}));
-			for (int i = 0; i < _height; i++)
-				for (int j = 0; j < _width; j++)
-					for (int z = 0; z < _conv_depth; z++)
-					{
-						in_prime.at<float>(i, j, 0, z) = in.at<float>(i, j, k, z);
-					}
+			in_prime.view().slice(2, 0).assign(in.view().slice(2, k));
 			// This function returns the sequence of frames as Mats.
 			Tensor<float>::tensor_to_matrices(_frames, in_prime);
 
@@ -96,15 +91,11 @@ void LateFusion::_process(const std::string &label, Tensor<InputType> &in) const
 			if (_draw == 1 && k == 0)
 				Tensor<float>::draw_tensor(_file_path + "/Input_frames/" + _expName + "/LF/LF " + label + ".png", out_prime);
 
-			for (int i = 0; i < _height; i++)
-				for (int j = 0; j < _width; j++)
-				{
-					out.at<float>(i, j, k, 0) = out_prime.at<float>(i, j, 0, 0);
-				}
+			out.view().narrow(0, 0, _height).narrow(1, 0, _width).slice(3, 0).slice(2, k).assign(out_prime.view().narrow(0, 0, _height).narrow(1, 0, _width).slice(3, 0).slice(2, 0));
 
 			totalframe = cv::Mat::zeros(_height * _fused_frames_number, _width, CV_32F);
 		}
-		in = out;
+		in = std::move(out);
 	}
 	else
 	{
@@ -118,12 +109,7 @@ void LateFusion::_process(const std::string &label, Tensor<InputType> &in) const
 			std::vector<cv::Mat> _frames;
 			// Take a single filter input
 			Tensor<InputType> in_prime(Shape({_height, _width, 1, _conv_depth}));
-			for (int i = 0; i < _height; i++)
-				for (int j = 0; j < _width; j++)
-					for (int z = 0; z < _conv_depth; z++)
-					{
-						in_prime.at<float>(i, j, 0, z) = in.at<float>(i, j, k, z);
-					}
+			in_prime.view().slice(2, 0).assign(in.view().slice(2, k));
 			// This function returns the sequence of frames as Mats.
 			Tensor<float>::tensor_to_matrices(_frames, in_prime);
 
@@ -144,14 +130,10 @@ void LateFusion::_process(const std::string &label, Tensor<InputType> &in) const
 			if (_draw == 1 && k == 0)
 				Tensor<float>::draw_tensor(_file_path + "/Input_frames/" + _expName + "/LF/LF " + label + ".png", out_prime);
 
-			for (int i = 0; i < _height; i++)
-				for (int j = 0; j < _width; j++)
-				{
-					out.at<float>(i, j, k, 0) = out_prime.at<float>(i, j, 0, 0);
-				}
+			out.view().narrow(0, 0, _height).narrow(1, 0, _width).slice(3, 0).slice(2, k).assign(out_prime.view().narrow(0, 0, _height).narrow(1, 0, _width).slice(3, 0).slice(2, 0));
 
 			totalframe = cv::Mat::zeros(_height, _width * _fused_frames_number, CV_32F);
 		}
-		in = out;
+		in = std::move(out);
 	}
 }
\ No newline at end of file
@@ -201,5 +201,5 @@ void MotionGrid::_process(const std::string &label, Tensor<InputType> &in) const
 			break;
 		}
 	}
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -205,7 +205,7 @@ void MotionGridV1::_process(const std::string &label, Tensor<InputType> &in) con
 
 	totalframe = cv::Mat::zeros(_height * VERTICAL_FRAMES, _width * HORIZONTAL_FRAMES, CV_32FC1);
 
-	in = out;
+	in = std::move(out);
 }
 
 // void MotionGridV1::_process(const std::string &label, Tensor<InputType> &in) const
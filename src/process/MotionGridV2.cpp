@@ -304,7 +304,7 @@ void MotionGridV2::_process(const std::string &label, Tensor<InputType> &in) con
 			break;
 		}
 	}
-	in = out;
+	in = std::move(out);
 }
 
 
@@ -169,5 +169,5 @@ void MotionGridV3::_process(const std::string &label, Tensor<InputType> &in) con
 			break;
 		}
 	}
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
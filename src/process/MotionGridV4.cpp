@@ -189,5 +189,5 @@ void MotionGridV4::_process(const std::string &label, Tensor<InputType> &in) con
 			break;
 		}
 	}
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -146,9 +146,9 @@ void DefaultOnOffFilter::_process(const std::string &label, Tensor<InputType> &i
 				}
 		}
 
-		in = out;
 		if (_draw == 1)
 			Tensor<float>::draw_scaled_tensor(_file_path + "/Input_frames/" + _expName + "/OOF/OOF_" + label + "_", out, 20);
+		in = std::move(out);
 	}
 	else // 3D Input
 	{
@@ -174,10 +174,10 @@ void DefaultOnOffFilter::_process(const std::string &label, Tensor<InputType> &i
 						out.at(x, y, z * 2, k) = std::max<float>(_cutoff, v) == _cutoff ? 0 : std::max<float>(0, v);
 						out.at(x, y, z * 2 + 1, k) = std::max<float>(_cutoff, -v) == _cutoff ? 0 : std::max<float>(0, -v);
 					}
-		in = out;
 		if (_draw == 1)
 			Tensor<float>::draw_scaled_tensor(_file_path + "/Input_frames/" + _expName + "/OOF/OOF_" + label + "_", out, 20);
 			//Tensor<float>::draw_nonscaled_tensor(_file_path + "/Input_frames/" + _expName + "/OOF/OOF_" + label + "_", out);
+		in = std::move(out);
 	}
 
 		//	Tensor<float>::display_range_tensor(in);
@@ -323,7 +323,7 @@ void CustomRGBOnOffFilter::_process(Tensor<InputType> &in) const
 				out.at(x, y, 5, k) = std::max<float>(0, -v);
 			}
 		}
-	in = out;
+	in = std::move(out);
 }
 
 //
@@ -419,5 +419,5 @@ void BiologicalOnOffFilter::_process(Tensor<InputType>& in) const {
 		}
 	}
 
-	in = out;
+	in = std::move(out);
 }
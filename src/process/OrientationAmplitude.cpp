@@ -105,5 +105,5 @@ void OrientationAmplitude::_process(const std::string &label, Tensor<InputType>
 	if (_draw == 1)
 		Tensor<float>::draw_colored_tensor(_file_path + "/Input_frames/" + _expName + "/OA/OA_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -2,6 +2,59 @@
 
 using namespace process;
 
+/**
+ * @brief Non-overlapping sum pooling of a 3D or 4D tensor into out, whose shape gives the output size.
+ * The input is streamed once in memory order and each non-zero value is scattered into its output cell, which skips the
+ * zeros of the sparse feature maps. The values of a cell are accumulated in the same order as a window by window sum.
+ */
+void process::_priv::PoolingHelper::sum_pool(const Tensor<float> &in, Tensor<float> &out, size_t filter_width, size_t filter_height, size_t filter_conv_depth)
+{
+	size_t in_height = in.shape().dim(1);
+	size_t depth = in.shape().dim(2);
+	size_t in_conv_depth = in.shape().number() > 3 ? in.shape().dim(3) : 1;
+
+	size_t output_width = out.shape().dim(0);
+	size_t output_height = out.shape().dim(1);
+	size_t output_conv_depth = out.shape().number() > 3 ? out.shape().dim(3) : 1;
+
+	out.fill(0);
+
+	const float *in_data = in.begin();
+	float *out_data = out.begin();
+
+	for (size_t x = 0; x < output_width * filter_width; x++)
+		for (size_t y = 0; y < output_height * filter_height; y++)
+		{
+			const float *src = in_data + (x * in_height + y) * depth * in_conv_depth;
+			float *dst = out_data + ((x / filter_width) * output_height + y / filter_height) * depth * output_conv_depth;
+
+			for (size_t z = 0; z < depth; z++)
+				for (size_t k = 0; k < output_conv_depth; k++)
+				{
+					const float *window = src + z * in_conv_depth + k * filter_conv_depth;
+					float &v = dst[z * output_conv_depth + k];
+					for (size_t fk = 0; fk < filter_conv_depth; fk++)
+					{
+						if (window[fk] != 0)
+							v += window[fk];
+					}
+				}
+		}
+}
+
+/**
+ * @brief Sum pooling of sample in place, through a per-worker buffer. The buffer is swapped with the sample once pooled:
+ * the sample owns the output and the buffer keeps the larger storage of the input, which resize reuses for the next sample.
+ */
+void process::_priv::PoolingHelper::sum_pool(Tensor<float> &sample, const Shape &output_shape, size_t filter_width, size_t filter_height, size_t filter_conv_depth)
+{
+	thread_local Tensor<float> buffer;
+
+	buffer.resize(output_shape);
+	sum_pool(sample, buffer, filter_width, filter_height, filter_conv_depth);
+	std::swap(sample, buffer);
+}
+
 static RegisterClassParameter<SpatioTemporalSumPooling, ProcessFactory> _register("SpatioTemporalSumPooling");
 
 SpatioTemporalSumPooling::SpatioTemporalSumPooling() : UniquePassProcess(_register),
@@ -65,29 +118,7 @@ void SpatioTemporalSumPooling::_process(Tensor<float> &in) const
 	size_t filter_height = _height / output_height;
 	size_t filter_conv_depth = _input_conv_depth / output_conv_depth;
 
-	// Tensor<float> out(Shape({output_width, output_height, _depth, output_conv_depth}));
-	Tensor<float> out = Tensor<float>(Shape({output_width, output_height, _depth, output_conv_depth}));
-
-	for (size_t x = 0; x < output_width; x++)
-		for (size_t y = 0; y < output_height; y++)
-			for (size_t z = 0; z < _depth; z++)
-				for (size_t k = 0; k < output_conv_depth; k++)
-				{
-					float v = 0;
-
-					for (size_t fx = 0; fx < filter_width; fx++)
-						for (size_t fy = 0; fy < filter_height; fy++)
-							for (size_t fk = 0; fk < filter_conv_depth; fk++)
-							{
-								if (in.shape().number() > 3)
-									v += in.at(x * filter_width + fx, y * filter_height + fy, z, k * filter_conv_depth + fk);
-								else
-									v += in.at(x * filter_width + fx, y * filter_height + fy, z);
-							}
-
-					out.at(x, y, z, k) = v;
-				}
-	in = out;
+	_priv::PoolingHelper::sum_pool(in, Shape({output_width, output_height, _depth, output_conv_depth}), filter_width, filter_height, filter_conv_depth);
 }
 
 static RegisterClassParameter<SumPooling, ProcessFactory> _registerSum("SumPooling");
@@ -135,31 +166,7 @@ void SumPooling::_process(Tensor<float> &in) const
 	size_t filter_width = _width / output_width;
 	size_t filter_height = _height / output_height;
 
-	Tensor<float> out(Shape({output_width, output_height, _depth, _conv_depth}));
-
-	for (size_t x = 0; x < output_width; x++)
-	{
-		for (size_t y = 0; y < output_height; y++)
-		{
-			for (size_t z = 0; z < _depth; z++)
-				for (size_t k = 0; k < _conv_depth; k++)
-				{
-					float v = 0;
-
-					for (size_t fx = 0; fx < filter_width; fx++)
-					{
-						for (size_t fy = 0; fy < filter_height; fy++)
-						{
-							v += in.shape().number() > 3 ? in.at(x * filter_width + fx, y * filter_height + fy, z, k) : in.at(x * filter_width + fx, y * filter_height + fy, z);
-						}
-					}
-
-					out.at(x, y, z, k) = v;
-				}
-		}
-	}
-
-	in = out;
+	_priv::PoolingHelper::sum_pool(in, Shape({output_width, output_height, _depth, _conv_depth}), filter_width, filter_height, 1);
 }
 
 
@@ -207,21 +214,7 @@ void TemporalPooling::_process(Tensor<float> &in) const
 
 	size_t filter_conv_depth = _input_conv_depth / output_conv_depth;
 
-	Tensor<float> out(Shape({_width, _height, _depth, output_conv_depth}));
-
-	for (size_t x = 0; x < _width; x++)
-		for (size_t y = 0; y < _height; y++)
-			for (size_t z = 0; z < _depth; z++)
-				for (size_t k = 0; k < output_conv_depth; k++)
-				{
-					float v = 0;
-					for (size_t fk = 0; fk < filter_conv_depth; fk++)
-					{
-						v += in.at(x, y, z, k * filter_conv_depth + fk);
-					}
-					out.at(x, y, z, k) = v;
-				}
-	in = out;
+	_priv::PoolingHelper::sum_pool(in, Shape({_width, _height, _depth, output_conv_depth}), 1, 1, filter_conv_depth);
 }
 
 
@@ -282,7 +275,7 @@ void MeanPooling::_process(Tensor<float>& in) const {
 		}
 	}
 
-	in = out;
+	in = std::move(out);
 }
 
 static RegisterClassParameter<MaxPooling, ProcessFactory> _registerMax("MaxPooling");
@@ -356,5 +349,5 @@ void MaxPooling::_process(Tensor<float> &in) const
 
 					out.at(x, y, z, k) = v;
 				}
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -149,5 +149,5 @@ void ReichardtDetector::_process(const std::string &label, Tensor<InputType> &in
 		Tensor<float>::draw_tensor(_file_path + "/Input_frames/" + _expName + "/RD/RD_d2_" + label + "_", _out_frames[3]);
 	}
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -72,5 +72,5 @@ void ResidualConnection::_process(Tensor<float> &in, Tensor<float> &original_sam
 				{
 					out.at(x, y, z, k) = std::max(in.at(x, y, z, k), original_sample.at(x, y, 0, k));
 				}
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
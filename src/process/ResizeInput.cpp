@@ -75,5 +75,5 @@ void ResizeInput::_process(const std::string &label, Tensor<InputType> &in) cons
 	if (_draw == 1)
 		Tensor<float>::draw_tensor(_file_path + "/Input_frames/" + _expName + "/RF/RF_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -104,5 +104,5 @@ void SimplePreprocessing::_process(const std::string &label, Tensor<InputType> &
 		else
 			Tensor<float>::draw_nonscaled_tensor(_file_path + "/Input_frames/" + _expName + "/SP/SP_" + label + "_", out);
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
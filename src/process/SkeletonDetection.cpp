@@ -152,5 +152,5 @@ void SkeletonDetection::_process(const std::string &label, Tensor<InputType> &in
 	Tensor<float>::matrices_to_tensor(_out_frames, out);
 	if (_draw == 1)
 		Tensor<float>::draw_tensor(_file_path + "/Input_frames/" + _expName + "/SD/draws/draws_" + label + "_", out);
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "process/SpikeEncoder.h"
+#include "process/OnOffFilter.h"
+#include "SpikeConverter.h"
+#include "Experiment.h"
+#include "dep/npy.hpp"
+
+using namespace process;
+
+//
+//	SpikeEncoder
+//
+
+static RegisterClassParameter<SpikeEncoder, ProcessFactory> _register_1("SpikeEncoder");
+
+SpikeEncoder::SpikeEncoder() : TwoPassProcess(_register_1),
+							   _filter_size(0), _center_dev(0), _surround_dev(0), _cutoff(0), _scaling(ScaleMax), _scalar(0), _max_timestamp(0),
+							   _height(0), _width(0), _depth(0), _conv_depth(0), _size(0), _kernel(), _buffer(), _min(), _max()
+{
+	add_parameter("filter_size", _filter_size);
+	add_parameter("center_dev", _center_dev);
+	add_parameter("surround_dev", _surround_dev);
+	add_parameter("cutoff", _cutoff);
+	add_parameter("scaling", _scaling);
+	add_parameter("scalar", _scalar);
+	add_parameter("max_timestamp", _max_timestamp);
+}
+
+SpikeEncoder::SpikeEncoder(size_t filter_size, float center_dev, float surround_dev, float cutoff, uint32_t scaling, float scalar, float max_timestamp) : SpikeEncoder()
+{
+	if (scaling > ScaleFeature)
+		throw std::runtime_error("Unknown scaling mode " + std::to_string(scaling));
+
+	parameter<size_t>("filter_size").set(filter_size);
+	parameter<float>("center_dev").set(center_dev);
+	parameter<float>("surround_dev").set(surround_dev);
+	parameter<float>("cutoff").set(cutoff);
+	parameter<uint32_t>("scaling").set(scaling);
+	parameter<float>("scalar").set(scalar);
+	parameter<float>("max_timestamp").set(max_timestamp);
+}
+
+Shape SpikeEncoder::compute_shape(const Shape &shape)
+{
+	parameter<size_t>("filter_size").ensure_initialized(experiment()->random_generator());
+	parameter<float>("center_dev").ensure_initialized(experiment()->random_generator());
+	parameter<float>("surround_dev").ensure_initialized(experiment()->random_generator());
+	parameter<float>("cutoff").ensure_initialized(experiment()->random_generator());
+	parameter<uint32_t>("scaling").ensure_initialized(experiment()->random_generator());
+	parameter<float>("scalar").ensure_initialized(experiment()->random_generator());
+	parameter<float>("max_timestamp").ensure_initialized(experiment()->random_generator());
+
+	_height = shape.dim(0);
+	_width = shape.dim(1);
+	_depth = shape.dim(2);
+	_conv_depth = shape.number() > 3 ? shape.dim(3) : 1;
+
+	size_t out_depth = _filter_size > 0 ? _depth * 2 : _depth; // the on and off cells are put in two separate channels
+	Shape out_shape = shape.number() > 3 ? Shape({_height, _width, out_depth, _conv_depth}) : Shape({_height, _width, out_depth});
+
+	_size = out_shape.product();
+	if (_filter_size > 0)
+		_kernel = _priv::OnOffFilterHelper::generate_filter(_filter_size, _center_dev, _surround_dev);
+	_buffer = Tensor<float>(out_shape);
+
+	if (_scaling == ScaleFeature)
+	{
+		_min = Tensor<float>(out_shape);
+		_min.fill(std::numeric_limits<float>::max());
+		_max = Tensor<float>(out_shape);
+		_max.fill(std::numeric_limits<float>::min());
+	}
+
+	return out_shape;
+}
+
+size_t SpikeEncoder::train_pass_number() const
+{
+	return _scaling == ScaleFeature ? 2 : 1;
+}
+
+void SpikeEncoder::process_train_sample(const std::string &label, Tensor<float> &sample, size_t current_pass, size_t, size_t)
+{
+	if (_scaling == ScaleFeature && current_pass == 0)
+		compute(label, sample);
+	else
+		process_train(label, sample);
+}
+
+/**
+ * @brief The first training pass is only needed by the feature scaling, it collects the minimum and maximum of each filter response.
+ */
+void SpikeEncoder::compute(const std::string &, const Tensor<float> &sample)
+{
+	_filter(sample);
+	for (size_t i = 0; i < _size; i++)
+	{
+		_min.at_index(i) = std::min(_min.at_index(i), _buffer.at_index(i));
+		_max.at_index(i) = std::max(_max.at_index(i), _buffer.at_index(i));
+	}
+}
+
+void SpikeEncoder::process_train(const std::string &, Tensor<float> &sample)
+{
+	_process(sample);
+}
+
+void SpikeEncoder::process_test(const std::string &, Tensor<float> &sample)
+{
+	_process(sample);
+}
+
+bool SpikeEncoder::save_params(const std::string &path)
+{
+	if (_scaling != ScaleFeature)
+		return false;
+
+	std::vector<float> mins(_min.begin(), _min.begin() + _size);
+	std::vector<float> maxs(_max.begin(), _max.begin() + _size);
+	const bool fortran_order{false};
+	const std::vector<long unsigned> shape{_size};
+	npy::SaveArrayAsNumpy(path + "/mins.npy", fortran_order, shape.size(), shape.data(), mins);
+	npy::SaveArrayAsNumpy(path + "/maxs.npy", fortran_order, shape.size(), shape.data(), maxs);
+	return true;
+}
+
+bool SpikeEncoder::load_params(const std::string &path)
+{
+	if (_scaling != ScaleFeature)
+		return false;
+
+	bool fortran_order = false;
+	std::vector<long unsigned> shape{_size};
+	std::vector<float> mins;
+	npy::LoadArrayFromNumpy(path + "/mins.npy", shape, fortran_order, mins);
+	std::vector<float> maxs;
+	npy::LoadArrayFromNumpy(path + "/maxs.npy", shape, fortran_order, maxs);
+	if (mins.size() != _size || maxs.size() != _size)
+		throw std::runtime_error("Incompatible feature scaling parameters in " + path);
+
+	std::copy(std::begin(mins), std::end(mins), _min.begin());
+	std::copy(std::begin(maxs), std::end(maxs), _max.begin());
+	return true;
+}
+
+/**
+ * @brief Encodes a sample directly into a time-ordered spike train, without materializing the intermediate tensors.
+ * The spikes are the ones SpikeConverter::to_spike would extract from the output of process_test().
+ */
+void SpikeEncoder::encode(const Tensor<float> &in, std::vector<Spike> &out)
+{
+	float divisor = _divisor(_filter(in));
+	size_t out_depth = _size / (_height * _width * _conv_depth);
+	bool is_3d = in.shape().number() > 3;
+
+	out.clear();
+	size_t i = 0;
+	for (size_t x = 0; x < _height; x++)
+		for (size_t y = 0; y < _width; y++)
+			for (size_t z = 0; z < out_depth; z++)
+				for (size_t k = 0; k < _conv_depth; k++, i++)
+				{
+					Time t = _code(i, divisor);
+					if (t != INFINITE_TIME)
+					{
+						if (is_3d)
+							out.emplace_back(t, x, y, z, k);
+						else
+							out.emplace_back(t, x, y, z);
+					}
+				}
+
+	SpikeConverter::sort(out);
+}
+
+/**
+ * @brief Computes the on/off filter response of the sample in the reusable buffer and returns its maximum.
+ * The accumulation order is the one of DefaultOnOffFilter, so that both produce the same values.
+ */
+float SpikeEncoder::_filter(const Tensor<float> &in)
+{
+	if (in.shape().product() != _height * _width * _depth * _conv_depth)
+		throw std::runtime_error("Unexpected shape " + in.shape().to_string());
+
+	float max = 0;
+
+	if (_filter_size == 0)
+	{
+		for (size_t i = 0; i < _size; i++)
+		{
+			_buffer.at_index(i) = in.at_index(i);
+			max = std::max(max, in.at_index(i));
+		}
+		return max;
+	}
+
+	const float *data = in.begin();
+	const float *kernel = _kernel.begin();
+	float *out = _buffer.begin();
+	size_t half = _filter_size / 2;
+	size_t row = _width * _depth * _conv_depth;
+	size_t column = _depth * _conv_depth;
+
+	for (size_t x = 0; x < _height; x++)
+		for (size_t y = 0; y < _width; y++)
+			for (size_t z = 0; z < _depth; z++)
+				for (size_t k = 0; k < _conv_depth; k++)
+				{
+					float v = 0;
+					for (size_t fx = 0; fx < _filter_size; fx++)
+					{
+						size_t x_in = x + fx > half ? std::min(x + fx - half, _height - 1) : 0;
+						for (size_t fy = 0; fy < _filter_size; fy++)
+						{
+							size_t y_in = y + fy > half ? std::min(y + fy - half, _width - 1) : 0;
+							v += data[x_in * row + y_in * column + z * _conv_depth + k] * kernel[fx * _filter_size + fy];
+						}
+					}
+
+					float on = v > _cutoff ? std::max<float>(0, v) : 0;
+					float off = -v > _cutoff ? std::max<float>(0, -v) : 0;
+					size_t o = ((x * _width + y) * _depth * 2 + z * 2) * _conv_depth + k;
+					out[o] = on;
+					out[o + _conv_depth] = off;
+					max = std::max(max, std::max(on, off));
+				}
+
+	return max;
+}
+
+/**
+ * @brief Divisor applied to the filter response by the max scaling.
+ */
+float SpikeEncoder::_divisor(float max) const
+{
+	if (_scaling != ScaleMax)
+		return 1;
+	return _scalar > 0 ? _scalar : max;
+}
+
+/**
+ * @brief Scales the filter response at index i and codes it like LatencyCoding: the higher the value, the earlier the spike.
+ * An empty response (null divisor) stays silent instead of producing NaN.
+ */
+Time SpikeEncoder::_code(size_t i, float divisor) const
+{
+	float v = _buffer.at_index(i);
+	if (_scaling == ScaleFeature)
+		v = _min.at_index(i) == _max.at_index(i) ? 0 : (v - _min.at_index(i)) / (_max.at_index(i) - _min.at_index(i));
+	else
+		v = divisor == 0 ? 0 : v / divisor;
+
+	Time ts = std::max<Time>(0.0f, 1.0f - v);
+	return ts == 1.0f || (ts > _max_timestamp && _max_timestamp > 0) ? INFINITE_TIME : ts;
+}
+
+void SpikeEncoder::_process(Tensor<float> &sample)
+{
+	float divisor = _divisor(_filter(sample));
+
+	for (size_t i = 0; i < _size; i++)
+	{
+		_buffer.at_index(i) = _code(i, divisor);
+	}
+
+	// The coded buffer becomes the sample, the previous sample storage is recycled as the next buffer when it has the right size
+	std::swap(sample, _buffer);
+	if (_buffer.shape() != shape())
+		_buffer.resize(shape());
+}
@@ -58,5 +58,5 @@ void SpikeMotionGrid::_process(const std::string &label, Tensor<Time> &in) const
 		out.at_index(i) = t;
 	}
 
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
@@ -106,7 +106,7 @@ void SpikingBackgroundSubtraction::_process(const std::string &label, Tensor<Tim
 		}
 	}
 	Tensor<Time>::time_tensors_to_tensor(time_tensors_out, out);
-	in = out;
+	in = std::move(out);
 }
 
 // void SpikingBackgroundSubtraction::_process(const std::string &label, Tensor<Time> &in) const
@@ -129,5 +129,5 @@ void SpikingMotionGrid::_process(const std::string &label, Tensor<Time> &in) con
 			break;
 		}
 	}
-	in = out;
+	in = std::move(out);
 }
\ No newline at end of file
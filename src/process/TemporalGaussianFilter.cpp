@@ -4,6 +4,43 @@ using namespace process;
 
 #include "Experiment.h"
 #include "Math.h"
+#include <execution>
+#include <numeric>
+
+#ifdef SMID_AVX256
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Normalized 1D Gaussian kernel applied along the temporal depth.
+ *
+ * @param filter_size The size of the gaussian filter
+ * @param center_dev The varience of the gaussian equation.
+ * @return Tensor<float>
+ */
+Tensor<float> process::_priv::TemporalGaussianFilterHelper::generate_filter(size_t filter_size, float center_dev)
+{
+	Tensor<float> t2(Shape({filter_size}));
+	/**
+	 * @brief t2 is the value of (k^2) in the case of 1D temporal filtering.
+	 */
+	for (size_t k = 0; k < filter_size; k++)
+		t2.at(k) = std::pow((k + 1) - static_cast<float>(filter_size) / 2.0f - 0.5f, 2.0f);
+
+	Tensor<float> filter(Shape({filter_size}));
+	float filter_sum = 0;
+
+	for (size_t k = 0; k < filter_size; k++)
+	{
+		filter.at(k) = 1.0f / std::sqrt(2.0f * static_cast<float>(M_PI)) * (1.0f / center_dev * std::exp(-t2.at(k) / 2.0f / (center_dev * center_dev)));
+		filter_sum += filter.at(k);
+	}
+
+	for (size_t k = 0; k < filter_size; k++)
+		filter.at(k) /= filter_sum;
+
+	return filter;
+}
 
 //
 //	TemporalGaussianFilter
@@ -12,7 +49,7 @@ using namespace process;
 static RegisterClassParameter<TemporalGaussianFilter, ProcessFactory> _register_1("TemporalGaussianFilter");
 
 TemporalGaussianFilter::TemporalGaussianFilter() : UniquePassProcess(_register_1),
-												   _expName(""), _draw(0), _filter_size(0), _center_dev(0), _height(0), _width(0), _depth(0), _conv_depth(0), _filter()
+												   _expName(""), _draw(0), _filter_size(0), _center_dev(0), _height(0), _width(0), _depth(0), _conv_depth(0), _input_conv_depth(0), _filter(), _taps(), _rows()
 {
 	add_parameter("draw", _draw);
 	add_parameter("_filter_size", _filter_size);
@@ -40,6 +77,18 @@ Shape TemporalGaussianFilter::compute_shape(const Shape &shape)
 	_width = shape.dim(1);
 	_depth = shape.dim(2);
 	_conv_depth = shape.dim(3) > 3 ? shape.dim(3) : 1;
+	_input_conv_depth = shape.dim(3);
+
+	// The kernel and the clamped frame index of each tap only depend on the shape, they are built once here
+	_filter = _priv::TemporalGaussianFilterHelper::generate_filter(_filter_size, _center_dev);
+	_taps.resize(_conv_depth * _filter_size);
+	for (size_t k = 0; k < _conv_depth; k++)
+		for (size_t fk = 0; fk < _filter_size; fk++)
+			_taps[k * _filter_size + fk] = k + fk > _filter_size / 2 ? std::min(k + fk - _filter_size / 2, _conv_depth - 1) : 0;
+
+	_rows.resize(_height);
+	std::iota(std::begin(_rows), std::end(_rows), 0);
+
 	return Shape({_height, _width, _depth, _conv_depth});
 }
 
@@ -55,49 +104,69 @@ void TemporalGaussianFilter::process_test(const std::string &label, Tensor<float
 
 void TemporalGaussianFilter::_process(const std::string &label, Tensor<InputType> &in) const
 {
-
-	Tensor<float> t2(Shape({_filter_size}));
-	/**
-	 * @brief t2 is the value of (k^2) in the case of 1D temporal filtering.
-	 */
-	for (size_t k = 0; k < _filter_size; k++)
-		t2.at(k) = std::pow((k + 1) - static_cast<float>(_filter_size) / 2.0f - 0.5f, 2.0f);
-
-	Tensor<float> filter(Shape({_filter_size}));
-	float filter_sum = 0;
-
-	for (size_t k = 0; k < _filter_size; k++)
-	{
-		filter.at(k) = 1.0f / std::sqrt(2.0f * static_cast<float>(M_PI)) * (1.0f / _center_dev * std::exp(-t2.at(k) / 2.0f / (_center_dev * _center_dev)));
-		filter_sum += filter.at(k);
-	}
-
-	for (size_t k = 0; k < _filter_size; k++)
-		filter.at(k) /= filter_sum;
-
 	if (in.shape().number() <= 3)
 		throw std::runtime_error("A temporal filter can only be applied when the data has a temporal depth > 1");
 
 	else
 	{
 		Tensor<InputType> out(Shape({_height, _width, _depth, _conv_depth}));
-		for (size_t x = 0; x < _height; x++)
-			for (size_t y = 0; y < _width; y++)
-				for (size_t z = 0; z < _depth; z++)
-					for (size_t k = 0; k < _conv_depth; k++)
-					{
-						float v = 0;
-						for (size_t fk = 0; fk < _filter_size; fk++)
-						{
-							size_t k_in = k + fk > _filter_size / 2 ? std::min(k + fk - _filter_size / 2, _conv_depth - 1) : 0;
-							v += in.at(x, y, z, k_in) * filter.at(fk);
-						}
-
-						out.at(x, y, z, k) = v;
-					}
+		const float *in_data = in.begin();
+		float *out_data = out.begin();
+		size_t in_slice = _width * _depth * _input_conv_depth;
+		size_t out_slice = _width * _depth * _conv_depth;
+
+		// Each row of the height is an independent slice of time rows
+		std::for_each(std::execution::par, std::begin(_rows), std::end(_rows), [&](size_t x)
+					  { _filter_slice(in_data + x * in_slice, out_data + x * out_slice); });
 
 		if (_draw == 1)
 			Tensor<float>::draw_nonscaled_tensor(_file_path + "/Input_frames/" + _expName + "/TGF/TGF_" + label + "_", out);
-		in = out;
+		in = std::move(out);
 	}
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Filters the width*depth time rows of one row of the height.
+ * The slice is transposed in a frame-major scratch buffer, so that each tap becomes a multiply-add between contiguous
+ * frames of all the pixels. The taps are accumulated in the same order as the per pixel convolution.
+ */
+void TemporalGaussianFilter::_filter_slice(const float *in, float *out) const
+{
+	size_t rows = _width * _depth;
+
+	static thread_local std::vector<float> frames;
+	static thread_local std::vector<float> result;
+	frames.resize(rows * _input_conv_depth);
+	result.resize(rows * _conv_depth);
+
+	for (size_t r = 0; r < rows; r++)
+		for (size_t k = 0; k < _input_conv_depth; k++)
+			frames[k * rows + r] = in[r * _input_conv_depth + k];
+
+	std::fill(std::begin(result), std::end(result), 0.0f);
+
+	for (size_t k = 0; k < _conv_depth; k++)
+	{
+		float *dst = result.data() + k * rows;
+		for (size_t fk = 0; fk < _filter_size; fk++)
+		{
+			const float *src = frames.data() + _taps[k * _filter_size + fk] * rows;
+			float w = _filter.at(fk);
+			size_t r = 0;
+#ifdef SMID_AVX256
+			__m256 vw = _mm256_set1_ps(w);
+			for (; r + 8 <= rows; r += 8)
+			{
+				__m256 v = _mm256_add_ps(_mm256_loadu_ps(dst + r), _mm256_mul_ps(_mm256_loadu_ps(src + r), vw));
+				_mm256_storeu_ps(dst + r, v);
+			}
+#endif
+			for (; r < rows; r++)
+				dst[r] += src[r] * w;
+		}
+	}
+
+	for (size_t r = 0; r < rows; r++)
+		for (size_t k = 0; k < _conv_depth; k++)
+			out[r * _conv_depth + k] = result[k * rows + r];
+}
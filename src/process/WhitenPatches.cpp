@@ -2,10 +2,71 @@
 
 using namespace process;
 
+/**
+ * @brief Packs the whitening kernels in a (patch_size*patch_size*depth, depth) matrix, the column z being the kernel of the
+ * output channel z. Applying the whitening is then a single product between the im2col matrix of a sample and this matrix.
+ */
+Tensor<float> process::_priv::WhiteningHelper::filter_matrix(const std::vector<Tensor<float>>& filter) {
+	if(filter.empty()) {
+		return Tensor<float>();
+	}
+
+	size_t patch = filter.front().shape().product();
+	size_t depth = filter.size();
+
+	Tensor<float> matrix(Shape({patch, depth}));
+	for(size_t z=0; z<depth; z++) {
+		if(filter[z].shape().product() != patch) {
+			throw std::runtime_error("Incompatible whitening filter shape "+filter[z].shape().to_string());
+		}
+		for(size_t i=0; i<patch; i++) {
+			matrix.at(i, z) = filter[z].at_index(i);
+		}
+	}
+	return matrix;
+}
+
+/**
+ * @brief Whitens a (width, height, depth) sample with im2col and GEMM: each row of the im2col matrix is the border clamped
+ * patch around a pixel, so the product with the filter matrix gives directly the output in the (x, y, z) layout of the sample.
+ */
+void process::_priv::WhiteningHelper::apply(const Tensor<float>& filter_matrix, size_t patch_size, Tensor<float>& sample) {
+	if(sample.shape().number() != 3) {
+		throw std::runtime_error("Require 3D inputs");
+	}
+	size_t width = sample.shape().dim(0);
+	size_t height = sample.shape().dim(1);
+	size_t depth = sample.shape().dim(2);
+	size_t patch = patch_size*patch_size*depth;
+
+	if(filter_matrix.shape().number() != 2 || filter_matrix.shape().dim(0) != patch || filter_matrix.shape().dim(1) != depth) {
+		throw std::runtime_error("Incompatible whitening filter for "+sample.shape().to_string());
+	}
+
+	static thread_local std::vector<float> columns;
+	columns.resize(width*height*patch);
+
+	for(size_t x=0; x<width; x++) {
+		for(size_t y=0; y<height; y++) {
+			float* row = columns.data()+(x*height+y)*patch;
+			for(size_t fx=0; fx<patch_size; fx++) {
+				size_t x_in = x+fx > patch_size/2 ? std::min(x+fx-patch_size/2, width-1) : 0;
+				for(size_t fy=0; fy<patch_size; fy++) {
+					size_t y_in = y+fy > patch_size/2 ? std::min(y+fy-patch_size/2, height-1) : 0;
+					std::copy(sample.ptr(x_in, y_in, 0), sample.ptr(x_in, y_in, 0)+depth, row+(fx*patch_size+fy)*depth);
+				}
+			}
+		}
+	}
+
+	cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, width*height, depth, patch, 1.0, columns.data(), patch, filter_matrix.begin(), depth, 0.0, sample.begin(), depth);
+}
+
+
 static RegisterClassParameter<WhiteningPatches, ProcessFactory> _register("WhiteningPatches");
 
 WhiteningPatches::WhiteningPatches() : TwoPassProcess(_register), _eps(0), _pca_compress(0),
-	_patch_size(0), _stride(1), _max_sample(), _list(), _filter() {
+	_patch_size(0), _stride(1), _max_sample(), _list(), _filter(), _filter_matrix() {
 	add_parameter("eps", _eps);
 	add_parameter("pca_compress", _pca_compress);
 	add_parameter("patch_size", _patch_size);
@@ -119,6 +180,7 @@ void WhiteningPatches::process_train(const std::string&, Tensor<float>& sample)
 			Tensor<float> response = reshape(dot(flatten(inpulse), w), inpulse.shape());
 			_filter.push_back(response-create(mean(response), response.shape()));
 		}
+		_filter_matrix = _priv::WhiteningHelper::filter_matrix(_filter);
 	}
 
 	_apply(sample);
@@ -129,34 +191,7 @@ void WhiteningPatches::process_test(const std::string&, Tensor<float>& sample) {
 }
 
 void WhiteningPatches::_apply(Tensor<float>& sample) const {
-	if(sample.shape().number() != 3) {
-		throw std::runtime_error("Require 3D inputs");
-	}
-	size_t width = sample.shape().dim(0);
-	size_t height = sample.shape().dim(1);
-	size_t depth = sample.shape().dim(2);
-
-	Tensor<float> out(Shape({width, height, depth}));
-
-	for(size_t z=0; z<depth; z++) {
-		for(size_t x=0; x<width; x++) {
-			for(size_t y=0; y<height; y++) {
-				float v = 0;
-				for(size_t fx=0; fx<_patch_size; fx++) {
-					for(size_t fy=0; fy<_patch_size; fy++) {
-						size_t x_in = x+fx > _patch_size/2 ? std::min(x+fx-_patch_size/2, width-1) : 0;
-						size_t y_in = y+fy > _patch_size/2 ? std::min(y+fy-_patch_size/2, height-1) : 0;
-
-						for(size_t z1=0; z1<depth; z1++) {
-							v += sample.at(x_in, y_in, z1)*_filter.at(z).at(fx, fy, z1);
-						}
-					}
-				}
-				out.at(x, y, z) = v;
-			}
-		}
-	}
-	sample = out;
+	_priv::WhiteningHelper::apply(_filter_matrix, _patch_size, sample);
 }
 
 void WhiteningPatches::save(const std::string& filename) const {
@@ -0,0 +1,91 @@
+#include "tool/CheckpointWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "tool/Tracer.h"
+
+using namespace tool;
+
+CheckpointWriter::CheckpointWriter() : _mutex(), _condition(), _queue(), _writing(false), _running(false), _started(), _thread()
+{
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+	if (_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_running = false;
+		}
+		_condition.notify_all();
+		_thread.join();
+	}
+}
+
+void CheckpointWriter::write(const std::string &filename, std::string content)
+{
+	std::call_once(_started, [this]()
+				   {
+					   _running = true;
+					   _thread = std::thread(&CheckpointWriter::_run, this); });
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = std::find_if(std::begin(_queue), std::end(_queue), [&filename](const std::pair<std::string, std::string> &entry)
+							   { return entry.first == filename; });
+		if (it != std::end(_queue))
+			it->second = std::move(content);
+		else
+			_queue.emplace_back(filename, std::move(content));
+	}
+	_condition.notify_all();
+}
+
+/**
+ * @brief Waits until all the queued files are written.
+ */
+void CheckpointWriter::flush()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_condition.wait(lock, [this]()
+					{ return _queue.empty() && !_writing; });
+}
+
+void CheckpointWriter::_run()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true)
+	{
+		_condition.wait(lock, [this]()
+						{ return !_queue.empty() || !_running; });
+		if (_queue.empty())
+			break;
+
+		std::pair<std::string, std::string> entry = std::move(_queue.front());
+		_queue.pop_front();
+		_writing = true;
+
+		lock.unlock();
+		_write(entry.first, entry.second);
+		lock.lock();
+
+		_writing = false;
+		_condition.notify_all();
+	}
+}
+
+void CheckpointWriter::_write(const std::string &filename, const std::string &content)
+{
+	TraceSpan span("checkpoint", "write " + filename);
+	std::string tmp_filename = filename + ".tmp";
+	std::ofstream file(tmp_filename, std::ios::out | std::ios::trunc | std::ios::binary);
+	file.write(content.data(), content.size());
+	file.close();
+
+	// An exception can't reach the caller from here, the previous version of the file is kept
+	if (!file.good() || std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+		std::cerr << "Can't write file " << filename << std::endl;
+}
@@ -0,0 +1,163 @@
+#include "tool/Counters.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+using namespace tool;
+
+std::atomic<Counters::Block *> Counters::_blocks(nullptr);
+
+void Counters::add_latency(size_t process_index, uint64_t nanoseconds)
+{
+#ifdef PERF_COUNTERS
+	if (process_index >= MaxProcess)
+		return;
+
+	size_t bin = 0;
+	while (bin + 1 < LatencyBinNumber && (nanoseconds >> (bin + 1)) != 0)
+		bin++;
+
+	Block &block = _local();
+	_increment(block.counters[process_index][Samples], 1);
+	_increment(block.counters[process_index][LatencyNanoseconds], nanoseconds);
+	_increment(block.latency[process_index][bin], 1);
+#else
+	(void)process_index;
+	(void)nanoseconds;
+#endif
+}
+
+/**
+ * @brief Sets all the counters to 0, called when no process is running (start of a run).
+ */
+void Counters::reset()
+{
+	for (Block *block = _blocks.load(std::memory_order_acquire); block != nullptr; block = block->next)
+	{
+		for (size_t i = 0; i < MaxProcess; i++)
+		{
+			for (size_t j = 0; j < CounterNumber; j++)
+				block->counters[i][j].store(0, std::memory_order_relaxed);
+			for (size_t j = 0; j < LatencyBinNumber; j++)
+				block->latency[i][j].store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+void Counters::save_json(const std::string &filename, const std::vector<std::string> &process_names)
+{
+	static const char *names[] = {"input_spikes", "output_spikes", "synaptic_integrations", "stdp_updates", "storage_bytes", "samples", "latency_ns"};
+
+	std::ofstream file(filename, std::ios::out | std::ios::trunc);
+	if (!file.good())
+		throw std::runtime_error("Can't open file " + filename);
+
+	std::vector<Summary> summaries = _summarize(process_names.size());
+
+	file << "{\"processes\": [";
+	for (size_t i = 0; i < summaries.size(); i++)
+	{
+		const Summary &summary = summaries[i];
+
+		std::string name;
+		for (char c : process_names[i])
+		{
+			if (c == '"' || c == '\\')
+				name += '\\';
+			name += c;
+		}
+
+		file << (i == 0 ? "" : ",") << "\n\t{\"index\": " << i << ", \"name\": \"" << name << "\"";
+		for (size_t j = 0; j < CounterNumber; j++)
+			file << ", \"" << names[j] << "\": " << summary.counters[j];
+
+		file << ", \"latency_p50_ns\": " << _percentile(summary, 0.5) << ", \"latency_p99_ns\": " << _percentile(summary, 0.99);
+		file << ", \"latency_histogram\": [";
+		for (size_t j = 0; j < LatencyBinNumber; j++)
+			file << (j == 0 ? "" : ", ") << summary.latency[j];
+		file << "]}";
+	}
+	file << "\n]}" << std::endl;
+}
+
+void Counters::save_csv(const std::string &filename, const std::vector<std::string> &process_names)
+{
+	std::ofstream file(filename, std::ios::out | std::ios::trunc);
+	if (!file.good())
+		throw std::runtime_error("Can't open file " + filename);
+
+	std::vector<Summary> summaries = _summarize(process_names.size());
+
+	file << "index,name,input_spikes,output_spikes,synaptic_integrations,stdp_updates,storage_bytes,samples,latency_ns,latency_mean_ns,latency_p50_ns,latency_p99_ns" << std::endl;
+	for (size_t i = 0; i < summaries.size(); i++)
+	{
+		const Summary &summary = summaries[i];
+		file << i << "," << process_names[i];
+		for (size_t j = 0; j < CounterNumber; j++)
+			file << "," << summary.counters[j];
+		file << "," << (summary.counters[Samples] == 0 ? 0 : summary.counters[LatencyNanoseconds] / summary.counters[Samples]);
+		file << "," << _percentile(summary, 0.5) << "," << _percentile(summary, 0.99) << std::endl;
+	}
+}
+
+/**
+ * @brief Block of the calling thread, allocated and pushed on the list on the first call.
+ * The blocks are never freed: the counters of a finished thread are still part of the totals.
+ */
+Counters::Block &Counters::_local()
+{
+	thread_local Block *local = nullptr;
+
+	if (local == nullptr)
+	{
+		local = new Block();
+		for (size_t i = 0; i < MaxProcess; i++)
+		{
+			for (size_t j = 0; j < CounterNumber; j++)
+				local->counters[i][j].store(0, std::memory_order_relaxed);
+			for (size_t j = 0; j < LatencyBinNumber; j++)
+				local->latency[i][j].store(0, std::memory_order_relaxed);
+		}
+
+		local->next = _blocks.load(std::memory_order_relaxed);
+		while (!_blocks.compare_exchange_weak(local->next, local, std::memory_order_release, std::memory_order_relaxed))
+			;
+	}
+
+	return *local;
+}
+
+std::vector<Counters::Summary> Counters::_summarize(size_t process_number)
+{
+	std::vector<Summary> summaries(std::min(process_number, MaxProcess), Summary{});
+
+	for (Block *block = _blocks.load(std::memory_order_acquire); block != nullptr; block = block->next)
+	{
+		for (size_t i = 0; i < summaries.size(); i++)
+		{
+			for (size_t j = 0; j < CounterNumber; j++)
+				summaries[i].counters[j] += block->counters[i][j].load(std::memory_order_relaxed);
+			for (size_t j = 0; j < LatencyBinNumber; j++)
+				summaries[i].latency[j] += block->latency[i][j].load(std::memory_order_relaxed);
+		}
+	}
+
+	return summaries;
+}
+
+/**
+ * @brief Upper bound of the histogram bin containing the p-quantile, in ns.
+ */
+uint64_t Counters::_percentile(const Summary &summary, double p)
+{
+	uint64_t rank = static_cast<uint64_t>(p * summary.counters[Samples]);
+	uint64_t count = 0;
+	for (size_t j = 0; j < LatencyBinNumber; j++)
+	{
+		count += summary.latency[j];
+		if (count > rank)
+			return (static_cast<uint64_t>(1) << (j + 1)) - 1;
+	}
+	return 0;
+}
@@ -0,0 +1,286 @@
+#include "tool/LinearSvm.h"
+
+#include <algorithm>
+#include <execution>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace tool;
+
+//
+//	Problem
+//
+
+LinearSvm::Problem::Problem() : offsets(1, 0), indexes(), values(), labels()
+{
+}
+
+void LinearSvm::Problem::clear()
+{
+	offsets.assign(1, 0);
+	indexes.clear();
+	values.clear();
+	labels.clear();
+}
+
+void LinearSvm::Problem::reserve(size_t sample_number, size_t value_number)
+{
+	offsets.reserve(sample_number + 1);
+	labels.reserve(sample_number);
+	indexes.reserve(value_number);
+	values.reserve(value_number);
+}
+
+void LinearSvm::Problem::add_value(uint32_t index, float value)
+{
+	indexes.push_back(index);
+	values.push_back(value);
+}
+
+void LinearSvm::Problem::end_sample(size_t label)
+{
+	offsets.push_back(indexes.size());
+	labels.push_back(label);
+}
+
+/**
+ * @brief Copies the sample i of another problem, used to build the cross-validation folds.
+ */
+void LinearSvm::Problem::add_sample(const Problem &from, size_t i)
+{
+	indexes.insert(std::end(indexes), std::begin(from.indexes) + from.offsets[i], std::begin(from.indexes) + from.offsets[i + 1]);
+	values.insert(std::end(values), std::begin(from.values) + from.offsets[i], std::begin(from.values) + from.offsets[i + 1]);
+	end_sample(from.labels[i]);
+}
+
+size_t LinearSvm::Problem::sample_number() const
+{
+	return labels.size();
+}
+
+//
+//	LinearSvm
+//
+
+LinearSvm::LinearSvm(float eps, size_t max_iteration) : _eps(eps), _max_iteration(max_iteration),
+														_feature_number(0), _class_number(0), _classifier_number(0), _weights(), _alpha()
+{
+}
+
+/**
+ * @brief Trains one classifier per class against all the others. With two classes, a single classifier separates the first one from the second.
+ * With warm_start, the dual variables of the previous training on the same problem are clipped to [0, c] and used as the starting point.
+ */
+void LinearSvm::train(const Problem &problem, size_t feature_number, size_t class_number, float c, bool warm_start)
+{
+	if (class_number < 2)
+		throw std::runtime_error("LinearSvm: at least two classes are required, got " + std::to_string(class_number));
+
+	if (std::any_of(std::begin(problem.indexes), std::end(problem.indexes), [feature_number](uint32_t index)
+					{ return index >= feature_number; }))
+		throw std::runtime_error("LinearSvm: feature index out of range");
+
+	size_t l = problem.sample_number();
+	size_t classifier_number = class_number == 2 ? 1 : class_number;
+
+	if (warm_start && feature_number == _feature_number && classifier_number == _classifier_number && _alpha.size() == classifier_number * l)
+		std::transform(std::begin(_alpha), std::end(_alpha), std::begin(_alpha), [c](double alpha)
+					   { return std::min(alpha, static_cast<double>(c)); });
+	else
+		_alpha.assign(classifier_number * l, 0.0);
+
+	_feature_number = feature_number;
+	_class_number = class_number;
+	_classifier_number = classifier_number;
+
+	// The classifiers are independent, each one is solved in its own buffer
+	std::vector<double> weights(_classifier_number * (_feature_number + 1), 0.0);
+	std::vector<size_t> classifiers(_classifier_number);
+	std::iota(std::begin(classifiers), std::end(classifiers), 0);
+	std::for_each(std::execution::par, std::begin(classifiers), std::end(classifiers), [&](size_t k)
+				  { _solve(problem, k, c, weights.data() + k * (_feature_number + 1), _alpha.data() + k * l); });
+
+	_weights.resize(weights.size());
+	for (size_t k = 0; k < _classifier_number; k++)
+		for (size_t j = 0; j <= _feature_number; j++)
+			_weights[j * _classifier_number + k] = weights[k * (_feature_number + 1) + j];
+}
+
+size_t LinearSvm::predict(const uint32_t *indexes, const float *values, size_t n) const
+{
+	std::vector<double> scores(_classifier_number);
+	return _decide(indexes, values, n, scores.data());
+}
+
+/**
+ * @brief Predicts all the samples of a problem, the rows are split in blocks evaluated in parallel.
+ */
+void LinearSvm::predict(const Problem &problem, std::vector<size_t> &predictions) const
+{
+	constexpr size_t BlockSize = 256;
+
+	size_t l = problem.sample_number();
+	predictions.resize(l);
+
+	std::vector<size_t> blocks((l + BlockSize - 1) / BlockSize);
+	std::iota(std::begin(blocks), std::end(blocks), 0);
+	std::for_each(std::execution::par, std::begin(blocks), std::end(blocks), [&](size_t block)
+				  {
+					  std::vector<double> scores(_classifier_number);
+					  for (size_t i = block * BlockSize; i < std::min(l, (block + 1) * BlockSize); i++)
+					  {
+						  size_t offset = problem.offsets[i];
+						  predictions[i] = _decide(problem.indexes.data() + offset, problem.values.data() + offset, problem.offsets[i + 1] - offset, scores.data());
+					  } });
+}
+
+size_t LinearSvm::class_number() const
+{
+	return _class_number;
+}
+
+/**
+ * @brief Accumulates the rows of the weight matrix selected by the non-zero features, then picks the best classifier.
+ */
+size_t LinearSvm::_decide(const uint32_t *indexes, const float *values, size_t n, double *scores) const
+{
+	const double *bias = _weights.data() + _feature_number * _classifier_number;
+	std::copy(bias, bias + _classifier_number, scores);
+
+	for (size_t j = 0; j < n; j++)
+	{
+		if (indexes[j] >= _feature_number)
+			continue;
+
+		const double *w = _weights.data() + indexes[j] * _classifier_number;
+		double v = values[j];
+		for (size_t k = 0; k < _classifier_number; k++)
+			scores[k] += w[k] * v;
+	}
+
+	if (_classifier_number == 1)
+		return scores[0] > 0 ? 0 : 1;
+	return std::max_element(scores, scores + _classifier_number) - scores;
+}
+
+/**
+ * @brief Dual coordinate descent with shrinking. Each step optimizes one dual variable alpha_i in [0, c] in closed form and
+ * updates w = sum alpha_i y_i x_i incrementally. The samples whose projected gradient shows they will stay at a bound are
+ * removed from the active set until the tolerance is reached on it, then the full set is checked again.
+ */
+void LinearSvm::_solve(const Problem &problem, size_t positive_class, float c, double *w, double *alpha) const
+{
+	const size_t l = problem.sample_number();
+	const double upper_bound = c;
+
+	std::vector<double> qd(l);
+	std::vector<int8_t> y(l);
+	std::vector<size_t> index(l);
+	std::iota(std::begin(index), std::end(index), 0);
+
+	for (size_t i = 0; i < l; i++)
+	{
+		y[i] = problem.labels[i] == positive_class ? 1 : -1;
+		double norm = 1.0; // bias feature
+		for (size_t j = problem.offsets[i]; j < problem.offsets[i + 1]; j++)
+			norm += static_cast<double>(problem.values[j]) * problem.values[j];
+		qd[i] = norm;
+
+		// w = sum alpha_i y_i x_i, non-zero only when warm started
+		if (alpha[i] != 0.0)
+		{
+			double d = alpha[i] * y[i];
+			for (size_t j = problem.offsets[i]; j < problem.offsets[i + 1]; j++)
+				w[problem.indexes[j]] += d * problem.values[j];
+			w[_feature_number] += d;
+		}
+	}
+
+	std::mt19937 random(0);
+
+	size_t active_size = l;
+	double pg_max_old = std::numeric_limits<double>::infinity();
+	double pg_min_old = -std::numeric_limits<double>::infinity();
+
+	for (size_t iteration = 0; iteration < _max_iteration; iteration++)
+	{
+		double pg_max_new = -std::numeric_limits<double>::infinity();
+		double pg_min_new = std::numeric_limits<double>::infinity();
+
+		for (size_t s = 0; s < active_size; s++)
+		{
+			std::uniform_int_distribution<size_t> distribution(s, active_size - 1);
+			std::swap(index[s], index[distribution(random)]);
+		}
+
+		size_t s = 0;
+		while (s < active_size)
+		{
+			size_t i = index[s];
+			double g = w[_feature_number];
+			for (size_t j = problem.offsets[i]; j < problem.offsets[i + 1]; j++)
+				g += w[problem.indexes[j]] * problem.values[j];
+			g = g * y[i] - 1.0;
+
+			double pg = 0.0;
+			if (alpha[i] == 0.0)
+			{
+				if (g > pg_max_old)
+				{
+					active_size--;
+					std::swap(index[s], index[active_size]);
+					continue;
+				}
+				else if (g < 0.0)
+					pg = g;
+			}
+			else if (alpha[i] == upper_bound)
+			{
+				if (g < pg_min_old)
+				{
+					active_size--;
+					std::swap(index[s], index[active_size]);
+					continue;
+				}
+				else if (g > 0.0)
+					pg = g;
+			}
+			else
+				pg = g;
+
+			pg_max_new = std::max(pg_max_new, pg);
+			pg_min_new = std::min(pg_min_new, pg);
+
+			if (std::fabs(pg) > 1e-12)
+			{
+				double alpha_old = alpha[i];
+				alpha[i] = std::min(std::max(alpha[i] - g / qd[i], 0.0), upper_bound);
+				double d = (alpha[i] - alpha_old) * y[i];
+				for (size_t j = problem.offsets[i]; j < problem.offsets[i + 1]; j++)
+					w[problem.indexes[j]] += d * problem.values[j];
+				w[_feature_number] += d;
+			}
+
+			s++;
+		}
+
+		if (pg_max_new - pg_min_new <= _eps)
+		{
+			if (active_size == l)
+				break;
+
+			// Converged on the active set, check the whole set before stopping
+			active_size = l;
+			pg_max_old = std::numeric_limits<double>::infinity();
+			pg_min_old = -std::numeric_limits<double>::infinity();
+			continue;
+		}
+
+		pg_max_old = pg_max_new <= 0 ? std::numeric_limits<double>::infinity() : pg_max_new;
+		pg_min_old = pg_min_new >= 0 ? -std::numeric_limits<double>::infinity() : pg_min_new;
+	}
+}
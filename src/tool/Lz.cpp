@@ -0,0 +1,140 @@
+#include "tool/Lz.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace tool;
+
+static constexpr size_t MinMatch = 4;
+static constexpr size_t MaxOffset = 65535;
+static constexpr size_t HashBits = 14;
+// The last bytes are always literals, so that a match never reads past the end of the block
+static constexpr size_t LastLiterals = 5;
+
+static uint32_t read_u32(const char* ptr) {
+	uint32_t value;
+	std::memcpy(&value, ptr, sizeof(uint32_t));
+	return value;
+}
+
+static size_t hash(uint32_t sequence) {
+	return (sequence*2654435761u) >> (32-HashBits);
+}
+
+static void write_length(size_t length, std::string& dst) {
+	while(length >= 255) {
+		dst.push_back(static_cast<char>(255));
+		length -= 255;
+	}
+	dst.push_back(static_cast<char>(length));
+}
+
+static void write_sequence(const char* literals, size_t literal_length, size_t match_length, size_t offset, std::string& dst) {
+	size_t match_code = match_length >= MinMatch ? match_length-MinMatch : 0;
+	uint8_t token = static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15));
+	dst.push_back(static_cast<char>(token));
+
+	if(literal_length >= 15)
+		write_length(literal_length-15, dst);
+	dst.append(literals, literal_length);
+
+	if(match_length >= MinMatch) {
+		dst.push_back(static_cast<char>(offset & 0xFF));
+		dst.push_back(static_cast<char>(offset >> 8));
+		if(match_code >= 15)
+			write_length(match_code-15, dst);
+	}
+}
+
+void Lz::compress(const char* src, size_t size, std::string& dst) {
+	size_t anchor = 0;
+
+	if(size > MinMatch+LastLiterals) {
+		std::vector<uint32_t> table(static_cast<size_t>(1) << HashBits, 0);
+		size_t limit = size-LastLiterals;
+
+		// Positions are stored +1, 0 is an empty slot
+		size_t i = 0;
+		while(i+MinMatch <= limit) {
+			uint32_t sequence = read_u32(src+i);
+			size_t slot = hash(sequence);
+			size_t candidate = table[slot];
+			table[slot] = static_cast<uint32_t>(i+1);
+
+			if(candidate == 0 || i+1-candidate > MaxOffset || read_u32(src+candidate-1) != sequence) {
+				i++;
+				continue;
+			}
+			candidate--;
+
+			size_t length = MinMatch;
+			while(i+length < limit && src[candidate+length] == src[i+length])
+				length++;
+
+			write_sequence(src+anchor, i-anchor, length, i-candidate, dst);
+
+			i += length;
+			anchor = i;
+		}
+	}
+
+	write_sequence(src+anchor, size-anchor, 0, 0, dst);
+}
+
+void Lz::decompress(const char* src, size_t size, char* dst, size_t raw_size) {
+	size_t in = 0;
+	size_t out = 0;
+
+	auto read_length = [&](size_t length) {
+		if(length == 15) {
+			uint8_t byte;
+			do {
+				if(in >= size)
+					throw std::runtime_error("Lz: truncated block");
+				byte = static_cast<uint8_t>(src[in++]);
+				length += byte;
+			} while(byte == 255);
+		}
+		return length;
+	};
+
+	while(in < size) {
+		uint8_t token = static_cast<uint8_t>(src[in++]);
+
+		size_t literal_length = read_length(token >> 4);
+		if(literal_length > size-in || literal_length > raw_size-out)
+			throw std::runtime_error("Lz: corrupted block (literals)");
+		std::memcpy(dst+out, src+in, literal_length);
+		in += literal_length;
+		out += literal_length;
+
+		if(in == size)
+			break;
+
+		if(size-in < 2)
+			throw std::runtime_error("Lz: truncated block");
+		size_t offset = static_cast<uint8_t>(src[in]) | (static_cast<size_t>(static_cast<uint8_t>(src[in+1])) << 8);
+		in += 2;
+
+		size_t match_length = read_length(token & 0x0F)+MinMatch;
+		if(offset == 0 || offset > out || match_length > raw_size-out)
+			throw std::runtime_error("Lz: corrupted block (match)");
+
+		// The match may overlap its own output (offset < length): copy byte by byte
+		const char* match = dst+out-offset;
+		if(offset >= match_length) {
+			std::memcpy(dst+out, match, match_length);
+		}
+		else {
+			for(size_t k=0; k<match_length; k++)
+				dst[out+k] = match[k];
+		}
+		out += match_length;
+	}
+
+	if(out != raw_size)
+		throw std::runtime_error("Lz: block size mismatch");
+}
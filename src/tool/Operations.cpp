@@ -585,36 +585,6 @@ void JSONstringEdits(std::string fileName)
     _jsonTextFile.close();
 }
 
-/**
- * @brief This function saves the log of which neuron fired at which sample.
- *
- * @param fileName the save location of the csv file that contains the data.
- * @param label the label of the class responsible for these weights
- * @param neuron the neuron that fired.
- */
-void LogSpikingNeuron(std::string fileName, std::string label, size_t neuron)
-{
-    std::ofstream _File;
-    _File.open(fileName + ".csv", std::ios_base::app);
-    _File << std::to_string(neuron) + "," + label + "\n";
-    //_File << "N: " << neuron << "  L: " << label << std::endl;
-    _File.close();
-}
-
-/**
- * @brief This function saves the filter that has been updated, this can shed a light on which filter has been updated how many times.
- *
- * @param fileName the save location of the txt file that contains the info.
- */
-void LogUpdatedFilter(std::string fileName, size_t filter_number)
-{
-    std::ofstream _File;
-    _File.open(fileName + ".txt", std::ios_base::app);
-    _File << filter_number << "\n";
-    _File.close();
-}
-
-
 /**
  * @brief This function saves the number of spikes per layer.
  *
@@ -0,0 +1,267 @@
+#include "tool/Quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace tool;
+
+//
+//	QuantizedWeights
+//
+
+QuantizedWeights::QuantizedWeights() : _ready(false), _narrow(true), _scale(1.0f), _filter_number(0), _w(), _th16(), _th32() {
+
+}
+
+void QuantizedWeights::quantize(const Tensor<float>& w, const Tensor<float>& th, size_t synapse_number, size_t filter_number) {
+	if(w.shape().product() != synapse_number*filter_number || th.shape().product() != filter_number) {
+		throw std::runtime_error("QuantizedWeights: unexpected weight or threshold shape");
+	}
+
+	float max_w = 0.0f;
+	for(const float value : w) {
+		if(value < 0.0f) {
+			throw std::runtime_error("QuantizedWeights: the integer inference needs non-negative weights");
+		}
+		max_w = std::max(max_w, value);
+	}
+
+	_filter_number = filter_number;
+	_scale = max_w > 0.0f ? 255.0f/max_w : 1.0f;
+	_w.resize(synapse_number*filter_number);
+
+	std::vector<int64_t> sum(filter_number, 0);
+	for(size_t i=0; i<synapse_number; i++) {
+		const float* src = w.begin()+i*filter_number;
+		uint8_t* dst = _w.data()+i*filter_number;
+		for(size_t z=0; z<filter_number; z++) {
+			dst[z] = static_cast<uint8_t>(std::min(std::lround(src[z]*_scale), 255L));
+			sum[z] += dst[z];
+		}
+	}
+
+	// A threshold above the sum of the weights of its filter can't be reached, clamping it keeps it in the potential type
+	int64_t max_sum = *std::max_element(std::begin(sum), std::end(sum));
+	_narrow = max_sum < std::numeric_limits<int16_t>::max();
+
+	_th16.resize(filter_number);
+	_th32.resize(filter_number);
+	for(size_t z=0; z<filter_number; z++) {
+		int64_t value = std::min(std::max(static_cast<int64_t>(std::llround(static_cast<double>(th.at_index(z))*_scale)), static_cast<int64_t>(0)), sum[z]+1);
+		_th32[z] = static_cast<int32_t>(value);
+		_th16[z] = _narrow ? static_cast<int16_t>(value) : 0;
+	}
+
+	_ready = true;
+}
+
+bool QuantizedWeights::integrate(int16_t* a, const uint8_t* w, const int16_t* th, size_t n) {
+	size_t z = 0;
+	bool crossed = false;
+
+#ifdef __AVX2__
+	// th > a on every lane of the vector when no neuron reached its threshold
+	__m256i below = _mm256_set1_epi16(-1);
+	for(; z+16<=n; z+=16) {
+		__m256i weights = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w+z)));
+		__m256i potentials = _mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a+z)), weights);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(a+z), potentials);
+		below = _mm256_and_si256(below, _mm256_cmpgt_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(th+z)), potentials));
+	}
+	crossed = _mm256_movemask_epi8(below) != -1;
+#endif
+
+	for(; z<n; z++) {
+		a[z] += w[z];
+		crossed |= a[z] >= th[z];
+	}
+
+	return crossed;
+}
+
+bool QuantizedWeights::integrate(int32_t* a, const uint8_t* w, const int32_t* th, size_t n) {
+	size_t z = 0;
+	bool crossed = false;
+
+#ifdef __AVX2__
+	__m256i below = _mm256_set1_epi32(-1);
+	for(; z+8<=n; z+=8) {
+		__m256i weights = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(w+z)));
+		__m256i potentials = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a+z)), weights);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(a+z), potentials);
+		below = _mm256_and_si256(below, _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(th+z)), potentials));
+	}
+	crossed = _mm256_movemask_epi8(below) != -1;
+#endif
+
+	for(; z<n; z++) {
+		a[z] += w[z];
+		crossed |= a[z] >= th[z];
+	}
+
+	return crossed;
+}
+
+//
+//	BinaryWeights
+//
+
+BinaryWeights::BinaryWeights() : _ready(false), _word_number(0), _plane_number(0), _density(0.0f), _error(0.0f), _w(), _initial() {
+
+}
+
+void BinaryWeights::binarize(const Tensor<float>& w, const Tensor<float>& th, size_t synapse_number, size_t filter_number, float cut) {
+	if(w.shape().product() != synapse_number*filter_number || th.shape().product() != filter_number) {
+		throw std::runtime_error("BinaryWeights: unexpected weight or threshold shape");
+	}
+
+	_word_number = (filter_number+63)/64;
+	_w.assign(synapse_number*_word_number, 0);
+
+	size_t ones = 0;
+	double error = 0.0;
+	for(size_t i=0; i<synapse_number; i++) {
+		const float* src = w.begin()+i*filter_number;
+		uint64_t* dst = _w.data()+i*_word_number;
+		for(size_t z=0; z<filter_number; z++) {
+			bool one = src[z] >= cut;
+			if(one) {
+				dst[z/64] |= static_cast<uint64_t>(1) << (z%64);
+				ones++;
+			}
+			error += std::abs(static_cast<double>(src[z])-(one ? 1.0 : 0.0));
+		}
+	}
+
+	size_t weight_number = std::max(synapse_number*filter_number, static_cast<size_t>(1));
+	_density = static_cast<float>(ones)/static_cast<float>(weight_number);
+	_error = static_cast<float>(error/static_cast<double>(weight_number));
+
+	// A counter holds at most synapse_number ones on top of its initial value 2^B - th, with th <= synapse_number+1 < 2^B
+	size_t bit_number = 1;
+	while((static_cast<size_t>(1) << bit_number) <= synapse_number+1) {
+		bit_number++;
+	}
+	_plane_number = bit_number+1;
+
+	_initial.assign(counter_size(), 0);
+	for(size_t z=0; z<filter_number; z++) {
+		uint64_t threshold = static_cast<uint64_t>(std::min(std::max(std::ceil(static_cast<double>(th.at_index(z))), 0.0), static_cast<double>(synapse_number+1)));
+		uint64_t value = (static_cast<uint64_t>(1) << bit_number)-threshold;
+		for(size_t plane=0; plane<_plane_number; plane++) {
+			if((value >> plane) & 1) {
+				_initial[plane*_word_number+z/64] |= static_cast<uint64_t>(1) << (z%64);
+			}
+		}
+	}
+
+	_ready = true;
+}
+
+void BinaryWeights::reset(std::vector<uint64_t>& counters, size_t position_number) const {
+	counters.resize(position_number*counter_size());
+	for(size_t p=0; p<position_number; p++) {
+		std::copy(std::begin(_initial), std::end(_initial), counters.data()+p*counter_size());
+	}
+}
+
+std::string BinaryWeights::to_string() const {
+	std::ostringstream ss;
+	ss << 100.0f*_density << "% of the weights at 1, mean binarization error " << _error;
+	return ss.str();
+}
+
+//
+//	QuantizationReport
+//
+
+static uint64_t neuron_key(const Spike& spike) {
+	return (static_cast<uint64_t>(spike.x) << 40) | (static_cast<uint64_t>(spike.y) << 32) | (static_cast<uint64_t>(spike.z) << 16) | spike.k;
+}
+
+QuantizationReport::QuantizationReport() : _sample_number(0), _reference_spikes(0), _quantized_spikes(0), _matched(0), _retimed(0),
+	_ordered_samples(0), _displacement(0.0), _max_time_shift(0.0) {
+
+}
+
+void QuantizationReport::reset() {
+	*this = QuantizationReport();
+}
+
+void QuantizationReport::add(const std::vector<Spike>& reference, const std::vector<Spike>& quantized) {
+	_sample_number++;
+	_reference_spikes += reference.size();
+	_quantized_spikes += quantized.size();
+
+	// First spike of each neuron (a neuron fires again when the inhibition is disabled)
+	std::unordered_map<uint64_t, size_t> first;
+	first.reserve(reference.size());
+	for(size_t i=0; i<reference.size(); i++) {
+		first.emplace(neuron_key(reference[i]), i);
+	}
+
+	// Index in reference of the matched neurons, in the order of the quantized spike train
+	std::vector<size_t> matched;
+	std::unordered_map<uint64_t, bool> seen;
+	seen.reserve(quantized.size());
+	for(const Spike& spike : quantized) {
+		uint64_t key = neuron_key(spike);
+		auto it = first.find(key);
+		if(it == std::end(first) || !seen.emplace(key, true).second) {
+			continue;
+		}
+		matched.push_back(it->second);
+
+		double shift = std::abs(static_cast<double>(spike.time)-static_cast<double>(reference[it->second].time));
+		if(shift > 0.0) {
+			_retimed++;
+		}
+		_max_time_shift = std::max(_max_time_shift, shift);
+	}
+
+	if(matched.empty()) {
+		return;
+	}
+
+	// Rank of each matched neuron among the matched neurons of reference
+	std::vector<size_t> sorted(matched);
+	std::sort(std::begin(sorted), std::end(sorted));
+	double displacement = 0.0;
+	for(size_t rank=0; rank<matched.size(); rank++) {
+		size_t reference_rank = std::lower_bound(std::begin(sorted), std::end(sorted), matched[rank])-std::begin(sorted);
+		displacement += std::abs(static_cast<double>(reference_rank)-static_cast<double>(rank));
+	}
+
+	double n = static_cast<double>(matched.size());
+	_matched += matched.size();
+	_displacement += displacement/(n*n);
+	_ordered_samples++;
+}
+
+double QuantizationReport::match_ratio() const {
+	size_t spikes = std::max(_reference_spikes, _quantized_spikes);
+	return spikes > 0 ? static_cast<double>(_matched)/static_cast<double>(spikes) : 1.0;
+}
+
+double QuantizationReport::retimed_ratio() const {
+	return _matched > 0 ? static_cast<double>(_retimed)/static_cast<double>(_matched) : 0.0;
+}
+
+double QuantizationReport::rank_displacement() const {
+	return _ordered_samples > 0 ? _displacement/static_cast<double>(_ordered_samples) : 0.0;
+}
+
+std::string QuantizationReport::to_string() const {
+	std::ostringstream ss;
+	ss << _sample_number << " samples, spikes: " << _reference_spikes << " float / " << _quantized_spikes << " quantized, "
+	   << 100.0*match_ratio() << "% matched, " << 100.0*retimed_ratio() << "% retimed (max shift " << _max_time_shift << "), "
+	   << "firing order change " << rank_displacement();
+	return ss.str();
+}
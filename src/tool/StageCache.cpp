@@ -0,0 +1,69 @@
+#include "tool/StageCache.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+using namespace tool;
+
+StageCache::StageCache() : _path() {
+
+}
+
+void StageCache::open(const std::string& path) {
+	std::filesystem::create_directories(path);
+	_path = path;
+}
+
+std::string StageCache::key(const std::string& parent, const std::string& content) {
+	// FNV-1a-128: offset basis 0x6c62272e07bb014262b821756295c58d, prime 2^88 + 0x13b
+	// The hash is kept as two 64 bits halves, the product by the prime is the product by 0x13b plus the low half shifted by 88 bits
+	const uint64_t prime_low = 0x13b;
+	uint64_t hash_high = 0x6c62272e07bb0142ULL;
+	uint64_t hash_low = 0x62b821756295c58dULL;
+
+	// The parent key has a fixed length, so the content can't shift into it
+	for(const std::string* data : {&parent, &content}) {
+		for(const char c : *data) {
+			hash_low ^= static_cast<uint8_t>(c);
+
+			// hash_low * 0x13b on 128 bits, from its 32 bits halves
+			uint64_t product_low = (hash_low & 0xffffffffULL) * prime_low;
+			uint64_t product_middle = (hash_low >> 32) * prime_low + (product_low >> 32);
+
+			hash_high = hash_high * prime_low + (product_middle >> 32) + (hash_low << 24);
+			hash_low = (product_middle << 32) | (product_low & 0xffffffffULL);
+		}
+	}
+
+	std::ostringstream ss;
+	ss << std::hex << std::setfill('0') << std::setw(16) << hash_high << std::setw(16) << hash_low;
+	return ss.str();
+}
+
+bool StageCache::contains(const std::string& key) const {
+	return is_open() && std::filesystem::is_directory(entry_path(key));
+}
+
+std::string StageCache::entry_path(const std::string& key) const {
+	return _path + "/" + key;
+}
+
+std::string StageCache::begin(const std::string& key) {
+	if(!is_open()) {
+		throw std::runtime_error("StageCache: no cache directory");
+	}
+
+	std::string path = entry_path(key) + ".tmp";
+	std::filesystem::remove_all(path);
+	std::filesystem::create_directories(path);
+	return path;
+}
+
+void StageCache::commit(const std::string& key) {
+	std::string path = entry_path(key);
+	std::filesystem::remove_all(path);
+	std::filesystem::rename(path + ".tmp", path);
+}
@@ -0,0 +1,139 @@
+#include "tool/Tracer.h"
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+using namespace tool;
+
+std::atomic<bool> Tracer::_enabled(false);
+std::mutex Tracer::_mutex;
+std::vector<std::shared_ptr<Tracer::Buffer>> Tracer::_buffers;
+
+//
+//	Tracer
+//
+
+void Tracer::enable(bool enable)
+{
+	_enabled.store(enable, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Microseconds since the first call, the time base of the trace.
+ */
+int64_t Tracer::now()
+{
+	static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Tracer::record(const char *category, std::string name, int64_t start, int64_t end)
+{
+	Buffer &buffer = _local();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+
+	Event event{category, std::move(name), start, end - start};
+	if (buffer.events.size() < Capacity)
+		buffer.events.push_back(std::move(event));
+	else
+		buffer.events[buffer.next] = std::move(event);
+	buffer.next = (buffer.next + 1) % Capacity;
+}
+
+/**
+ * @brief Writes the spans of all the threads, then clears the buffers.
+ */
+void Tracer::save(const std::string &filename)
+{
+	std::ofstream file(filename, std::ios::out | std::ios::trunc);
+	if (!file.good())
+		throw std::runtime_error("Can't open file " + filename);
+
+	auto escape = [](const std::string &str)
+	{
+		std::string out;
+		for (char c : str)
+		{
+			if (c == '"' || c == '\\')
+				out += '\\';
+			if (static_cast<unsigned char>(c) < 0x20)
+				out += ' ';
+			else
+				out += c;
+		}
+		return out;
+	};
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+	bool first = true;
+	for (const std::shared_ptr<Buffer> &buffer : _buffers)
+	{
+		std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+
+		// Oldest first: once the ring is full, it starts at the next slot to overwrite
+		size_t size = buffer->events.size();
+		size_t begin = size < Capacity ? 0 : buffer->next;
+		for (size_t i = 0; i < size; i++)
+		{
+			const Event &event = buffer->events[(begin + i) % size];
+			file << (first ? "" : ",") << "\n{\"name\": \"" << escape(event.name) << "\", \"cat\": \"" << event.category
+				 << "\", \"ph\": \"X\", \"ts\": " << event.start << ", \"dur\": " << event.duration
+				 << ", \"pid\": 1, \"tid\": " << buffer->thread_id << "}";
+			first = false;
+		}
+
+		buffer->events.clear();
+		buffer->next = 0;
+	}
+	file << "\n]}" << std::endl;
+}
+
+/**
+ * @brief Buffer of the calling thread, created on its first span. It is kept after the end of the thread, until the trace is saved.
+ */
+Tracer::Buffer &Tracer::_local()
+{
+	thread_local std::shared_ptr<Buffer> local;
+
+	if (!local)
+	{
+		local = std::make_shared<Buffer>();
+		local->next = 0;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		local->thread_id = _buffers.size() + 1;
+		_buffers.push_back(local);
+	}
+
+	return *local;
+}
+
+//
+//	TraceSpan
+//
+
+TraceSpan::TraceSpan(const char *category, const std::string &name) : _category(category), _name(), _start(0), _open(Tracer::enabled())
+{
+	if (_open)
+	{
+		_name = name;
+		_start = Tracer::now();
+	}
+}
+
+TraceSpan::~TraceSpan()
+{
+	end();
+}
+
+void TraceSpan::end()
+{
+	if (_open)
+	{
+		Tracer::record(_category, std::move(_name), _start, Tracer::now());
+		_open = false;
+	}
+}
@@ -0,0 +1,232 @@
+#include "tool/WeightLogger.h"
+
+#include <filesystem>
+#include <iostream>
+
+using namespace tool;
+
+WeightLogger::WeightLogger(size_t capacity) : _cells(), _mask(0), _enqueue_position(0), _dequeue_position(0),
+											  _pushed_count(0), _flushed_count(0), _running(false), _sleeping(false), _wake_mutex(), _wake(), _flushed(), _started(), _thread(), _files()
+{
+	size_t size = 1;
+	while (size < std::max<size_t>(capacity, 2))
+		size *= 2;
+
+	_cells.reset(new Cell[size]);
+	for (size_t i = 0; i < size; i++)
+	{
+		_cells[i].sequence.store(i, std::memory_order_relaxed);
+		_cells[i].record = nullptr;
+	}
+	_mask = size - 1;
+}
+
+WeightLogger::~WeightLogger()
+{
+	if (_thread.joinable())
+	{
+		_running.store(false, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(_wake_mutex);
+			_wake.notify_one();
+		}
+		_thread.join();
+	}
+}
+
+/**
+ * @brief Queues a copy of the weights, the copy is the only work done on the calling thread.
+ */
+void WeightLogger::log_weights(const std::string &path, const std::string &label, const Tensor<float> &w)
+{
+	std::unique_ptr<Record> record(new Record());
+	record->weights = true;
+	record->path = path;
+	record->label = label;
+	record->value = 0;
+	for (size_t i = 0; i < w.shape().number(); i++)
+		record->dims.push_back(w.shape().dim(i));
+	record->data.assign(w.begin(), w.end());
+	_push(std::move(record));
+}
+
+void WeightLogger::log_event(const std::string &path, const std::string &label, uint32_t value)
+{
+	std::unique_ptr<Record> record(new Record());
+	record->weights = false;
+	record->path = path;
+	record->label = label;
+	record->value = value;
+	_push(std::move(record));
+}
+
+/**
+ * @brief Waits until all the records queued before the call are written to the files.
+ */
+void WeightLogger::flush()
+{
+	size_t pushed_count = _pushed_count.load(std::memory_order_acquire);
+	std::unique_lock<std::mutex> lock(_wake_mutex);
+	_flushed.wait(lock, [this, pushed_count]()
+				  { return _flushed_count.load(std::memory_order_acquire) >= pushed_count; });
+}
+
+/**
+ * @brief Snapshot rule shared by the layers: every interval-th weight update, or only the first one when interval is 0.
+ */
+bool WeightLogger::is_snapshot(size_t update_index, size_t interval)
+{
+	return interval == 0 ? update_index == 0 : update_index % interval == 0;
+}
+
+/**
+ * @brief Bounded multi-producer queue (D. Vyukov): each cell carries a sequence number telling whether it is free for the
+ * producer of a given position or ready for the consumer, so that a position is claimed with a single compare-and-swap.
+ */
+void WeightLogger::_push(std::unique_ptr<Record> record)
+{
+	std::call_once(_started, [this]()
+				   {
+					   _running.store(true, std::memory_order_release);
+					   _thread = std::thread(&WeightLogger::_run, this); });
+
+	size_t position = _enqueue_position.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Cell &cell = _cells[position & _mask];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+		if (difference == 0)
+		{
+			if (_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				cell.record = record.release();
+				cell.sequence.store(position + 1, std::memory_order_release);
+				// Sequentially consistent with _sleeping: either the writer sees the record before sleeping, or this sees it asleep
+				_pushed_count.fetch_add(1);
+				if (_sleeping.load())
+				{
+					std::lock_guard<std::mutex> lock(_wake_mutex);
+					_wake.notify_one();
+				}
+				return;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Full, wait for the writer
+			std::this_thread::yield();
+			position = _enqueue_position.load(std::memory_order_relaxed);
+		}
+		else
+			position = _enqueue_position.load(std::memory_order_relaxed);
+	}
+}
+
+WeightLogger::Record *WeightLogger::_pop()
+{
+	size_t position = _dequeue_position.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Cell &cell = _cells[position & _mask];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+		if (difference == 0)
+		{
+			if (_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				Record *record = cell.record;
+				cell.sequence.store(position + _mask + 1, std::memory_order_release);
+				return record;
+			}
+		}
+		else if (difference < 0)
+			return nullptr;
+		else
+			position = _dequeue_position.load(std::memory_order_relaxed);
+	}
+}
+
+/**
+ * @brief Writer thread: drains the queue, flushes the files and sleeps when it is empty, and stops once the logger is destroyed and the queue is empty.
+ */
+void WeightLogger::_run()
+{
+	size_t written_count = 0;
+
+	while (true)
+	{
+		// Read before the queue, so that a record queued before the destruction is always seen
+		bool running = _running.load(std::memory_order_acquire);
+
+		std::unique_ptr<Record> record(_pop());
+		if (record)
+		{
+			_write(*record);
+			written_count++;
+			continue;
+		}
+
+		for (std::pair<const std::string, std::ofstream> &entry : _files)
+			entry.second.flush();
+		_flushed_count.store(written_count, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(_wake_mutex);
+			_flushed.notify_all();
+		}
+
+		if (!running)
+			break;
+
+		_sleeping.store(true);
+		{
+			std::unique_lock<std::mutex> lock(_wake_mutex);
+			_wake.wait(lock, [this, written_count]()
+					   { return _pushed_count.load() > written_count || !_running.load(std::memory_order_acquire); });
+		}
+		_sleeping.store(false, std::memory_order_relaxed);
+	}
+
+	_files.clear();
+}
+
+void WeightLogger::_write(const Record &record)
+{
+	std::string filename = record.path + (record.weights ? ".weights.bin" : ".events.bin");
+
+	auto it = _files.find(filename);
+	if (it == std::end(_files))
+	{
+		std::filesystem::path parent = std::filesystem::path(filename).parent_path();
+		std::error_code error;
+		if (!parent.empty())
+			std::filesystem::create_directories(parent, error);
+
+		it = _files.emplace(filename, std::ofstream(filename, std::ios::out | std::ios::binary | std::ios::trunc)).first;
+		// An exception can't reach the training thread from here, the records of this file are dropped
+		if (!it->second.good())
+			std::cerr << "Can't open file " << filename << std::endl;
+		it->second.write(record.weights ? "CSNNWGT1" : "CSNNEVT1", 8);
+	}
+
+	std::ofstream &file = it->second;
+	uint32_t label_size = record.label.size();
+
+	if (record.weights)
+	{
+		uint32_t rank = record.dims.size();
+		file.write(reinterpret_cast<const char *>(&label_size), sizeof(label_size));
+		file.write(record.label.data(), label_size);
+		file.write(reinterpret_cast<const char *>(&rank), sizeof(rank));
+		file.write(reinterpret_cast<const char *>(record.dims.data()), rank * sizeof(uint64_t));
+		file.write(reinterpret_cast<const char *>(record.data.data()), record.data.size() * sizeof(float));
+	}
+	else
+	{
+		file.write(reinterpret_cast<const char *>(&record.value), sizeof(record.value));
+		file.write(reinterpret_cast<const char *>(&label_size), sizeof(label_size));
+		file.write(record.label.data(), label_size);
+	}
+}
@@ -6,25 +6,16 @@ import matplotlib.pyplot as plt
 import os
 from PIL import Image, ImageDraw
 from pathlib import Path
+from read_weight_log import read_weights
 
 file_names = ["KTH-2-M23-7-L2-2D1D_1"]
 
 file_path = "/home/melassal/Workspace/Results/Features-2d1dvs3d/Weight/KTH-2-M23-7-L2-2D1D_1/3/"
 for file_name in file_names:
-    with open(file_path + file_name + ".json", "r") as s1:
-        data = s1.read()
-
-        if data[0] != "[":
-            new_data = "[" + data[:-1] + "]"
-
-            with open(file_path + "/" + file_name + ".json", "w") as s2:
-                s2.write(new_data)
-                #data = s1.read()
+    kernels = read_weights(file_path + file_name)
 
     file_path = file_path + file_name + "/"
 
-    kernels = json.loads(data)
-
     kernel = kernels[-1]
     na = np.array(kernel["data"])
     draw_kernel = na.reshape(
@@ -0,0 +1,44 @@
+# Reader of the binary logs written by tool::WeightLogger (see include/tool/WeightLogger.h).
+import struct
+import numpy as np
+
+
+def _read_label(f):
+    size, = struct.unpack("<I", f.read(4))
+    return f.read(size).decode()
+
+
+def read_weights(path):
+    """Returns the snapshots of <path>.weights.bin, with the keys of the former JSON records (label, dim_i, data)."""
+    snapshots = []
+    with open(path + ".weights.bin", "rb") as f:
+        if f.read(8) != b"CSNNWGT1":
+            raise ValueError("Not a weight log: " + path)
+        while True:
+            header = f.read(4)
+            if len(header) < 4:
+                break
+            f.seek(-4, 1)
+            snapshot = {"label": _read_label(f)}
+            rank, = struct.unpack("<I", f.read(4))
+            dims = struct.unpack("<%dQ" % rank, f.read(8 * rank))
+            for i, dim in enumerate(dims):
+                snapshot["dim_" + str(i)] = dim
+            snapshot["data"] = np.frombuffer(f.read(4 * int(np.prod(dims))), dtype="<f4")
+            snapshots.append(snapshot)
+    return snapshots
+
+
+def read_events(path):
+    """Returns the (neuron or filter index, label) pairs of <path>.events.bin."""
+    events = []
+    with open(path + ".events.bin", "rb") as f:
+        if f.read(8) != b"CSNNEVT1":
+            raise ValueError("Not an event log: " + path)
+        while True:
+            header = f.read(4)
+            if len(header) < 4:
+                break
+            value, = struct.unpack("<I", header)
+            events.append((value, _read_label(f)))
+    return events